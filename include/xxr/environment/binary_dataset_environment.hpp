@@ -0,0 +1,121 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <unordered_set>
+#include <stdexcept>
+#include <cstddef>
+#include <cassert>
+
+#include "environment.hpp"
+#include "xxr/random.hpp"
+#include "xxr/helper/binary_dataset.hpp"
+
+namespace xxr
+{
+
+    // Dataset environment over a memory-mapped binary dataset (see BinaryDataset)
+    //   This chooses the situations in the same way as DatasetEnvironment, but the
+    //   situations are decoded from the mapped file without loading the dataset.
+    //   The view can be shared by environments.
+    template <typename T, typename Action>
+    class BinaryDatasetEnvironment : public AbstractEnvironment<T, Action>
+    {
+    protected:
+        const std::shared_ptr<const BinaryDataset::View<T, Action>> m_dataset;
+        std::vector<T> m_situation;
+        Action m_answer;
+        std::size_t m_currentIdx;
+        std::size_t m_nextIdx;
+        const bool m_chooseRandom;
+        bool m_isEndOfProblem;
+
+        virtual std::size_t loadNext()
+        {
+            if (m_chooseRandom)
+            {
+                m_currentIdx = Random::nextInt<std::size_t>(0UL, m_dataset->size() - 1UL);
+            }
+            else
+            {
+                m_currentIdx = m_nextIdx;
+                if (++m_nextIdx >= m_dataset->size())
+                {
+                    m_nextIdx = 0;
+                }
+            }
+            m_dataset->situationAt(m_currentIdx, m_situation);
+            m_answer = m_dataset->actionAt(m_currentIdx);
+            return m_currentIdx;
+        }
+
+    public:
+        // Constructor
+        BinaryDatasetEnvironment(std::shared_ptr<const BinaryDataset::View<T, Action>> dataset, const std::unordered_set<Action> & availableActions, bool chooseRandom = true)
+            : AbstractEnvironment<T, Action>(availableActions)
+            , m_dataset(std::move(dataset))
+            , m_currentIdx(0)
+            , m_nextIdx(0)
+            , m_chooseRandom(chooseRandom)
+            , m_isEndOfProblem(false)
+        {
+            assert(m_dataset != nullptr);
+            assert(m_dataset->size() > 0);
+
+            loadNext();
+        }
+
+        virtual ~BinaryDatasetEnvironment() = default;
+
+        virtual std::vector<T> situation() const override
+        {
+            return m_situation;
+        }
+
+        virtual double executeAction(Action action) override
+        {
+            const double reward = (action == m_answer) ? 1000.0 : 0.0;
+
+            // Single-step problem
+            m_isEndOfProblem = true;
+
+            loadNext();
+
+            return reward;
+        }
+
+        virtual bool isEndOfProblem() const override
+        {
+            return m_isEndOfProblem;
+        }
+
+        virtual void saveState(Checkpoint::Writer & writer) const override
+        {
+            writer.writeTag(Checkpoint::kEnvironmentTag);
+            writer.write<uint64_t>(m_dataset->size());
+            writer.write<uint64_t>(m_currentIdx);
+            writer.write<uint64_t>(m_nextIdx);
+            writer.write<bool>(m_isEndOfProblem);
+        }
+
+        virtual void loadState(Checkpoint::Reader & reader) override
+        {
+            reader.expectTag(Checkpoint::kEnvironmentTag, "environment");
+            if (reader.read<uint64_t>() != m_dataset->size())
+            {
+                throw std::runtime_error("Checkpoint: The dataset does not match this environment.");
+            }
+            m_currentIdx = reader.read<uint64_t>();
+            m_nextIdx = reader.read<uint64_t>();
+            reader.read(m_isEndOfProblem);
+            m_dataset->situationAt(m_currentIdx, m_situation);
+            m_answer = m_dataset->actionAt(m_currentIdx);
+        }
+
+        // Returns the answer
+        virtual Action getAnswer() const
+        {
+            return m_answer;
+        }
+    };
+
+}
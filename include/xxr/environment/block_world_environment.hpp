@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <unordered_set>
+#include <stdexcept>
+#include <cstdint>
 #include <cstddef>
 #include <cassert>
 #include <fstream>
@@ -351,6 +353,36 @@ namespace xxr
             return m_isEndOfProblem;
         }
 
+        virtual void saveState(Checkpoint::Writer & writer) const override
+        {
+            writer.writeTag(Checkpoint::kEnvironmentTag);
+            writer.write<uint64_t>(m_worldWidth);
+            writer.write<uint64_t>(m_worldHeight);
+            for (int value : { m_initialX, m_initialY, m_currentX, m_currentY, m_lastX, m_lastY, m_lastInitialX, m_lastInitialY })
+            {
+                writer.write<int32_t>(value);
+            }
+            writer.write<uint64_t>(m_lastStep);
+            writer.write<uint64_t>(m_currentStep);
+            writer.write<bool>(m_isEndOfProblem);
+        }
+
+        virtual void loadState(Checkpoint::Reader & reader) override
+        {
+            reader.expectTag(Checkpoint::kEnvironmentTag, "environment");
+            if (reader.read<uint64_t>() != m_worldWidth || reader.read<uint64_t>() != m_worldHeight)
+            {
+                throw std::runtime_error("Checkpoint: The block world does not match this environment.");
+            }
+            for (int *pValue : { &m_initialX, &m_initialY, &m_currentX, &m_currentY, &m_lastX, &m_lastY, &m_lastInitialX, &m_lastInitialY })
+            {
+                *pValue = reader.read<int32_t>();
+            }
+            m_lastStep = reader.read<uint64_t>();
+            m_currentStep = reader.read<uint64_t>();
+            reader.read(m_isEndOfProblem);
+        }
+
         virtual std::string toString() const
         {
             std::string str;
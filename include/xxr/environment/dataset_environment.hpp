@@ -1,7 +1,9 @@
 #pragma once
 #include <vector>
+#include <memory>
 #include <string>
 #include <unordered_set>
+#include <stdexcept>
 #include <cstddef>
 #include <cassert>
 
@@ -12,13 +14,16 @@
 namespace xxr
 {
 
+    // Environment that chooses situations from a dataset
+    //   The dataset is immutable and can be shared by environments (e.g. the exploration
+    //   and exploitation environments of all seeds) without copying. Each environment
+    //   only has its own cursor.
     template <typename T, typename Action>
     class DatasetEnvironment : public AbstractEnvironment<T, Action>
     {
     protected:
-        const Dataset<T, Action> m_dataset;
-        std::vector<T> m_situation;
-        Action m_answer;
+        const std::shared_ptr<const Dataset<T, Action>> m_dataset;
+        std::size_t m_currentIdx;
         std::size_t m_nextIdx;
         const bool m_chooseRandom;
         bool m_isEndOfProblem;
@@ -27,49 +32,59 @@ namespace xxr
         {
             if (m_chooseRandom)
             {
-                const auto idx = Random::nextInt<std::size_t>(0UL, m_dataset.situations.size() - 1UL);
-                m_situation = m_dataset.situations[idx];
-                m_answer = m_dataset.actions[idx];
-                return idx;
+                m_currentIdx = Random::nextInt<std::size_t>(0UL, m_dataset->situations.size() - 1UL);
             }
             else
             {
-                m_situation = m_dataset.situations[m_nextIdx];
-                m_answer = m_dataset.actions[m_nextIdx];
-                const auto idx = m_nextIdx;
-                if (++m_nextIdx >= m_dataset.situations.size())
+                m_currentIdx = m_nextIdx;
+                if (++m_nextIdx >= m_dataset->situations.size())
                 {
                     m_nextIdx = 0;
                 }
-                return idx;
             }
+            return m_currentIdx;
         }
 
     public:
-        DatasetEnvironment(const Dataset<T, Action> & dataset, const std::unordered_set<Action> & availableActions, bool chooseRandom = true)
+        // Constructor (shares the dataset)
+        DatasetEnvironment(std::shared_ptr<const Dataset<T, Action>> dataset, const std::unordered_set<Action> & availableActions, bool chooseRandom = true)
             : AbstractEnvironment<T, Action>(availableActions)
-            , m_dataset(dataset)
+            , m_dataset(std::move(dataset))
+            , m_currentIdx(0)
             , m_nextIdx(0)
             , m_chooseRandom(chooseRandom)
             , m_isEndOfProblem(false)
         {
-            assert(!m_dataset.situations.empty());
-            assert(!m_dataset.actions.empty());
-            assert(m_dataset.situations.size() == m_dataset.actions.size());
+            assert(m_dataset != nullptr);
+            assert(!m_dataset->situations.empty());
+            assert(!m_dataset->actions.empty());
+            assert(m_dataset->situations.size() == m_dataset->actions.size());
 
             loadNext();
         }
 
+        // Constructor (copies the dataset)
+        DatasetEnvironment(const Dataset<T, Action> & dataset, const std::unordered_set<Action> & availableActions, bool chooseRandom = true)
+            : DatasetEnvironment(std::make_shared<const Dataset<T, Action>>(dataset), availableActions, chooseRandom)
+        {
+        }
+
+        // Constructor (takes the dataset)
+        DatasetEnvironment(Dataset<T, Action> && dataset, const std::unordered_set<Action> & availableActions, bool chooseRandom = true)
+            : DatasetEnvironment(std::make_shared<const Dataset<T, Action>>(std::move(dataset)), availableActions, chooseRandom)
+        {
+        }
+
         virtual ~DatasetEnvironment() = default;
 
         virtual std::vector<T> situation() const override
         {
-            return m_situation;
+            return m_dataset->situations[m_currentIdx];
         }
 
         virtual double executeAction(Action action) override
         {
-            const double reward = (action == m_answer) ? 1000.0 : 0.0;
+            const double reward = (action == m_dataset->actions[m_currentIdx]) ? 1000.0 : 0.0;
 
             // Single-step problem
             m_isEndOfProblem = true;
@@ -84,10 +99,37 @@ namespace xxr
             return m_isEndOfProblem;
         }
 
+        virtual void saveState(Checkpoint::Writer & writer) const override
+        {
+            writer.writeTag(Checkpoint::kEnvironmentTag);
+            writer.write<uint64_t>(m_dataset->situations.size());
+            writer.write<uint64_t>(m_currentIdx);
+            writer.write<uint64_t>(m_nextIdx);
+            writer.write<bool>(m_isEndOfProblem);
+        }
+
+        virtual void loadState(Checkpoint::Reader & reader) override
+        {
+            reader.expectTag(Checkpoint::kEnvironmentTag, "environment");
+            if (reader.read<uint64_t>() != m_dataset->situations.size())
+            {
+                throw std::runtime_error("Checkpoint: The dataset does not match this environment.");
+            }
+            m_currentIdx = reader.read<uint64_t>();
+            m_nextIdx = reader.read<uint64_t>();
+            reader.read(m_isEndOfProblem);
+        }
+
         // Returns the answer
         virtual Action getAnswer() const
         {
-            return m_answer;
+            return m_dataset->actions[m_currentIdx];
+        }
+
+        // Returns the shared dataset
+        const std::shared_ptr<const Dataset<T, Action>> & dataset() const noexcept
+        {
+            return m_dataset;
         }
     };
 
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <stdexcept>
 #include <cstddef>
 #include <cassert>
 #include <unordered_set>
 
+#include "../helper/checkpoint.hpp"
+
 namespace xxr
 {
 
@@ -36,6 +39,18 @@ namespace xxr
         // Returns true if the problem was solved by the previous action
         // (always true for a single-step problem after the first action execution)
         virtual bool isEndOfProblem() const = 0;
+
+        // Save/load the state (e.g. the current situation) for checkpoints
+        //   Throws std::runtime_error if the environment does not support checkpoints.
+        virtual void saveState(Checkpoint::Writer &) const
+        {
+            throw std::runtime_error("Checkpoint: This environment does not support checkpoints.");
+        }
+
+        virtual void loadState(Checkpoint::Reader &)
+        {
+            throw std::runtime_error("Checkpoint: This environment does not support checkpoints.");
+        }
     };
 
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <stdexcept>
 #include <cstddef>
 #include <cassert>
 
@@ -63,6 +64,24 @@ namespace xxr
             return m_isEndOfProblem;
         }
 
+        virtual void saveState(Checkpoint::Writer & writer) const override
+        {
+            writer.writeTag(Checkpoint::kEnvironmentTag);
+            writer.writeVector(m_situation);
+            writer.write<bool>(m_isEndOfProblem);
+        }
+
+        virtual void loadState(Checkpoint::Reader & reader) override
+        {
+            reader.expectTag(Checkpoint::kEnvironmentTag, "environment");
+            reader.readVector(m_situation);
+            reader.read(m_isEndOfProblem);
+            if (m_situation.size() != m_length)
+            {
+                throw std::runtime_error("Checkpoint: The situation does not match this environment.");
+            }
+        }
+
         // Returns answer to situation
         bool getAnswer() const
         {
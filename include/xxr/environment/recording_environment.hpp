@@ -0,0 +1,152 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <unordered_set>
+#include <random>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+#include "environment.hpp"
+#include "xxr/random.hpp"
+#include "xxr/helper/workload_trace.hpp"
+
+namespace xxr
+{
+
+    // Environment that records the situations, the actions and the rewards of another
+    // environment to a workload trace (see WorkloadTrace and ReplayEnvironment)
+    //   If the environment supports checkpoints, the rewards of all the available actions are
+    //   recorded at each step as well. They are obtained by executing each action and restoring
+    //   the state of the environment and the random engine, so the recorded run itself is not
+    //   changed by the recording.
+    template <typename T, typename Action>
+    class RecordingEnvironment final : public AbstractEnvironment<T, Action>
+    {
+    private:
+        const std::unique_ptr<AbstractEnvironment<T, Action>> m_environment;
+        std::ofstream m_ofs;
+        const std::vector<Action> m_actions;
+        const bool m_hasRewardTable;
+        WorkloadTrace::Writer<T, Action> m_writer;
+        std::vector<double> m_rewardTable;
+
+        static std::vector<Action> sortedActions(const std::unordered_set<Action> & availableActions)
+        {
+            std::vector<Action> actions(availableActions.begin(), availableActions.end());
+            std::sort(actions.begin(), actions.end());
+            return actions;
+        }
+
+        static bool supportsCheckpoint(const AbstractEnvironment<T, Action> & environment)
+        {
+            try
+            {
+                std::ostringstream oss;
+                Checkpoint::Writer writer(oss);
+                environment.saveState(writer);
+                return true;
+            }
+            catch (const std::runtime_error &)
+            {
+                return false;
+            }
+        }
+
+        static std::ofstream & openFile(std::ofstream & ofs, const std::string & filename)
+        {
+            ofs.open(filename, std::ios::binary);
+            if (!ofs)
+            {
+                throw std::runtime_error("RecordingEnvironment: Cannot open file '" + filename + "'.");
+            }
+            return ofs;
+        }
+
+    public:
+        // Constructor (records to the stream, which must outlive the environment)
+        RecordingEnvironment(std::unique_ptr<AbstractEnvironment<T, Action>> environment, std::ostream & os)
+            : AbstractEnvironment<T, Action>(environment->availableActions)
+            , m_environment(std::move(environment))
+            , m_actions(sortedActions(this->availableActions))
+            , m_hasRewardTable(supportsCheckpoint(*m_environment))
+            , m_writer(os, m_environment->situation().size(), m_actions, m_hasRewardTable)
+            , m_rewardTable(m_hasRewardTable ? m_actions.size() : 0)
+        {
+        }
+
+        // Constructor (records to the file)
+        //   Throws std::runtime_error if the file cannot be opened.
+        RecordingEnvironment(std::unique_ptr<AbstractEnvironment<T, Action>> environment, const std::string & filename)
+            : AbstractEnvironment<T, Action>(environment->availableActions)
+            , m_environment(std::move(environment))
+            , m_actions(sortedActions(this->availableActions))
+            , m_hasRewardTable(supportsCheckpoint(*m_environment))
+            , m_writer(openFile(m_ofs, filename), m_environment->situation().size(), m_actions, m_hasRewardTable)
+            , m_rewardTable(m_hasRewardTable ? m_actions.size() : 0)
+        {
+        }
+
+        virtual ~RecordingEnvironment() = default;
+
+        virtual std::vector<T> situation() const override
+        {
+            return m_environment->situation();
+        }
+
+        virtual double executeAction(Action action) override
+        {
+            const std::vector<T> situation = m_environment->situation();
+
+            if (m_hasRewardTable)
+            {
+                std::stringstream state;
+                Checkpoint::Writer writer(state);
+                m_environment->saveState(writer);
+                const std::mt19937 engine = Random::engine();
+
+                for (std::size_t i = 0; i < m_actions.size(); ++i)
+                {
+                    m_rewardTable[i] = m_environment->executeAction(m_actions[i]);
+
+                    state.clear();
+                    state.seekg(0);
+                    Checkpoint::Reader reader(state);
+                    m_environment->loadState(reader);
+                    Random::engine() = engine;
+                }
+            }
+
+            const double reward = m_environment->executeAction(action);
+            m_writer.writeStep(situation, action, reward, m_environment->isEndOfProblem(), m_rewardTable);
+            return reward;
+        }
+
+        virtual bool isEndOfProblem() const override
+        {
+            return m_environment->isEndOfProblem();
+        }
+
+        // Returns true if the rewards of all the available actions are recorded
+        bool hasRewardTable() const noexcept
+        {
+            return m_hasRewardTable;
+        }
+
+        uint64_t recordedStepCount() const noexcept
+        {
+            return m_writer.stepCount();
+        }
+
+        AbstractEnvironment<T, Action> & environment() noexcept
+        {
+            return *m_environment;
+        }
+    };
+
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include <unordered_set>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+#include "environment.hpp"
+#include "xxr/helper/workload_trace.hpp"
+
+namespace xxr
+{
+
+    // Environment that replays a workload trace recorded by RecordingEnvironment
+    //   The situations are given in the recorded order (from the beginning again after the last
+    //   step) without using Random, so the learners seeded in the same way see exactly the same
+    //   workload and the cost of generating the situations is excluded from the measurements.
+    //   The reward of an action is taken from the recorded reward table. If the trace has no
+    //   table, the recorded reward is returned even if the action differs from the recorded one
+    //   (counted in mismatchedActionCount()). The situations of the multi-step problems are
+    //   always the recorded ones regardless of the actions.
+    template <typename T, typename Action>
+    class ReplayEnvironment final : public AbstractEnvironment<T, Action>
+    {
+    private:
+        const std::shared_ptr<const WorkloadTrace::Trace<T, Action>> m_trace;
+        std::size_t m_currentIdx;
+        bool m_isEndOfProblem;
+        uint64_t m_mismatchedActionCount;
+
+        static std::unordered_set<Action> availableActionsOf(const WorkloadTrace::Trace<T, Action> & trace)
+        {
+            return std::unordered_set<Action>(trace.actions.begin(), trace.actions.end());
+        }
+
+    public:
+        // Constructor (shares the trace)
+        explicit ReplayEnvironment(std::shared_ptr<const WorkloadTrace::Trace<T, Action>> trace)
+            : AbstractEnvironment<T, Action>(availableActionsOf(*trace))
+            , m_trace(std::move(trace))
+            , m_currentIdx(0)
+            , m_isEndOfProblem(false)
+            , m_mismatchedActionCount(0)
+        {
+            if (m_trace->stepCount() == 0)
+            {
+                throw std::runtime_error("ReplayEnvironment: The workload trace has no steps.");
+            }
+        }
+
+        // Constructor (loads the trace from the file)
+        //   Throws std::runtime_error if the file is not a valid trace of the types.
+        explicit ReplayEnvironment(const std::string & filename)
+            : ReplayEnvironment(std::make_shared<const WorkloadTrace::Trace<T, Action>>(WorkloadTrace::readFile<T, Action>(filename)))
+        {
+        }
+
+        virtual ~ReplayEnvironment() = default;
+
+        virtual std::vector<T> situation() const override
+        {
+            const auto begin = m_trace->situations.begin() + m_currentIdx * m_trace->situationLength;
+            return std::vector<T>(begin, begin + m_trace->situationLength);
+        }
+
+        virtual double executeAction(Action action) override
+        {
+            double reward = m_trace->rewards[m_currentIdx];
+            if (action != m_trace->takenActions[m_currentIdx])
+            {
+                const auto it = std::find(m_trace->actions.begin(), m_trace->actions.end(), action);
+                if (m_trace->hasRewardTable && it != m_trace->actions.end())
+                {
+                    reward = m_trace->rewardTable[m_currentIdx * m_trace->actions.size() + (it - m_trace->actions.begin())];
+                }
+                ++m_mismatchedActionCount;
+            }
+
+            m_isEndOfProblem = m_trace->endOfProblemFlags[m_currentIdx];
+
+            if (++m_currentIdx >= m_trace->stepCount())
+            {
+                m_currentIdx = 0;
+            }
+
+            return reward;
+        }
+
+        virtual bool isEndOfProblem() const override
+        {
+            return m_isEndOfProblem;
+        }
+
+        virtual void saveState(Checkpoint::Writer & writer) const override
+        {
+            writer.writeTag(Checkpoint::kEnvironmentTag);
+            writer.write<uint64_t>(m_trace->stepCount());
+            writer.write<uint64_t>(m_currentIdx);
+            writer.write<bool>(m_isEndOfProblem);
+            writer.write<uint64_t>(m_mismatchedActionCount);
+        }
+
+        virtual void loadState(Checkpoint::Reader & reader) override
+        {
+            reader.expectTag(Checkpoint::kEnvironmentTag, "environment");
+            if (reader.read<uint64_t>() != m_trace->stepCount())
+            {
+                throw std::runtime_error("Checkpoint: The workload trace does not match this environment.");
+            }
+            m_currentIdx = reader.read<uint64_t>();
+            reader.read(m_isEndOfProblem);
+            m_mismatchedActionCount = reader.read<uint64_t>();
+        }
+
+        // The steps where the action differed from the recorded one
+        uint64_t mismatchedActionCount() const noexcept
+        {
+            return m_mismatchedActionCount;
+        }
+
+        // Returns the shared trace
+        const std::shared_ptr<const WorkloadTrace::Trace<T, Action>> & trace() const noexcept
+        {
+            return m_trace;
+        }
+    };
+
+}
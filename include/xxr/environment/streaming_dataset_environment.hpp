@@ -0,0 +1,336 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <cstddef>
+#include <cassert>
+
+#include "environment.hpp"
+#include "xxr/random.hpp"
+#include "xxr/helper/dataset.hpp"
+#include "xxr/helper/csv.hpp"
+
+namespace xxr
+{
+
+    // Dataset environment that streams a csv file instead of loading it into memory
+    //
+    //   A background thread reads the file in blocks of blockSize lines (at most
+    //   kMaxPendingBlockCount blocks ahead), and the situations are taken from a buffer
+    //   of bufferSize lines:
+    //     chooseRandom = true : A random line in the buffer is chosen and replaced with
+    //                           the next line of the file (shuffle buffer).
+    //     chooseRandom = false: The lines are chosen in the order of the file.
+    //   The file is read again from the beginning after the last line, so the memory usage
+    //   is bounded by (bufferSize + blockSize * kMaxPendingBlockCount) lines.
+    //
+    //   If the whole file fits in the buffer, the file is read only once and this behaves
+    //   exactly as DatasetEnvironment. If the file cannot be read again (e.g. a pipe), the
+    //   lines left in the buffer are used after the end of the file.
+    template <typename T, typename Action>
+    class StreamingDatasetEnvironment : public AbstractEnvironment<T, Action>
+    {
+    protected:
+        struct Block
+        {
+            Dataset<T, Action> dataset;
+            bool isEndOfPass; // the last lines before the end of the file
+            bool isEndOfSource; // the file cannot be read again
+            std::exception_ptr exception;
+        };
+
+        // The maximum number of blocks read ahead
+        static constexpr std::size_t kMaxPendingBlockCount = 4;
+
+        const std::size_t m_bufferSize;
+        const std::size_t m_blockSize;
+        const bool m_rounds;
+        const bool m_chooseRandom;
+
+        std::ifstream m_ifs;
+
+        // Buffer of the lines
+        std::vector<std::vector<T>> m_bufferSituations;
+        std::vector<Action> m_bufferActions;
+        std::size_t m_nextIdx;
+
+        // Whether the lines are no longer read from the file
+        bool m_isBufferFixed;
+
+        // The block being consumed
+        Dataset<T, Action> m_block;
+        std::size_t m_blockPos;
+        bool m_isBlockEndOfPass;
+        bool m_isBlockEndOfSource;
+
+        // Blocks read ahead by the background thread
+        std::deque<Block> m_pendingBlocks;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_isStopping;
+        std::thread m_thread;
+
+        std::vector<T> m_situation;
+        Action m_answer;
+        bool m_isEndOfProblem;
+
+        // Read the file (called in the background thread)
+        void prefetch()
+        {
+            while (true)
+            {
+                Block block{ {}, false, false, nullptr };
+                try
+                {
+                    block.dataset = CSV::readDataset<T, Action>(m_ifs, m_rounds, m_blockSize);
+
+                    // The end of the file (or an empty line, which is treated as the end of the data by readDataset())
+                    const int c = m_ifs.peek();
+                    block.isEndOfPass = (block.dataset.situations.size() < m_blockSize || c == std::char_traits<char>::eof() || c == '\n');
+                    if (block.isEndOfPass)
+                    {
+                        m_ifs.clear();
+                        m_ifs.seekg(0);
+                        block.isEndOfSource = m_ifs.fail();
+                    }
+                }
+                catch (...)
+                {
+                    block.exception = std::current_exception();
+                    block.isEndOfPass = true;
+                    block.isEndOfSource = true;
+                }
+
+                const bool isEndOfSource = block.isEndOfSource;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]{ return m_isStopping || m_pendingBlocks.size() < kMaxPendingBlockCount; });
+                    if (m_isStopping)
+                    {
+                        return;
+                    }
+                    m_pendingBlocks.push_back(std::move(block));
+                }
+                m_condition.notify_all();
+
+                if (isEndOfSource)
+                {
+                    return;
+                }
+            }
+        }
+
+        void stopPrefetch()
+        {
+            if (m_thread.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_isStopping = true;
+                }
+                m_condition.notify_all();
+                m_thread.join();
+            }
+        }
+
+        // Take the next line of the file
+        //   Returns false if there is no more line to read.
+        //   isEndOfPass is set to true if the line is the last one of the file.
+        bool readNext(std::vector<T> & situation, Action & action, bool & isEndOfPass)
+        {
+            while (m_blockPos >= m_block.situations.size())
+            {
+                if (m_isBlockEndOfSource)
+                {
+                    return false;
+                }
+
+                Block block;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]{ return !m_pendingBlocks.empty(); });
+                    block = std::move(m_pendingBlocks.front());
+                    m_pendingBlocks.pop_front();
+                }
+                m_condition.notify_all();
+
+                if (block.exception)
+                {
+                    std::rethrow_exception(block.exception);
+                }
+
+                m_block = std::move(block.dataset);
+                m_blockPos = 0;
+                m_isBlockEndOfPass = block.isEndOfPass;
+                m_isBlockEndOfSource = block.isEndOfSource;
+
+                if (m_block.situations.empty() && m_isBlockEndOfPass && !m_isBlockEndOfSource)
+                {
+                    throw std::runtime_error("StreamingDatasetEnvironment: The csv file has no data.");
+                }
+            }
+
+            situation = std::move(m_block.situations[m_blockPos]);
+            action = m_block.actions[m_blockPos];
+            ++m_blockPos;
+            isEndOfPass = (m_isBlockEndOfPass && m_blockPos >= m_block.situations.size());
+            return true;
+        }
+
+        void fixBuffer()
+        {
+            m_isBufferFixed = true;
+            stopPrefetch();
+            m_ifs.close();
+            m_block = Dataset<T, Action>();
+            m_pendingBlocks.clear();
+        }
+
+        virtual void loadNext()
+        {
+            std::size_t idx;
+            if (m_chooseRandom)
+            {
+                idx = Random::nextInt<std::size_t>(0UL, m_bufferSituations.size() - 1UL);
+            }
+            else
+            {
+                idx = m_nextIdx;
+                if (++m_nextIdx >= m_bufferSituations.size())
+                {
+                    m_nextIdx = 0;
+                }
+            }
+
+            m_answer = m_bufferActions[idx];
+            if (m_isBufferFixed)
+            {
+                m_situation = m_bufferSituations[idx];
+            }
+            else
+            {
+                // Replace the line with the next one (this keeps the order of the file when chooseRandom is false)
+                m_situation.swap(m_bufferSituations[idx]);
+                bool isEndOfPass;
+                if (!readNext(m_bufferSituations[idx], m_bufferActions[idx], isEndOfPass))
+                {
+                    // The file cannot be read again
+                    m_bufferSituations[idx] = m_situation;
+                    m_bufferActions[idx] = m_answer;
+                    fixBuffer();
+                }
+            }
+        }
+
+    public:
+        // Constructor
+        //   Throws std::runtime_error if the file cannot be opened or has no data.
+        StreamingDatasetEnvironment(const std::string & filename, const std::unordered_set<Action> & availableActions, bool chooseRandom = true, std::size_t bufferSize = 65536, std::size_t blockSize = 4096, bool rounds = false)
+            : AbstractEnvironment<T, Action>(availableActions)
+            , m_bufferSize(bufferSize)
+            , m_blockSize(blockSize)
+            , m_rounds(rounds)
+            , m_chooseRandom(chooseRandom)
+            , m_ifs(filename)
+            , m_nextIdx(0)
+            , m_isBufferFixed(false)
+            , m_blockPos(0)
+            , m_isBlockEndOfPass(false)
+            , m_isBlockEndOfSource(false)
+            , m_isStopping(false)
+            , m_isEndOfProblem(false)
+        {
+            assert(bufferSize > 0);
+            assert(blockSize > 0);
+
+            if (!m_ifs.good())
+            {
+                throw std::runtime_error("Error: Cannot open file '" + filename + "'");
+            }
+
+            m_thread = std::thread(&StreamingDatasetEnvironment::prefetch, this);
+
+            // Fill the buffer
+            try
+            {
+                std::vector<T> situation;
+                Action action;
+                bool isEndOfPass = false;
+                while (m_bufferSituations.size() < m_bufferSize && !isEndOfPass && readNext(situation, action, isEndOfPass))
+                {
+                    m_bufferSituations.push_back(std::move(situation));
+                    m_bufferActions.push_back(action);
+                }
+
+                if (m_bufferSituations.empty())
+                {
+                    throw std::runtime_error("StreamingDatasetEnvironment: The csv file has no data.");
+                }
+
+                // The whole file fits in the buffer
+                if (isEndOfPass || m_isBlockEndOfSource)
+                {
+                    fixBuffer();
+                }
+            }
+            catch (...)
+            {
+                stopPrefetch();
+                throw;
+            }
+
+            loadNext();
+        }
+
+        StreamingDatasetEnvironment(const StreamingDatasetEnvironment &) = delete;
+        StreamingDatasetEnvironment & operator=(const StreamingDatasetEnvironment &) = delete;
+
+        // Destructor
+        virtual ~StreamingDatasetEnvironment()
+        {
+            stopPrefetch();
+        }
+
+        virtual std::vector<T> situation() const override
+        {
+            return m_situation;
+        }
+
+        virtual double executeAction(Action action) override
+        {
+            const double reward = (action == m_answer) ? 1000.0 : 0.0;
+
+            // Single-step problem
+            m_isEndOfProblem = true;
+
+            loadNext();
+
+            return reward;
+        }
+
+        virtual bool isEndOfProblem() const override
+        {
+            return m_isEndOfProblem;
+        }
+
+        // Returns the answer
+        virtual Action getAnswer() const
+        {
+            return m_answer;
+        }
+
+        // Returns true if all the lines are in the buffer and the file is no longer read
+        bool isBufferFixed() const noexcept
+        {
+            return m_isBufferFixed;
+        }
+    };
+
+}
@@ -1,8 +1,14 @@
 #pragma once
 #include <vector>
 #include <iostream>
+#include <string>
 #include <cstddef>
 
+#include "experiment_stats.hpp"
+#include "memory_usage.hpp"
+#include "helper/checkpoint.hpp"
+#include "helper/population_csv.hpp"
+
 namespace xxr {
 
     template <
@@ -32,13 +38,38 @@ namespace xxr {
 
         virtual void loadPopulationCSV(const std::string & filename, bool useAsInitialPopulation = true) = 0;
 
-        virtual void dumpPopulation(std::ostream & os) const = 0;
+        // Write the population CSV (see PopulationCSV::Format for the precision and the threads)
+        virtual void dumpPopulation(std::ostream & os, const PopulationCSV::Format & format = PopulationCSV::Format()) const = 0;
+
+        virtual void loadPopulationBinary(const std::string & filename, bool useAsInitialPopulation = true) = 0;
+
+        virtual void dumpPopulationBinary(std::ostream & os) const = 0;
+
+        // Save/load the complete state of the experiment (see Checkpoint)
+        virtual void saveCheckpoint(Checkpoint::Writer & writer) const = 0;
+
+        virtual void loadCheckpoint(Checkpoint::Reader & reader) = 0;
+
+        // Record the changes of the population to the stream from now on (see PopulationJournal)
+        //   The stream must outlive the recording (call stopJournal() before destroying it).
+        virtual void startJournal(std::ostream & os) = 0;
+
+        virtual void stopJournal() = 0;
+
+        // Flush the journal to the stream
+        virtual void flushJournal() = 0;
 
         virtual std::size_t populationSize() const = 0;
 
         virtual std::size_t numerositySum() const = 0;
 
-        virtual void switchToCondensationMode() noexcept = 0;
+        // The counters of the events in the learning so far (see ExperimentStats)
+        virtual ExperimentStats stats() const = 0;
+
+        // The estimated heap footprint of the experiment (see MemoryUsage)
+        virtual MemoryUsage memoryUsage() const = 0;
+
+        virtual void switchToCondensationMode() = 0;
     };
 
 }
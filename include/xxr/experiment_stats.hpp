@@ -0,0 +1,117 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+namespace xxr
+{
+
+    // Counters of the events in the learning (see AbstractExperiment::stats())
+    //   The counters are always maintained (a few increments per step) and are saved to
+    //   the checkpoints. The match sets and the action sets are the ones formed by explore()
+    //   and exploit() with update (the sandbox match sets of exploit() are not counted).
+    //   The sizes are the numbers of the macroclassifiers.
+    struct ExperimentStats
+    {
+        // MATCHING
+        uint64_t testedClassifierCount = 0;  // the classifiers tested against the situations (once per pass of the covering loop)
+        uint64_t matchedClassifierCount = 0; // the classifiers that matched them
+
+        // COVERING
+        uint64_t coveringCount = 0;           // the match sets that needed covering
+        uint64_t coveringClassifierCount = 0; // the classifiers created by covering
+
+        // GA
+        uint64_t gaCount = 0;
+        uint64_t insertedChildCount = 0;   // the offspring inserted as new macroclassifiers
+        uint64_t subsumedChildCount = 0;   // the offspring absorbed by GA subsumption
+        uint64_t duplicatedChildCount = 0; // the offspring absorbed by identical macroclassifiers
+
+        // ACTION SET SUBSUMPTION
+        uint64_t actionSetSubsumptionCount = 0;        // the subsumptions that removed classifiers
+        uint64_t actionSetSubsumedClassifierCount = 0; // the macroclassifiers removed by them
+
+        // DELETION
+        uint64_t deletedClassifierCount = 0;   // the macroclassifiers removed from [P]
+        uint64_t numerosityDecrementCount = 0; // the deletions that decremented the numerosity
+
+        // [M] AND [A]
+        uint64_t matchSetCount = 0;
+        uint64_t matchSetSizeSum = 0;
+        uint64_t maxMatchSetSize = 0;
+        uint64_t actionSetCount = 0;
+        uint64_t actionSetSizeSum = 0;
+        uint64_t maxActionSetSize = 0;
+
+        void recordMatchSetSize(uint64_t size) noexcept
+        {
+            ++matchSetCount;
+            matchSetSizeSum += size;
+            maxMatchSetSize = std::max(maxMatchSetSize, size);
+        }
+
+        void recordActionSetSize(uint64_t size) noexcept
+        {
+            ++actionSetCount;
+            actionSetSizeSum += size;
+            maxActionSetSize = std::max(maxActionSetSize, size);
+        }
+
+        double meanMatchSetSize() const noexcept
+        {
+            return (matchSetCount > 0) ? static_cast<double>(matchSetSizeSum) / matchSetCount : 0.0;
+        }
+
+        double meanActionSetSize() const noexcept
+        {
+            return (actionSetCount > 0) ? static_cast<double>(actionSetSizeSum) / actionSetCount : 0.0;
+        }
+
+        // Accumulate the counters of another experiment (the max sizes are the larger ones)
+        ExperimentStats & operator+= (const ExperimentStats & obj) noexcept
+        {
+            testedClassifierCount += obj.testedClassifierCount;
+            matchedClassifierCount += obj.matchedClassifierCount;
+            coveringCount += obj.coveringCount;
+            coveringClassifierCount += obj.coveringClassifierCount;
+            gaCount += obj.gaCount;
+            insertedChildCount += obj.insertedChildCount;
+            subsumedChildCount += obj.subsumedChildCount;
+            duplicatedChildCount += obj.duplicatedChildCount;
+            actionSetSubsumptionCount += obj.actionSetSubsumptionCount;
+            actionSetSubsumedClassifierCount += obj.actionSetSubsumedClassifierCount;
+            deletedClassifierCount += obj.deletedClassifierCount;
+            numerosityDecrementCount += obj.numerosityDecrementCount;
+            matchSetCount += obj.matchSetCount;
+            matchSetSizeSum += obj.matchSetSizeSum;
+            maxMatchSetSize = std::max(maxMatchSetSize, obj.maxMatchSetSize);
+            actionSetCount += obj.actionSetCount;
+            actionSetSizeSum += obj.actionSetSizeSum;
+            maxActionSetSize = std::max(maxActionSetSize, obj.maxActionSetSize);
+            return *this;
+        }
+
+        // The counts since a previous snapshot (the max sizes are the ones of lhs, i.e. the max so far)
+        friend ExperimentStats operator- (const ExperimentStats & lhs, const ExperimentStats & rhs) noexcept
+        {
+            ExperimentStats stats = lhs;
+            stats.testedClassifierCount -= rhs.testedClassifierCount;
+            stats.matchedClassifierCount -= rhs.matchedClassifierCount;
+            stats.coveringCount -= rhs.coveringCount;
+            stats.coveringClassifierCount -= rhs.coveringClassifierCount;
+            stats.gaCount -= rhs.gaCount;
+            stats.insertedChildCount -= rhs.insertedChildCount;
+            stats.subsumedChildCount -= rhs.subsumedChildCount;
+            stats.duplicatedChildCount -= rhs.duplicatedChildCount;
+            stats.actionSetSubsumptionCount -= rhs.actionSetSubsumptionCount;
+            stats.actionSetSubsumedClassifierCount -= rhs.actionSetSubsumedClassifierCount;
+            stats.deletedClassifierCount -= rhs.deletedClassifierCount;
+            stats.numerosityDecrementCount -= rhs.numerosityDecrementCount;
+            stats.matchSetCount -= rhs.matchSetCount;
+            stats.matchSetSizeSum -= rhs.matchSetSizeSum;
+            stats.actionSetCount -= rhs.actionSetCount;
+            stats.actionSetSizeSum -= rhs.actionSetSizeSum;
+            return stats;
+        }
+    };
+
+}
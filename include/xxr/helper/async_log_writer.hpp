@@ -0,0 +1,228 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include "spsc_queue.hpp"
+
+namespace xxr
+{
+
+    // Asynchronous writer of the experiment logs
+    //   The values are passed to a background thread through a lock-free ring buffer,
+    //   and the background thread formats and writes them in batches without flushing
+    //   the streams on every line. The values are formatted in the same way as
+    //   "std::ostream << double" with the default flags ("%g"), so the output is
+    //   identical to the synchronous output.
+    //
+    //   All the records must be pushed from one thread at a time (e.g. the thread running
+    //   the experiments), and the streams must not be used by others until flush() returns.
+    class AsyncLogWriter
+    {
+    private:
+        enum class RecordKind
+        {
+            VALUE,
+            VALUE_LINE,
+            TEXT,
+            TEXT_LINE,
+            FLUSH,
+        };
+
+        struct Record
+        {
+            std::ostream *pOs;
+            RecordKind kind;
+            double value;
+            std::string text;
+        };
+
+        // The time the background thread sleeps when there is no record
+        static constexpr int kIdleWaitMilliseconds = 5;
+
+        SPSCQueue<Record> m_queue;
+
+        // The streams written by the background thread (used only in the background thread)
+        std::vector<std::ostream *> m_streams;
+
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::atomic<bool> m_isStopping;
+
+        // The number of the flush requests (used only in the producer thread)
+        std::size_t m_requestedFlushCount;
+
+        // The number of the completed flush requests (guarded by m_mutex)
+        std::size_t m_completedFlushCount;
+
+        void push(Record && record)
+        {
+            if (!m_thread.joinable())
+            {
+                m_thread = std::thread(&AsyncLogWriter::run, this);
+            }
+
+            while (!m_queue.push(std::move(record)))
+            {
+                // The ring buffer is full
+                m_condition.notify_all();
+                std::this_thread::yield();
+            }
+        }
+
+        void write(const Record & record)
+        {
+            if (record.kind == RecordKind::FLUSH)
+            {
+                for (auto && pOs : m_streams)
+                {
+                    pOs->flush();
+                }
+                m_streams.clear();
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    ++m_completedFlushCount;
+                }
+                m_condition.notify_all();
+                return;
+            }
+
+            std::ostream & os = *record.pOs;
+            if (!os)
+            {
+                return;
+            }
+
+            if (std::find(m_streams.begin(), m_streams.end(), record.pOs) == m_streams.end())
+            {
+                m_streams.push_back(record.pOs);
+            }
+
+            switch (record.kind)
+            {
+            case RecordKind::VALUE:
+            case RecordKind::VALUE_LINE:
+                {
+                    char buffer[32];
+                    int length = std::snprintf(buffer, sizeof(buffer) - 1, "%g", record.value);
+                    if (record.kind == RecordKind::VALUE_LINE)
+                    {
+                        buffer[length++] = '\n';
+                    }
+                    os.write(buffer, length);
+                }
+                break;
+
+            case RecordKind::TEXT:
+                os.write(record.text.data(), record.text.size());
+                break;
+
+            case RecordKind::TEXT_LINE:
+                os.write(record.text.data(), record.text.size());
+                os.put('\n');
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        // Write the records (called in the background thread)
+        void run()
+        {
+            Record record;
+            while (true)
+            {
+                bool isWritten = false;
+                while (m_queue.pop(record))
+                {
+                    write(record);
+                    isWritten = true;
+                }
+
+                if (!isWritten)
+                {
+                    if (m_isStopping.load())
+                    {
+                        // The records pushed before stopping
+                        while (m_queue.pop(record))
+                        {
+                            write(record);
+                        }
+                        break;
+                    }
+
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait_for(lock, std::chrono::milliseconds(static_cast<int>(kIdleWaitMilliseconds)));
+                }
+            }
+
+            for (auto && pOs : m_streams)
+            {
+                pOs->flush();
+            }
+            m_streams.clear();
+        }
+
+    public:
+        // Constructor
+        //   The background thread is started when the first record is pushed.
+        explicit AsyncLogWriter(std::size_t capacity = 8192)
+            : m_queue(capacity)
+            , m_isStopping(false)
+            , m_requestedFlushCount(0)
+            , m_completedFlushCount(0)
+        {
+        }
+
+        AsyncLogWriter(const AsyncLogWriter &) = delete;
+        AsyncLogWriter & operator=(const AsyncLogWriter &) = delete;
+
+        // Destructor (writes the remaining records)
+        ~AsyncLogWriter()
+        {
+            if (m_thread.joinable())
+            {
+                m_isStopping.store(true);
+                m_condition.notify_all();
+                m_thread.join();
+            }
+        }
+
+        void writeValue(std::ostream & os, double value, bool endsLine)
+        {
+            push(Record{ &os, endsLine ? RecordKind::VALUE_LINE : RecordKind::VALUE, value, std::string() });
+        }
+
+        void writeText(std::ostream & os, const std::string & str, bool endsLine)
+        {
+            push(Record{ &os, endsLine ? RecordKind::TEXT_LINE : RecordKind::TEXT, 0.0, str });
+        }
+
+        // Wait until all the pushed records are written and the streams are flushed
+        void flush()
+        {
+            if (!m_thread.joinable())
+            {
+                return;
+            }
+
+            push(Record{ nullptr, RecordKind::FLUSH, 0.0, std::string() });
+            const std::size_t requestedFlushCount = ++m_requestedFlushCount;
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.notify_all();
+            m_condition.wait(lock, [this, requestedFlushCount]{ return m_completedFlushCount >= requestedFlushCount; });
+        }
+    };
+
+}
@@ -0,0 +1,296 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+#include "csv.hpp"
+#include "text_format.hpp"
+#include "../xcs/action_registry.hpp"
+#include "../xcs/symbol.hpp"
+#include "../xcsr/symbol.hpp"
+
+namespace xxr
+{
+
+    namespace BatchEstimatorDetail
+    {
+        // The closed interval [lower, upper] of the values matched by the symbol
+
+        template <typename T>
+        void boundsOf(const xcs_impl::Symbol<T> & symbol, T & lower, T & upper)
+        {
+            if (symbol.isDontCare())
+            {
+                lower = std::numeric_limits<T>::lowest();
+                upper = std::numeric_limits<T>::max();
+            }
+            else
+            {
+                lower = upper = symbol.value();
+            }
+        }
+
+        // (XCSR symbols match lower() <= value < upper())
+        template <typename T>
+        void boundsOf(const xcsr_impl::AbstractSymbol<T> & symbol, T & lower, T & upper)
+        {
+            lower = symbol.lower();
+            upper = std::nextafter(symbol.upper(), std::numeric_limits<T>::lowest());
+        }
+    }
+
+    // Read-only estimator for batches of situations (used for --csv-estimate)
+    //   The classifiers of a population are copied into contiguous arrays, and the rows of
+    //   CSV tables are scored in parallel. The result of each row is the same as
+    //   Experiment::exploit() without update: the greedy action of the prediction array of
+    //   the matching classifiers, or a random action if no classifier matches. The population
+    //   is not modified, so the estimator can be used after the experiment has finished.
+    //
+    //   The symbols are stored as the closed intervals of the values they match, so that the
+    //   matching does not depend on the representation (and has no virtual calls).
+    template <typename T, typename Action>
+    class BatchEstimator
+    {
+    public:
+        using type = T;
+        using ActionType = Action;
+        using ActionMask = typename xcs_impl::ActionRegistry<Action>::ActionMask;
+
+        // The result of a situation
+        struct Estimate
+        {
+            Action action;
+            std::vector<double> predictions; // indexed by the action index of the action registry
+            std::vector<std::size_t> matchedIndices; // the indices of the matched classifiers (if requested)
+        };
+
+    protected:
+        // The number of rows scored by a thread at once
+        static constexpr std::size_t kBatchRowCount = 4096;
+
+        const xcs_impl::ActionRegistry<Action> m_actionRegistry;
+        const double m_initialPrediction;
+        std::size_t m_conditionLength;
+
+        // The conditions (classifierCount x m_conditionLength x { lower, upper } in the order of [P])
+        std::vector<T> m_bounds;
+        std::vector<std::size_t> m_actionIdxs;
+        std::vector<double> m_predictions;
+        std::vector<double> m_fitnesses;
+
+        bool matches(std::size_t classifierIdx, const std::vector<T> & situation) const
+        {
+            const T *bounds = m_bounds.data() + classifierIdx * m_conditionLength * 2;
+            for (std::size_t i = 0; i < m_conditionLength; ++i)
+            {
+                if (!(bounds[i * 2] <= situation[i] && situation[i] <= bounds[i * 2 + 1]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Append the rows [first, last) of the table to the string
+        void writeRows(std::string & out, const CSV::Table & table, std::size_t first, std::size_t last, bool outputsPredictions, bool outputsMatchedIndices) const
+        {
+            using TextFormat::appendValue;
+
+            std::vector<T> situation;
+            Estimate estimate;
+            for (std::size_t rowIdx = first; rowIdx < last; ++rowIdx)
+            {
+                const float *row = table.rowAt(rowIdx);
+                situation.resize(table.rowSize(rowIdx));
+                for (std::size_t i = 0; i < situation.size(); ++i)
+                {
+                    situation[i] = static_cast<T>(static_cast<double>(row[i]));
+                }
+
+                estimateInto(situation, estimate, outputsMatchedIndices);
+
+                for (auto && value : situation)
+                {
+                    appendValue(out, value);
+                    out.push_back(',');
+                }
+                appendValue(out, estimate.action);
+                if (outputsPredictions)
+                {
+                    for (double prediction : estimate.predictions)
+                    {
+                        out.push_back(',');
+                        appendValue(out, prediction);
+                    }
+                }
+                if (outputsMatchedIndices)
+                {
+                    out.push_back(',');
+                    for (std::size_t i = 0; i < estimate.matchedIndices.size(); ++i)
+                    {
+                        if (i > 0)
+                        {
+                            out.push_back(' ');
+                        }
+                        appendValue(out, estimate.matchedIndices[i]);
+                    }
+                }
+                out.push_back('\n');
+            }
+        }
+
+    public:
+        // Constructor (copies the classifiers of the population [P])
+        template <class ClassifierPtrSet>
+        BatchEstimator(const ClassifierPtrSet & population, double initialPrediction)
+            : m_actionRegistry(*population.actionRegistry())
+            , m_initialPrediction(initialPrediction)
+            , m_conditionLength(population.empty() ? 0 : (*population.begin())->condition.size())
+        {
+            m_bounds.reserve(population.size() * m_conditionLength * 2);
+            for (auto && cl : population)
+            {
+                if (cl->condition.size() != m_conditionLength)
+                {
+                    throw std::runtime_error("BatchEstimator: The condition lengths of the classifiers are not the same.");
+                }
+                for (std::size_t i = 0; i < m_conditionLength; ++i)
+                {
+                    T lower, upper;
+                    BatchEstimatorDetail::boundsOf(cl->condition.at(i), lower, upper);
+                    m_bounds.push_back(lower);
+                    m_bounds.push_back(upper);
+                }
+                m_actionIdxs.push_back(m_actionRegistry.indexOf(cl->action));
+                m_predictions.push_back(cl->prediction);
+                m_fitnesses.push_back(cl->fitness);
+            }
+        }
+
+        // Destructor
+        virtual ~BatchEstimator() = default;
+
+        std::size_t size() const noexcept
+        {
+            return m_actionIdxs.size();
+        }
+
+        std::size_t conditionLength() const noexcept
+        {
+            return m_conditionLength;
+        }
+
+        const xcs_impl::ActionRegistry<Action> & actionRegistry() const noexcept
+        {
+            return m_actionRegistry;
+        }
+
+        // Estimate the situation (the buffers of the estimate are reused)
+        void estimateInto(const std::vector<T> & situation, Estimate & estimate, bool collectsMatchedIndices = false) const
+        {
+            if (!m_actionIdxs.empty() && situation.size() != m_conditionLength)
+            {
+                throw std::runtime_error("BatchEstimator: The situation length (" + std::to_string(situation.size()) + ") is different from the condition length (" + std::to_string(m_conditionLength) + ").");
+            }
+
+            // PA (accumulated in the same order as the match set)
+            const std::size_t actionCount = m_actionRegistry.size();
+            std::vector<double> & pa = estimate.predictions;
+            pa.assign(actionCount, 0.0);
+            double fsa[xcs_impl::ActionRegistry<Action>::kMaxActionCount];
+            std::fill(fsa, fsa + actionCount, 0.0);
+            ActionMask paActions;
+            estimate.matchedIndices.clear();
+            for (std::size_t i = 0; i < m_actionIdxs.size(); ++i)
+            {
+                if (matches(i, situation))
+                {
+                    const std::size_t actionIdx = m_actionIdxs[i];
+                    paActions.set(actionIdx);
+                    pa[actionIdx] += m_predictions[i] * m_fitnesses[i];
+                    fsa[actionIdx] += m_fitnesses[i];
+                    if (collectsMatchedIndices)
+                    {
+                        estimate.matchedIndices.push_back(i);
+                    }
+                }
+            }
+
+            if (paActions.none())
+            {
+                std::fill(pa.begin(), pa.end(), m_initialPrediction);
+                estimate.action = m_actionRegistry.chooseRandom();
+                return;
+            }
+
+            // SELECT ACTION (same as GreedyPredictionArray)
+            double maxPA = -100000.0;
+            ActionMask maxPAActions;
+            for (std::size_t i = 0; i < actionCount; ++i)
+            {
+                if (!paActions.test(i))
+                {
+                    pa[i] = m_initialPrediction;
+                    continue;
+                }
+
+                pa[i] = (std::abs(fsa[i]) > 0.0) ? pa[i] / fsa[i] : pa[i];
+
+                if (std::abs(maxPA - pa[i]) < DBL_EPSILON)
+                {
+                    maxPAActions.set(i);
+                }
+                else if (maxPA < pa[i])
+                {
+                    maxPAActions.reset();
+                    maxPAActions.set(i);
+                    maxPA = pa[i];
+                }
+            }
+            estimate.action = m_actionRegistry.chooseRandom(maxPAActions);
+        }
+
+        Estimate estimate(const std::vector<T> & situation, bool collectsMatchedIndices = false) const
+        {
+            Estimate estimate;
+            estimateInto(situation, estimate, collectsMatchedIndices);
+            return estimate;
+        }
+
+        // Estimate the rows of the tables and write them in order as CSV lines
+        //   Each line consists of the situation, the chosen action, the predictions of the
+        //   actions (if outputsPredictions) and the space-separated indices of the matched
+        //   classifiers in [P] (if outputsMatchedIndices). The batches of kBatchRowCount rows are
+        //   scored by threadCount threads (see TextFormat::writeChunks()).
+        void writeEstimates(std::ostream & os, const std::vector<CSV::Table> & tables, bool outputsPredictions = false, bool outputsMatchedIndices = false, std::size_t threadCount = 0) const
+        {
+            struct Batch
+            {
+                const CSV::Table *pTable;
+                std::size_t first;
+                std::size_t last;
+            };
+
+            std::vector<Batch> batches;
+            for (auto && table : tables)
+            {
+                for (std::size_t first = 0; first < table.rowCount(); first += kBatchRowCount)
+                {
+                    batches.push_back(Batch{ &table, first, std::min(first + kBatchRowCount, table.rowCount()) });
+                }
+            }
+
+            TextFormat::writeChunks(os, batches.size(), threadCount, [&](std::string & str, std::size_t batchIdx) {
+                const Batch & batch = batches[batchIdx];
+                writeRows(str, *batch.pTable, batch.first, batch.last, outputsPredictions, outputsMatchedIndices);
+            });
+        }
+    };
+
+}
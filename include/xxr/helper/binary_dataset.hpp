@@ -0,0 +1,441 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <cassert>
+
+#include "dataset.hpp"
+#include "mapped_file.hpp"
+
+namespace xxr
+{
+
+    // Binary dataset format (converted from csv by xxr-dataset)
+    //
+    //   Layout (native byte order, all sections are 8-byte aligned):
+    //     Header     : magic, version, shape, encodings, min/max of the situation values
+    //     Situations : rowCount x columnCount values (row-major or column-major)
+    //                  packed with the narrowest encoding that keeps all values exactly
+    //                  (bits for 0/1, int8/int16/int32 for integers, float or double)
+    //     Actions    : rowCount values (int8/int16/int32)
+    //
+    //   The values are stored exactly as they are in the dataset, so reading a converted
+    //   csv file gives the same situations as CSV::readDataset().
+    namespace BinaryDataset
+    {
+        constexpr char kMagic[8] = { 'X', 'X', 'R', 'D', 'S', 'E', 'T', '\0' };
+
+        constexpr uint32_t kVersion = 1;
+
+        // Written as is to detect the byte order mismatch
+        constexpr uint32_t kByteOrderMark = 0x01020304;
+
+        enum class Encoding : uint32_t
+        {
+            BIT = 1,
+            INT8,
+            INT16,
+            INT32,
+            FLOAT32,
+            FLOAT64,
+        };
+
+        enum class Layout : uint32_t
+        {
+            ROW_MAJOR = 1,
+            COLUMN_MAJOR,
+        };
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrderMark;
+            uint64_t rowCount;
+            uint64_t columnCount; // the length of the situations
+            Encoding situationEncoding;
+            Layout layout;
+            Encoding actionEncoding;
+            uint32_t reserved;
+            double minValue; // the minimum situation value (for normalize())
+            double maxValue; // the maximum situation value (for normalize())
+            uint64_t situationsOffset;
+            uint64_t situationsSize;
+            uint64_t actionsOffset;
+            uint64_t actionsSize;
+        };
+
+        inline constexpr uint64_t alignTo8(uint64_t size) noexcept
+        {
+            return (size + 7) / 8 * 8;
+        }
+
+        // The size of the encoded values in bytes
+        inline uint64_t encodedSize(Encoding encoding, uint64_t count)
+        {
+            switch (encoding)
+            {
+            case Encoding::BIT:
+                return (count + 7) / 8;
+            case Encoding::INT8:
+                return count;
+            case Encoding::INT16:
+                return count * sizeof(int16_t);
+            case Encoding::INT32:
+                return count * sizeof(int32_t);
+            case Encoding::FLOAT32:
+                return count * sizeof(float);
+            case Encoding::FLOAT64:
+                return count * sizeof(double);
+            }
+            throw std::runtime_error("BinaryDataset: Unknown encoding.");
+        }
+
+        // Choose the narrowest encoding that keeps all the values
+        template <typename T>
+        Encoding chooseEncoding(const std::vector<T> & values)
+        {
+            bool isIntegral = true;
+            bool isFloat = true;
+            double min = 0.0;
+            double max = 0.0;
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                const double value = static_cast<double>(values[i]);
+                if (i == 0 || value < min) min = value;
+                if (i == 0 || value > max) max = value;
+                if (isIntegral && !(std::floor(value) == value && value >= std::numeric_limits<int32_t>::min() && value <= std::numeric_limits<int32_t>::max()))
+                {
+                    isIntegral = false;
+                }
+                if (isFloat && !(static_cast<double>(static_cast<float>(value)) == value))
+                {
+                    isFloat = false;
+                }
+            }
+
+            if (isIntegral)
+            {
+                if (min >= 0 && max <= 1) return Encoding::BIT;
+                if (min >= std::numeric_limits<int8_t>::min() && max <= std::numeric_limits<int8_t>::max()) return Encoding::INT8;
+                if (min >= std::numeric_limits<int16_t>::min() && max <= std::numeric_limits<int16_t>::max()) return Encoding::INT16;
+                return Encoding::INT32;
+            }
+            return isFloat ? Encoding::FLOAT32 : Encoding::FLOAT64;
+        }
+
+        template <typename T>
+        void encode(const std::vector<T> & values, Encoding encoding, std::vector<unsigned char> & bytes)
+        {
+            bytes.assign(encodedSize(encoding, values.size()), 0);
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                switch (encoding)
+                {
+                case Encoding::BIT:
+                    if (values[i] != 0)
+                    {
+                        bytes[i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+                    }
+                    break;
+                case Encoding::INT8:
+                    {
+                        const int8_t value = static_cast<int8_t>(values[i]);
+                        std::memcpy(&bytes[i * sizeof(value)], &value, sizeof(value));
+                    }
+                    break;
+                case Encoding::INT16:
+                    {
+                        const int16_t value = static_cast<int16_t>(values[i]);
+                        std::memcpy(&bytes[i * sizeof(value)], &value, sizeof(value));
+                    }
+                    break;
+                case Encoding::INT32:
+                    {
+                        const int32_t value = static_cast<int32_t>(values[i]);
+                        std::memcpy(&bytes[i * sizeof(value)], &value, sizeof(value));
+                    }
+                    break;
+                case Encoding::FLOAT32:
+                    {
+                        const float value = static_cast<float>(values[i]);
+                        std::memcpy(&bytes[i * sizeof(value)], &value, sizeof(value));
+                    }
+                    break;
+                case Encoding::FLOAT64:
+                    {
+                        const double value = static_cast<double>(values[i]);
+                        std::memcpy(&bytes[i * sizeof(value)], &value, sizeof(value));
+                    }
+                    break;
+                }
+            }
+        }
+
+        // Decode the idx-th value
+        template <typename T>
+        T decode(const unsigned char *data, Encoding encoding, std::size_t idx)
+        {
+            switch (encoding)
+            {
+            case Encoding::BIT:
+                return static_cast<T>((data[idx / 8] >> (idx % 8)) & 1);
+            case Encoding::INT8:
+                {
+                    int8_t value;
+                    std::memcpy(&value, data + idx * sizeof(value), sizeof(value));
+                    return static_cast<T>(value);
+                }
+            case Encoding::INT16:
+                {
+                    int16_t value;
+                    std::memcpy(&value, data + idx * sizeof(value), sizeof(value));
+                    return static_cast<T>(value);
+                }
+            case Encoding::INT32:
+                {
+                    int32_t value;
+                    std::memcpy(&value, data + idx * sizeof(value), sizeof(value));
+                    return static_cast<T>(value);
+                }
+            case Encoding::FLOAT32:
+                {
+                    float value;
+                    std::memcpy(&value, data + idx * sizeof(value), sizeof(value));
+                    return static_cast<T>(static_cast<double>(value));
+                }
+            case Encoding::FLOAT64:
+                {
+                    double value;
+                    std::memcpy(&value, data + idx * sizeof(value), sizeof(value));
+                    return static_cast<T>(value);
+                }
+            }
+            assert(false);
+            return T();
+        }
+
+        // Write the dataset (all situations must have the same length)
+        template <typename T, typename Action>
+        void write(std::ostream & os, const Dataset<T, Action> & dataset, Layout layout = Layout::ROW_MAJOR)
+        {
+            assert(dataset.situations.size() == dataset.actions.size());
+
+            const std::size_t rowCount = dataset.situations.size();
+            const std::size_t columnCount = dataset.situations.empty() ? 0 : dataset.situations.front().size();
+
+            std::vector<T> values;
+            values.reserve(rowCount * columnCount);
+            for (auto && situation : dataset.situations)
+            {
+                if (situation.size() != columnCount)
+                {
+                    throw std::runtime_error("BinaryDataset::write: The lengths of the situations are not the same.");
+                }
+            }
+            if (layout == Layout::ROW_MAJOR)
+            {
+                for (auto && situation : dataset.situations)
+                {
+                    values.insert(values.end(), situation.begin(), situation.end());
+                }
+            }
+            else
+            {
+                for (std::size_t j = 0; j < columnCount; ++j)
+                {
+                    for (auto && situation : dataset.situations)
+                    {
+                        values.push_back(situation[j]);
+                    }
+                }
+            }
+
+            const Encoding actionEncoding = chooseEncoding(dataset.actions);
+
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, kMagic, sizeof(kMagic));
+            header.version = kVersion;
+            header.byteOrderMark = kByteOrderMark;
+            header.rowCount = rowCount;
+            header.columnCount = columnCount;
+            header.situationEncoding = chooseEncoding(values);
+            header.layout = layout;
+            header.actionEncoding = (actionEncoding == Encoding::BIT) ? Encoding::INT8 : actionEncoding;
+            if (header.actionEncoding == Encoding::FLOAT32 || header.actionEncoding == Encoding::FLOAT64)
+            {
+                throw std::runtime_error("BinaryDataset::write: Actions must be integers.");
+            }
+            if (!values.empty())
+            {
+                const auto minmax = std::minmax_element(values.begin(), values.end());
+                header.minValue = static_cast<double>(*minmax.first);
+                header.maxValue = static_cast<double>(*minmax.second);
+            }
+            header.situationsOffset = alignTo8(sizeof(Header));
+            header.situationsSize = encodedSize(header.situationEncoding, values.size());
+            header.actionsOffset = alignTo8(header.situationsOffset + header.situationsSize);
+            header.actionsSize = encodedSize(header.actionEncoding, rowCount);
+
+            const char padding[8] = {};
+            std::vector<unsigned char> bytes;
+
+            os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            os.write(padding, header.situationsOffset - sizeof(header));
+            encode(values, header.situationEncoding, bytes);
+            os.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+            os.write(padding, header.actionsOffset - (header.situationsOffset + header.situationsSize));
+            encode(dataset.actions, header.actionEncoding, bytes);
+            os.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+
+            if (!os)
+            {
+                throw std::runtime_error("BinaryDataset::write: Failed to write the dataset.");
+            }
+        }
+
+        // Returns true if the file begins with the magic of the binary dataset
+        inline bool isBinaryDataset(const std::string & filename)
+        {
+            std::ifstream ifs(filename, std::ios::binary);
+            char magic[sizeof(kMagic)];
+            return ifs.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+        }
+
+        // Read-only view of a binary dataset file
+        //   The file is memory-mapped (see MappedFile), and the values are decoded on access.
+        template <typename T, typename Action>
+        class View
+        {
+        protected:
+            const MappedFile m_file;
+            Header m_header;
+            const unsigned char *m_situations;
+            const unsigned char *m_actions;
+
+        public:
+            // Constructor
+            //   Throws std::runtime_error if the file is not a valid binary dataset.
+            explicit View(const std::string & filename) : m_file(filename)
+            {
+                const std::string prefix = "BinaryDataset::View: '" + filename + "' ";
+
+                if (m_file.size() < sizeof(Header))
+                {
+                    throw std::runtime_error(prefix + "is too small.");
+                }
+                std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+
+                if (std::memcmp(m_header.magic, kMagic, sizeof(kMagic)) != 0)
+                {
+                    throw std::runtime_error(prefix + "is not a binary dataset.");
+                }
+                if (m_header.byteOrderMark != kByteOrderMark)
+                {
+                    throw std::runtime_error(prefix + "has a different byte order.");
+                }
+                if (m_header.version != kVersion)
+                {
+                    throw std::runtime_error(prefix + "has an unsupported version (" + std::to_string(m_header.version) + ").");
+                }
+                if (m_header.layout != Layout::ROW_MAJOR && m_header.layout != Layout::COLUMN_MAJOR)
+                {
+                    throw std::runtime_error(prefix + "has an unknown layout.");
+                }
+                // (Each value takes at least a bit of the file, so encodedSize() cannot overflow)
+                const uint64_t maxValueCount = static_cast<uint64_t>(m_file.size()) * 8;
+                if (m_header.rowCount > maxValueCount
+                    || (m_header.columnCount != 0 && m_header.rowCount > maxValueCount / m_header.columnCount)
+                    || m_header.situationsSize != encodedSize(m_header.situationEncoding, m_header.rowCount * m_header.columnCount)
+                    || m_header.actionsSize != encodedSize(m_header.actionEncoding, m_header.rowCount)
+                    || !MappedFile::fits(m_header.situationsOffset, m_header.situationsSize, 1, m_file.size())
+                    || !MappedFile::fits(m_header.actionsOffset, m_header.actionsSize, 1, m_file.size()))
+                {
+                    throw std::runtime_error(prefix + "is broken.");
+                }
+
+                const auto data = reinterpret_cast<const unsigned char *>(m_file.data());
+                m_situations = data + m_header.situationsOffset;
+                m_actions = data + m_header.actionsOffset;
+            }
+
+            View(const View &) = delete;
+            View & operator=(const View &) = delete;
+
+            const Header & header() const noexcept
+            {
+                return m_header;
+            }
+
+            std::size_t size() const noexcept
+            {
+                return m_header.rowCount;
+            }
+
+            std::size_t situationSize() const noexcept
+            {
+                return m_header.columnCount;
+            }
+
+            T valueAt(std::size_t rowIdx, std::size_t columnIdx) const
+            {
+                const std::size_t idx = (m_header.layout == Layout::ROW_MAJOR)
+                    ? rowIdx * m_header.columnCount + columnIdx
+                    : columnIdx * m_header.rowCount + rowIdx;
+                return decode<T>(m_situations, m_header.situationEncoding, idx);
+            }
+
+            // Decode the situation into the vector (reuses its capacity)
+            void situationAt(std::size_t rowIdx, std::vector<T> & situation) const
+            {
+                situation.resize(m_header.columnCount);
+                for (std::size_t j = 0; j < m_header.columnCount; ++j)
+                {
+                    situation[j] = valueAt(rowIdx, j);
+                }
+            }
+
+            std::vector<T> situationAt(std::size_t rowIdx) const
+            {
+                std::vector<T> situation;
+                situationAt(rowIdx, situation);
+                return situation;
+            }
+
+            Action actionAt(std::size_t rowIdx) const
+            {
+                return decode<Action>(m_actions, m_header.actionEncoding, rowIdx);
+            }
+
+            // The min/max of the situation values (for normalize())
+            std::pair<T, T> minmax() const
+            {
+                return { static_cast<T>(m_header.minValue), static_cast<T>(m_header.maxValue) };
+            }
+
+            // Decode the whole dataset
+            Dataset<T, Action> toDataset() const
+            {
+                Dataset<T, Action> dataset;
+                dataset.situations.resize(size());
+                dataset.actions.resize(size());
+                for (std::size_t i = 0; i < size(); ++i)
+                {
+                    situationAt(i, dataset.situations[i]);
+                    dataset.actions[i] = actionAt(i);
+                }
+                return dataset;
+            }
+        };
+    }
+
+}
@@ -0,0 +1,291 @@
+#pragma once
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <type_traits>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#include "xxr/random.hpp"
+
+namespace xxr { namespace Checkpoint
+{
+
+    // Binary checkpoint of the complete experiment state
+    //   (the classifiers with their IDs, the action sets, the time stamp, the random engines,
+    //    the environment states and the accumulators of ExperimentHelper)
+    //
+    //   Layout (native byte order, the values are written as is):
+    //     "XXRCKPT\0" | version (uint32) | byte order mark (uint32) | sections...
+    //   Each section begins with a tag so that a mismatched checkpoint (e.g. another problem
+    //   or another representation) is detected while loading.
+
+    constexpr char kMagic[8] = { 'X', 'X', 'R', 'C', 'K', 'P', 'T', '\0' };
+    constexpr uint32_t kVersion = 3;
+    constexpr uint32_t kByteOrderMark = 0x01020304;
+
+    // Section tags
+    constexpr uint32_t kHelperTag = 0x504C4548; // "HELP"
+    constexpr uint32_t kRandomTag = 0x444E4152; // "RAND"
+    constexpr uint32_t kExperimentTag = 0x50505845; // "EXPP"
+    constexpr uint32_t kEnvironmentTag = 0x4D564E45; // "ENVM"
+
+    class Writer
+    {
+    private:
+        std::ostream & m_os;
+
+    public:
+        explicit Writer(std::ostream & os) : m_os(os)
+        {
+        }
+
+        template <typename T>
+        void write(const T & value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Checkpoint::Writer::write() requires a trivially copyable type");
+            m_os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        void writeString(const std::string & str)
+        {
+            write<uint64_t>(str.size());
+            m_os.write(str.data(), str.size());
+        }
+
+        template <typename T>
+        void writeVector(const std::vector<T> & values)
+        {
+            write<uint64_t>(values.size());
+            for (auto && value : values)
+            {
+                write<T>(value);
+            }
+        }
+
+        void writeVector(const std::vector<bool> & values)
+        {
+            write<uint64_t>(values.size());
+            for (bool value : values)
+            {
+                write<uint8_t>(value ? 1 : 0);
+            }
+        }
+
+        void writeBytes(const void *data, std::size_t size)
+        {
+            m_os.write(static_cast<const char *>(data), size);
+        }
+
+        void writeTag(uint32_t tag)
+        {
+            write<uint32_t>(tag);
+        }
+
+        void writeHeader()
+        {
+            writeBytes(kMagic, sizeof(kMagic));
+            write<uint32_t>(kVersion);
+            write<uint32_t>(kByteOrderMark);
+        }
+
+        // Save the random engine of the current thread
+        void writeRandomEngine()
+        {
+            writeRandomEngineState(Random::engineState());
+        }
+
+        // Save the state of a random engine (see Random::engineState())
+        void writeRandomEngineState(const std::string & state)
+        {
+            writeTag(kRandomTag);
+            writeString(state);
+        }
+
+        bool good() const
+        {
+            return m_os.good();
+        }
+    };
+
+    class Reader
+    {
+    private:
+        std::istream & m_is;
+
+    public:
+        explicit Reader(std::istream & is) : m_is(is)
+        {
+        }
+
+        // Throws std::runtime_error at the end of the checkpoint
+        void readBytes(void *data, std::size_t size)
+        {
+            m_is.read(static_cast<char *>(data), size);
+            if (static_cast<std::size_t>(m_is.gcount()) != size)
+            {
+                throw std::runtime_error("Checkpoint: Unexpected end of the checkpoint.");
+            }
+        }
+
+        template <typename T>
+        T read()
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Checkpoint::Reader::read() requires a trivially copyable type");
+            T value;
+            readBytes(&value, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void read(T & value)
+        {
+            value = read<T>();
+        }
+
+        std::string readString()
+        {
+            std::string str(read<uint64_t>(), '\0');
+            if (!str.empty())
+            {
+                readBytes(&str[0], str.size());
+            }
+            return str;
+        }
+
+        template <typename T>
+        std::vector<T> readVector()
+        {
+            std::vector<T> values(read<uint64_t>());
+            for (auto && value : values)
+            {
+                value = read<T>();
+            }
+            return values;
+        }
+
+        template <typename T>
+        void readVector(std::vector<T> & values)
+        {
+            values = readVector<T>();
+        }
+
+        void readVector(std::vector<bool> & values)
+        {
+            values.resize(read<uint64_t>());
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                values[i] = (read<uint8_t>() != 0);
+            }
+        }
+
+        // Throws std::runtime_error if the next tag is not the expected one
+        void expectTag(uint32_t tag, const std::string & sectionName)
+        {
+            if (read<uint32_t>() != tag)
+            {
+                throw std::runtime_error("Checkpoint: The " + sectionName + " section does not match this experiment.");
+            }
+        }
+
+        void readHeader()
+        {
+            char magic[sizeof(kMagic)];
+            readBytes(magic, sizeof(magic));
+            if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+            {
+                throw std::runtime_error("Checkpoint: Not a checkpoint file.");
+            }
+            if (read<uint32_t>() != kVersion)
+            {
+                throw std::runtime_error("Checkpoint: Unsupported checkpoint version.");
+            }
+            if (read<uint32_t>() != kByteOrderMark)
+            {
+                throw std::runtime_error("Checkpoint: The checkpoint was written on a machine with a different byte order.");
+            }
+        }
+
+        // Restore the random engine of the current thread
+        void readRandomEngine()
+        {
+            Random::setEngineState(readRandomEngineState());
+        }
+
+        // Read the state of a random engine saved by writeRandomEngineState()
+        std::string readRandomEngineState()
+        {
+            expectTag(kRandomTag, "random engine");
+            std::string state = readString();
+            std::istringstream iss(state);
+            std::mt19937 engine;
+            if (!(iss >> engine))
+            {
+                throw std::runtime_error("Checkpoint: Invalid random engine state.");
+            }
+            return state;
+        }
+    };
+
+    // Save a classifier (with its ID)
+    template <class StoredClassifier>
+    void writeClassifier(Writer & writer, const StoredClassifier & cl)
+    {
+        using SymbolType = typename StoredClassifier::SymbolType;
+
+        writer.write<uint64_t>(cl.id);
+        writer.write<uint64_t>(cl.condition.size());
+        std::vector<unsigned char> buffer(SymbolType::binarySize());
+        for (std::size_t i = 0; i < cl.condition.size(); ++i)
+        {
+            cl.condition.at(i).writeBinary(buffer.data());
+            writer.writeBytes(buffer.data(), buffer.size());
+        }
+        writer.write(cl.action);
+        writer.write<double>(cl.prediction);
+        writer.write<double>(cl.epsilon);
+        writer.write<double>(cl.fitness);
+        writer.write<uint64_t>(cl.experience);
+        writer.write<uint64_t>(cl.timeStamp);
+        writer.write<double>(cl.actionSetSize);
+        writer.write<uint64_t>(cl.numerosity);
+    }
+
+    // Load a classifier saved by writeClassifier() (the ID is stored to *pId)
+    template <class Classifier>
+    Classifier readClassifier(Reader & reader, uint64_t *pId)
+    {
+        using SymbolType = typename Classifier::SymbolType;
+        using ConditionType = typename Classifier::ConditionType;
+        using ActionType = typename Classifier::ActionType;
+
+        *pId = reader.read<uint64_t>();
+
+        const uint64_t conditionLength = reader.read<uint64_t>();
+        std::vector<SymbolType> symbols;
+        symbols.reserve(conditionLength);
+        std::vector<unsigned char> buffer(SymbolType::binarySize());
+        for (uint64_t i = 0; i < conditionLength; ++i)
+        {
+            reader.readBytes(buffer.data(), buffer.size());
+            symbols.push_back(SymbolType::readBinary(buffer.data()));
+        }
+        const auto action = reader.read<ActionType>();
+        const double prediction = reader.read<double>();
+        const double epsilon = reader.read<double>();
+        const double fitness = reader.read<double>();
+        const uint64_t experience = reader.read<uint64_t>();
+        const uint64_t timeStamp = reader.read<uint64_t>();
+
+        Classifier cl(ConditionType(symbols), action, prediction, epsilon, fitness, timeStamp);
+        cl.experience = experience;
+        cl.actionSetSize = reader.read<double>();
+        cl.numerosity = reader.read<uint64_t>();
+        return cl;
+    }
+
+}}
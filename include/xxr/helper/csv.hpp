@@ -3,10 +3,20 @@
 #include <sstream>
 #include <fstream>
 #include <vector>
+#include <string>
+#include <thread>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
 #include <cstddef>
 
 #include "dataset.hpp"
+#include "mapped_file.hpp"
 #include "xxr/xcs/classifier.hpp"
 
 namespace xxr
@@ -64,15 +74,234 @@ namespace xxr
             return situations;
         }
 
+        // Row-major table of the values in a CSV file
+        //   The values of the i-th row are values[rowOffsets[i]] ... values[rowOffsets[i + 1] - 1].
+        struct Table
+        {
+            std::vector<float> values;
+            std::vector<std::size_t> rowOffsets = { 0 };
+
+            std::size_t rowCount() const noexcept
+            {
+                return rowOffsets.size() - 1;
+            }
+
+            std::size_t rowSize(std::size_t rowIdx) const noexcept
+            {
+                return rowOffsets[rowIdx + 1] - rowOffsets[rowIdx];
+            }
+
+            const float *rowAt(std::size_t rowIdx) const noexcept
+            {
+                return values.data() + rowOffsets[rowIdx];
+            }
+        };
+
+        // Parse a field in the same way as std::stof() (without allocating a string for short fields)
+        inline float parseField(const char *first, const char *last)
+        {
+            char buffer[64];
+            std::string longField;
+            const char *str;
+            const std::size_t length = static_cast<std::size_t>(last - first);
+            if (length < sizeof(buffer))
+            {
+                std::memcpy(buffer, first, length);
+                buffer[length] = '\0';
+                str = buffer;
+            }
+            else
+            {
+                longField.assign(first, last);
+                str = longField.c_str();
+            }
+
+            char *end;
+            errno = 0;
+            const float value = std::strtof(str, &end);
+            if (end == str)
+            {
+                throw std::invalid_argument("stof");
+            }
+            if (errno == ERANGE)
+            {
+                throw std::out_of_range("stof");
+            }
+            return value;
+        }
+
+        // Parse the lines in [first, last) (first must be the beginning of a line)
+        //   The lines are split in the same way as readSituations(std::istream &): the parsing
+        //   stops at the first empty line, and a trailing comma does not make an empty field.
+        //   Returns true if an empty line is found.
+        inline bool parseChunk(const char *first, const char *last, Table & table)
+        {
+            const char *p = first;
+            while (p < last)
+            {
+                const char *lineEnd = static_cast<const char *>(std::memchr(p, '\n', last - p));
+                if (lineEnd == nullptr)
+                {
+                    lineEnd = last;
+                }
+
+                if (lineEnd == p)
+                {
+                    return true;
+                }
+
+                const char *fieldFirst = p;
+                while (fieldFirst < lineEnd)
+                {
+                    const char *fieldLast = static_cast<const char *>(std::memchr(fieldFirst, ',', lineEnd - fieldFirst));
+                    if (fieldLast == nullptr)
+                    {
+                        fieldLast = lineEnd;
+                    }
+                    table.values.push_back(parseField(fieldFirst, fieldLast));
+                    fieldFirst = fieldLast + 1;
+                }
+                table.rowOffsets.push_back(table.values.size());
+
+                p = lineEnd + 1;
+            }
+            return false;
+        }
+
+        // Read a CSV file into tables of consecutive rows
+        //   The file is memory-mapped and split into chunks at line boundaries, which are
+        //   parsed in parallel (threadCount = 0: the number of hardware threads). The
+        //   values are the same as those of readSituations(std::istream &).
+        inline std::vector<Table> readTableChunks(const std::string & filename, std::size_t threadCount = 0)
+        {
+            // The minimum chunk size in bytes (small files are parsed in a single thread)
+            constexpr std::size_t kMinChunkSize = 1 << 20;
+
+            const MappedFile file(filename);
+            const char *data = file.data();
+            const std::size_t size = file.size();
+
+            if (threadCount == 0)
+            {
+                threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+            }
+            const std::size_t chunkCount = std::max<std::size_t>(std::min(threadCount, size / kMinChunkSize), 1);
+
+            // Split at line boundaries
+            std::vector<std::size_t> chunkOffsets = { 0 };
+            for (std::size_t i = 1; i < chunkCount; ++i)
+            {
+                std::size_t offset = std::max(size / chunkCount * i, chunkOffsets.back());
+                const char *lineEnd = static_cast<const char *>(std::memchr(data + offset, '\n', size - offset));
+                offset = (lineEnd == nullptr) ? size : static_cast<std::size_t>(lineEnd - data) + 1;
+                chunkOffsets.push_back(offset);
+            }
+            chunkOffsets.push_back(size);
+
+            std::vector<Table> tables(chunkCount);
+            std::vector<char> foundEmptyLines(chunkCount, false);
+            std::vector<std::exception_ptr> exceptions(chunkCount);
+            auto parse = [&](std::size_t i) {
+                try
+                {
+                    foundEmptyLines[i] = parseChunk(data + chunkOffsets[i], data + chunkOffsets[i + 1], tables[i]);
+                }
+                catch (...)
+                {
+                    exceptions[i] = std::current_exception();
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (std::size_t i = 1; i < chunkCount; ++i)
+            {
+                threads.emplace_back(parse, i);
+            }
+            parse(0);
+            for (auto && thread : threads)
+            {
+                thread.join();
+            }
+
+            // Drop the chunks after the first empty line (and their errors)
+            for (std::size_t i = 0; i < chunkCount; ++i)
+            {
+                if (exceptions[i])
+                {
+                    std::rethrow_exception(exceptions[i]);
+                }
+                if (foundEmptyLines[i])
+                {
+                    tables.resize(i + 1);
+                    break;
+                }
+            }
+
+            return tables;
+        }
+
+        // Read a CSV file into a single row-major table
+        inline Table readTable(const std::string & filename, std::size_t threadCount = 0)
+        {
+            auto tables = readTableChunks(filename, threadCount);
+            if (tables.size() == 1)
+            {
+                return std::move(tables.front());
+            }
+
+            Table table;
+            std::size_t valueCount = 0;
+            std::size_t rowCount = 0;
+            for (auto && chunk : tables)
+            {
+                valueCount += chunk.values.size();
+                rowCount += chunk.rowCount();
+            }
+            table.values.reserve(valueCount);
+            table.rowOffsets.reserve(rowCount + 1);
+            for (auto && chunk : tables)
+            {
+                const std::size_t base = table.values.size();
+                table.values.insert(table.values.end(), chunk.values.begin(), chunk.values.end());
+                for (std::size_t i = 1; i < chunk.rowOffsets.size(); ++i)
+                {
+                    table.rowOffsets.push_back(base + chunk.rowOffsets[i]);
+                }
+            }
+            return table;
+        }
+
+        template <typename T>
+        std::vector<std::vector<T>> readSituations(const std::string & filename, bool rounds = false)
+        {
+            std::vector<std::vector<T>> situations;
+            for (auto && table : readTableChunks(filename))
+            {
+                for (std::size_t i = 0; i < table.rowCount(); ++i)
+                {
+                    const float *row = table.rowAt(i);
+                    std::vector<T> situation(table.rowSize(i));
+                    for (std::size_t j = 0; j < situation.size(); ++j)
+                    {
+                        const double fieldValue = row[j];
+                        situation[j] = static_cast<T>(rounds ? std::round(fieldValue) : fieldValue);
+                    }
+                    situations.push_back(std::move(situation));
+                }
+            }
+            return situations;
+        }
+
+        // Read at most maxCount lines (the rest can be read by calling this again)
         template <typename T, typename Action>
-        Dataset<T, Action> readDataset(std::istream & is, bool rounds = false)
+        Dataset<T, Action> readDataset(std::istream & is, bool rounds = false, std::size_t maxCount = std::numeric_limits<std::size_t>::max())
         {
             std::vector<std::vector<T>> situations;
             std::vector<Action> actions;
 
             // Load all lines from csv
             std::string line;
-            while (std::getline(is, line) && !line.empty())
+            while (situations.size() < maxCount && std::getline(is, line) && !line.empty())
             {
                 // Split comma-separated string
                 std::istringstream iss(line);
@@ -105,12 +334,25 @@ namespace xxr
         template <typename T, typename Action>
         Dataset<T, Action> readDataset(const std::string & filename, bool rounds = false)
         {
-            std::ifstream ifs(filename);
-            if (!ifs.good())
+            std::vector<std::vector<T>> situations;
+            std::vector<Action> actions;
+            for (auto && table : readTableChunks(filename))
             {
-                throw new std::runtime_error("Error: Cannot open file '" + filename + "'");
+                for (std::size_t i = 0; i < table.rowCount(); ++i)
+                {
+                    // Last field is action
+                    const float *row = table.rowAt(i);
+                    std::vector<T> situation(table.rowSize(i) - 1);
+                    for (std::size_t j = 0; j < situation.size(); ++j)
+                    {
+                        const double fieldValue = row[j];
+                        situation[j] = static_cast<T>(rounds ? std::round(fieldValue) : fieldValue);
+                    }
+                    actions.push_back(static_cast<Action>(static_cast<double>(row[situation.size()])));
+                    situations.push_back(std::move(situation));
+                }
             }
-            return readDataset<T, Action>(ifs, rounds);
+            return { std::move(situations), std::move(actions) };
         }
 
         template <class Classifier>
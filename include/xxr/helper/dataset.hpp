@@ -1,5 +1,7 @@
 #pragma once
 #include <vector>
+#include <cstddef>
+#include <cassert>
 
 namespace xxr
 {
@@ -11,6 +13,22 @@ namespace xxr
         std::vector<Action> actions;
     };
 
+    // Returns the idx-th of the count partitions of the dataset
+    // (the data are assigned to the partitions in round-robin order)
+    template <typename T, typename Action>
+    Dataset<T, Action> partition(const Dataset<T, Action> & dataset, std::size_t count, std::size_t idx)
+    {
+        assert(idx < count);
+
+        Dataset<T, Action> partitionedDataset;
+        for (std::size_t i = idx; i < dataset.situations.size(); i += count)
+        {
+            partitionedDataset.situations.push_back(dataset.situations[i]);
+            partitionedDataset.actions.push_back(dataset.actions[i]);
+        }
+        return partitionedDataset;
+    }
+
     // Normalize data by min/max value
     template <typename T>
     void normalize(std::vector<std::vector<T>> & situations, T min, T max)
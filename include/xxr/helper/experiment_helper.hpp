@@ -1,15 +1,23 @@
 #pragma once
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <memory>
 #include <functional>
 #include <unordered_set>
+#include <thread>
+#include <exception>
+#include <stdexcept>
 #include <cstdio>
 #include <cstddef>
 #include <cmath>
 #include "../environment/environment.hpp"
 #include "experiment_settings.hpp"
 #include "experiment_log_stream.hpp"
+#include "checkpoint.hpp"
+#include "population_csv.hpp"
+#include "../profiler.hpp"
+#include "../tracer.hpp"
 
 namespace xxr
 {
@@ -25,7 +33,42 @@ namespace xxr
 
         virtual void switchToCondensationMode() = 0;
 
-        virtual void dumpPopulation(std::size_t seedIdx, std::ostream & os) const = 0;
+        virtual void dumpPopulation(std::size_t seedIdx, std::ostream & os, const PopulationCSV::Format & format = PopulationCSV::Format()) const = 0;
+
+        virtual void dumpPopulationBinary(std::size_t seedIdx, std::ostream & os) const = 0;
+
+        // Merge the populations of all islands into the first experiment (island model only)
+        virtual void mergeIslands() {}
+
+        // Wait until the logs are written to the files
+        virtual void flushLogs() = 0;
+
+        // The number of the iterations run so far (including the ones restored from a checkpoint)
+        virtual std::size_t iterationCount() const = 0;
+
+        // Save/load the complete state of the experiments, the environments and the random engine (see Checkpoint)
+        virtual void saveCheckpoint(std::ostream & os) const = 0;
+
+        virtual void loadCheckpoint(const std::string & filename) = 0;
+
+        // Write the checkpoint to the file of the settings (in the background)
+        virtual void writeCheckpoint() = 0;
+
+        // Wait until the checkpoint is written
+        //   Throws std::runtime_error if the checkpoint could not be written.
+        virtual void waitForCheckpoint() = 0;
+
+        // Write the phase profile of the hot path to the file of the settings (see Profiler)
+        //   Throws std::runtime_error if the profile could not be written.
+        virtual void writeProfile() const = 0;
+
+        // Write the memory report of the experiments to the file of the settings (see MemoryUsage)
+        //   Throws std::runtime_error if the report could not be written.
+        virtual void writeMemoryReport() const = 0;
+
+        // Stop the tracer and write the timeline trace to the file of the settings (see Tracer)
+        //   Throws std::runtime_error if the trace could not be written.
+        virtual void writeTrace() const = 0;
     };
 
     template <class Experiment, class Environment>
@@ -33,12 +76,14 @@ namespace xxr
     {
     protected:
         const ExperimentSettings m_settings;
+        std::ofstream m_journalStream; // declared before m_experiments, which write to it
         std::vector<std::unique_ptr<Experiment>> m_experiments;
         std::vector<std::unique_ptr<Environment>> m_explorationEnvironments;
         std::vector<std::unique_ptr<Environment>> m_exploitationEnvironments;
         std::function<void(Environment &)> m_explorationCallback;
         std::function<void(Environment &)> m_exploitationCallback;
-        std::ofstream m_summaryLogStream;
+        AsyncLogWriter m_logWriter;
+        ExperimentLogStream m_summaryLogStream;
         bool m_outputSummaryLogFile;
         SMAExperimentLogStream m_rewardLogStream;
         SMAExperimentLogStream m_systemErrorLogStream;
@@ -50,7 +95,73 @@ namespace xxr
         double m_summaryPopulationSizeSum;
         double m_summaryCoveringOccurrenceRateSum;
         double m_summaryStepCountSum;
+        double m_exploitationReward; // the reward of the last exploitation (see exploitationReward())
+        ExperimentStats m_summaryStats; // the sum of the counters of the experiments at the previous summary output
+        Profiler::Profile m_summaryProfile; // the profile at the previous summary output
         std::size_t m_iterationCount;
+        bool m_isTraceStarted;
+        std::thread m_checkpointThread;
+        std::exception_ptr m_checkpointException;
+
+        // The states of the random engines of the island threads restored from a checkpoint
+        //   (see IslandExperimentHelper, empty without the island model)
+        std::vector<std::string> m_islandRandomEngineStates;
+
+        // The current states of the random engines of the island threads (none without the island model)
+        virtual std::vector<std::string> islandRandomEngineStates() const
+        {
+            return {};
+        }
+
+        // Start the tracer at the first iteration of the trace window and stop it after the last one
+        //   (the trace is kept in memory until writeTrace())
+        void updateTracer()
+        {
+            if (m_settings.outputTraceFilename.empty())
+            {
+                return;
+            }
+
+            if (!m_isTraceStarted && m_iterationCount >= m_settings.traceFromIteration && m_iterationCount < m_settings.traceToIteration)
+            {
+                Tracer::start();
+                m_isTraceStarted = true;
+            }
+            else if (m_iterationCount >= m_settings.traceToIteration && Tracer::isActive())
+            {
+                Tracer::stop();
+            }
+        }
+
+        // Whether the checkpoint should be written at the current iteration
+        bool isCheckpointDue() const
+        {
+            return m_settings.checkpointInterval > 0
+                && !m_settings.outputCheckpointFilename.empty()
+                && m_iterationCount % m_settings.checkpointInterval == 0;
+        }
+
+        // The sum of the counters of the experiments
+        ExperimentStats statsSum() const
+        {
+            ExperimentStats stats;
+            for (auto && experiment : m_experiments)
+            {
+                stats += experiment->stats();
+            }
+            return stats;
+        }
+
+        // The log streams whose states are saved to the checkpoints
+        std::vector<ExperimentLogStream *> logStreams()
+        {
+            return { &m_summaryLogStream, &m_rewardLogStream, &m_systemErrorLogStream, &m_stepCountLogStream, &m_populationSizeLogStream };
+        }
+
+        std::vector<const ExperimentLogStream *> logStreams() const
+        {
+            return { &m_summaryLogStream, &m_rewardLogStream, &m_systemErrorLogStream, &m_stepCountLogStream, &m_populationSizeLogStream };
+        }
 
         template <class... Args>
         std::vector<std::unique_ptr<Experiment>> makeExperiments(
@@ -123,56 +234,115 @@ namespace xxr
                 }
 
                 m_summaryStepCountSum += static_cast<double>(totalStepCount) / m_settings.exploitationCount / m_settings.seedCount;
+                m_exploitationReward = rewardSum / m_settings.exploitationCount / m_settings.seedCount;
+
+                outputIterationLog(totalStepCount, rewardSum, systemErrorSum, populationSizeSum);
+            }
+        }
 
-                if (m_settings.summaryInterval > 0 && (m_iterationCount + 1) % m_settings.summaryInterval == 0)
+        // Output the summary and the logs of the exploitation in the current iteration
+        // (the summary sums must be accumulated before this)
+        virtual void outputIterationLog(std::size_t totalStepCount, double rewardSum, double systemErrorSum, double populationSizeSum)
+        {
+            if (m_settings.summaryInterval > 0 && (m_iterationCount + 1) % m_settings.summaryInterval == 0)
+            {
+                if (!m_alreadyOutputSummaryHeader)
                 {
-                    if (!m_alreadyOutputSummaryHeader)
+                    if (m_settings.outputSummaryToStdout)
+                    {
+                        std::cout
+                            << "  Iteration      Reward      SysErr     PopSize  CovOccRate   TotalStep\n"
+                            << " ========== =========== =========== =========== =========== ===========" << std::endl;
+                    }
+                    if (m_summaryLogStream)
                     {
-                        if (m_settings.outputSummaryToStdout)
+                        std::string header = "Iteration,Reward,SysErr,PopSize,CovOccRate,TotalStep";
+                        if (m_settings.outputStatsInSummary)
                         {
-                            std::cout
-                                << "  Iteration      Reward      SysErr     PopSize  CovOccRate   TotalStep\n"
-                                << " ========== =========== =========== =========== =========== ===========" << std::endl;
+                            // The counts during the interval (the average of the seeds) and the set sizes
+                            header += ",Tested,Matched,Covering,CoveringCl,GA,ChildInserted,ChildSubsumed,ChildDuplicated"
+                                ",ASSubsumption,ASSubsumedCl,DeletedCl,NumDecrement,MSetSize,MaxMSetSize,ASetSize,MaxASetSize";
                         }
-                        if (m_summaryLogStream)
+                        if (Profiler::kEnabled)
                         {
-                            m_summaryLogStream << "Iteration,Reward,SysErr,PopSize,CovOccRate,TotalStep" << std::endl;
+                            // The seconds spent in each phase during the interval (the sum of all seeds)
+                            for (std::size_t i = 0; i < Profiler::kPhaseCount; ++i)
+                            {
+                                header += std::string(",") + Profiler::phaseName(static_cast<Profiler::Phase>(i)) + "Time";
+                            }
                         }
-                        m_alreadyOutputSummaryHeader = true;
+                        m_summaryLogStream.writeLine(header);
                     }
-                    if (m_settings.outputSummaryToStdout)
+                    m_alreadyOutputSummaryHeader = true;
+                }
+                if (m_settings.outputSummaryToStdout)
+                {
+                    std::printf("%11u %11.3f %11.3f %11.3f  %1.8f %11.3f\n",
+                        static_cast<unsigned int>(m_iterationCount + 1),
+                        m_summaryRewardSum / m_settings.summaryInterval,
+                        m_summarySystemErrorSum / m_settings.summaryInterval,
+                        m_summaryPopulationSizeSum / m_settings.summaryInterval,
+                        m_summaryCoveringOccurrenceRateSum / m_settings.summaryInterval,
+                        m_summaryStepCountSum / m_settings.summaryInterval);
+                    std::fflush(stdout);
+                }
+                if (m_summaryLogStream)
+                {
+                    std::ostringstream line;
+                    line
+                        << (m_iterationCount + 1) << ','
+                        << m_summaryRewardSum / m_settings.summaryInterval << ','
+                        << m_summarySystemErrorSum / m_settings.summaryInterval << ','
+                        << m_summaryPopulationSizeSum / m_settings.summaryInterval << ','
+                        << m_summaryCoveringOccurrenceRateSum / m_settings.summaryInterval << ','
+                        << m_summaryStepCountSum / m_settings.summaryInterval;
+                    if (m_settings.outputStatsInSummary)
                     {
-                        std::printf("%11u %11.3f %11.3f %11.3f  %1.8f %11.3f\n",
-                            static_cast<unsigned int>(m_iterationCount + 1),
-                            m_summaryRewardSum / m_settings.summaryInterval,
-                            m_summarySystemErrorSum / m_settings.summaryInterval,
-                            m_summaryPopulationSizeSum / m_settings.summaryInterval,
-                            m_summaryCoveringOccurrenceRateSum / m_settings.summaryInterval,
-                            m_summaryStepCountSum / m_settings.summaryInterval);
-                        std::fflush(stdout);
+                        const ExperimentStats stats = statsSum();
+                        const ExperimentStats intervalStats = stats - m_summaryStats;
+                        const double seedCount = static_cast<double>(m_settings.seedCount);
+                        line
+                            << ',' << intervalStats.testedClassifierCount / seedCount
+                            << ',' << intervalStats.matchedClassifierCount / seedCount
+                            << ',' << intervalStats.coveringCount / seedCount
+                            << ',' << intervalStats.coveringClassifierCount / seedCount
+                            << ',' << intervalStats.gaCount / seedCount
+                            << ',' << intervalStats.insertedChildCount / seedCount
+                            << ',' << intervalStats.subsumedChildCount / seedCount
+                            << ',' << intervalStats.duplicatedChildCount / seedCount
+                            << ',' << intervalStats.actionSetSubsumptionCount / seedCount
+                            << ',' << intervalStats.actionSetSubsumedClassifierCount / seedCount
+                            << ',' << intervalStats.deletedClassifierCount / seedCount
+                            << ',' << intervalStats.numerosityDecrementCount / seedCount
+                            << ',' << intervalStats.meanMatchSetSize()
+                            << ',' << intervalStats.maxMatchSetSize
+                            << ',' << intervalStats.meanActionSetSize()
+                            << ',' << intervalStats.maxActionSetSize;
+                        m_summaryStats = stats;
                     }
-                    if (m_summaryLogStream)
+                    if (Profiler::kEnabled)
                     {
-                        m_summaryLogStream
-                            << (m_iterationCount + 1) << ','
-                            << m_summaryRewardSum / m_settings.summaryInterval << ','
-                            << m_summarySystemErrorSum / m_settings.summaryInterval << ','
-                            << m_summaryPopulationSizeSum / m_settings.summaryInterval << ','
-                            << m_summaryCoveringOccurrenceRateSum / m_settings.summaryInterval << ','
-                            << m_summaryStepCountSum / m_settings.summaryInterval << std::endl;
+                        const Profiler::Profile profile = Profiler::snapshot();
+                        const Profiler::Profile intervalProfile = profile - m_summaryProfile;
+                        for (std::size_t i = 0; i < Profiler::kPhaseCount; ++i)
+                        {
+                            line << ',' << intervalProfile.secondsOf(static_cast<Profiler::Phase>(i));
+                        }
+                        m_summaryProfile = profile;
                     }
-                    m_summaryRewardSum = 0.0;
-                    m_summarySystemErrorSum = 0.0;
-                    m_summaryPopulationSizeSum = 0.0;
-                    m_summaryCoveringOccurrenceRateSum = 0.0;
-                    m_summaryStepCountSum = 0.0;
+                    m_summaryLogStream.writeLine(line.str());
                 }
-
-                m_rewardLogStream.writeLine(rewardSum / m_settings.exploitationCount / m_settings.seedCount);
-                m_systemErrorLogStream.writeLine(systemErrorSum / m_settings.exploitationCount / m_settings.seedCount);
-                m_populationSizeLogStream.writeLine(populationSizeSum / m_settings.exploitationCount / m_settings.seedCount);
-                m_stepCountLogStream.writeLine(static_cast<double>(totalStepCount) / m_settings.exploitationCount / m_settings.seedCount);
+                m_summaryRewardSum = 0.0;
+                m_summarySystemErrorSum = 0.0;
+                m_summaryPopulationSizeSum = 0.0;
+                m_summaryCoveringOccurrenceRateSum = 0.0;
+                m_summaryStepCountSum = 0.0;
             }
+
+            m_rewardLogStream.writeLine(rewardSum / m_settings.exploitationCount / m_settings.seedCount);
+            m_systemErrorLogStream.writeLine(systemErrorSum / m_settings.exploitationCount / m_settings.seedCount);
+            m_populationSizeLogStream.writeLine(populationSizeSum / m_settings.exploitationCount / m_settings.seedCount);
+            m_stepCountLogStream.writeLine(static_cast<double>(totalStepCount) / m_settings.exploitationCount / m_settings.seedCount);
         }
 
         virtual void runExplorationIteration()
@@ -219,18 +389,21 @@ namespace xxr
             , m_exploitationEnvironments(std::move(exploitationEnvironments))
             , m_explorationCallback(std::move(explorationCallback))
             , m_exploitationCallback(std::move(exploitationCallback))
-            , m_summaryLogStream(settings.outputSummaryFilename.empty() ? "" : (settings.outputFilenamePrefix + settings.outputSummaryFilename))
-            , m_rewardLogStream(settings.outputRewardFilename.empty() ? "" : (settings.outputFilenamePrefix + settings.outputRewardFilename), settings.smaWidth, false)
-            , m_systemErrorLogStream(settings.outputSystemErrorFilename.empty() ? "" : (settings.outputFilenamePrefix + settings.outputSystemErrorFilename), settings.smaWidth, false)
-            , m_stepCountLogStream(settings.outputStepCountFilename.empty() ? "" : (settings.outputFilenamePrefix + settings.outputStepCountFilename), settings.smaWidth, false)
-            , m_populationSizeLogStream(settings.outputPopulationSizeFilename.empty() ? "" : (settings.outputFilenamePrefix + settings.outputPopulationSizeFilename), false)
+            , m_summaryLogStream(settings.outputSummaryFilename.empty() ? "" : (settings.outputFilenamePrefix + settings.outputSummaryFilename), false, &m_logWriter, !settings.inputCheckpointFilename.empty())
+            , m_rewardLogStream(settings.outputRewardFilename.empty() ? "" : (settings.outputFilenamePrefix + settings.outputRewardFilename), settings.smaWidth, false, &m_logWriter, !settings.inputCheckpointFilename.empty())
+            , m_systemErrorLogStream(settings.outputSystemErrorFilename.empty() ? "" : (settings.outputFilenamePrefix + settings.outputSystemErrorFilename), settings.smaWidth, false, &m_logWriter, !settings.inputCheckpointFilename.empty())
+            , m_stepCountLogStream(settings.outputStepCountFilename.empty() ? "" : (settings.outputFilenamePrefix + settings.outputStepCountFilename), settings.smaWidth, false, &m_logWriter, !settings.inputCheckpointFilename.empty())
+            , m_populationSizeLogStream(settings.outputPopulationSizeFilename.empty() ? "" : (settings.outputFilenamePrefix + settings.outputPopulationSizeFilename), false, &m_logWriter, !settings.inputCheckpointFilename.empty())
             , m_alreadyOutputSummaryHeader(false)
             , m_summaryRewardSum(0.0)
             , m_summarySystemErrorSum(0.0)
             , m_summaryPopulationSizeSum(0.0)
             , m_summaryCoveringOccurrenceRateSum(0.0)
             , m_summaryStepCountSum(0.0)
+            , m_exploitationReward(0.0)
+            , m_summaryProfile(Profiler::snapshot())
             , m_iterationCount(0)
+            , m_isTraceStarted(false)
         {
             if (!settings.inputClassifierFilename.empty())
             {
@@ -239,17 +412,61 @@ namespace xxr
                     experiment->loadPopulationCSV(settings.inputClassifierFilename, !settings.useInputClassifierToResume);
                 }
             }
+
+            if (!settings.inputClassifierBinaryFilename.empty())
+            {
+                for (auto && experiment : m_experiments)
+                {
+                    experiment->loadPopulationBinary(settings.inputClassifierBinaryFilename, !settings.useInputClassifierToResume);
+                }
+            }
+
+            if (!settings.inputCheckpointFilename.empty())
+            {
+                loadCheckpoint(settings.inputCheckpointFilename);
+            }
+
+            if (!settings.outputJournalFilename.empty())
+            {
+                const std::string filename = settings.outputFilenamePrefix + settings.outputJournalFilename;
+                m_journalStream.open(filename, std::ios::binary);
+                if (!m_journalStream)
+                {
+                    throw std::runtime_error("Error: Cannot open file '" + filename + "'");
+                }
+                m_experiments[0]->startJournal(m_journalStream);
+            }
         }
 
-        virtual ~ExperimentHelper() = default;
+        // Destructor
+        virtual ~ExperimentHelper()
+        {
+            if (m_journalStream.is_open())
+            {
+                m_experiments[0]->stopJournal();
+            }
+
+            if (m_checkpointThread.joinable())
+            {
+                m_checkpointThread.join();
+            }
+        }
 
         virtual void runIteration(std::size_t repeat = 1) override
         {
             for (std::size_t i = 0; i < repeat; ++i)
             {
+                updateTracer();
                 runExploitationIteration();
                 runExplorationIteration();
                 ++m_iterationCount;
+
+                flushJournal();
+
+                if (isCheckpointDue())
+                {
+                    writeCheckpoint();
+                }
             }
         }
 
@@ -266,6 +483,12 @@ namespace xxr
             return m_settings.seedCount;
         }
 
+        // The reward of the exploitation in the last iteration (the average of the seeds and the exploitation episodes)
+        double exploitationReward() const noexcept
+        {
+            return m_exploitationReward;
+        }
+
         Experiment & experimentAt(std::size_t seedIdx)
         {
             return *m_experiments[seedIdx];
@@ -281,9 +504,257 @@ namespace xxr
             return *m_exploitationEnvironments[seedIdx];
         }
         
-        virtual void dumpPopulation(std::size_t seedIdx, std::ostream & os) const override
+        virtual void dumpPopulation(std::size_t seedIdx, std::ostream & os, const PopulationCSV::Format & format = PopulationCSV::Format()) const override
+        {
+            m_experiments[seedIdx]->dumpPopulation(os, format);
+        }
+
+        virtual void dumpPopulationBinary(std::size_t seedIdx, std::ostream & os) const override
+        {
+            m_experiments[seedIdx]->dumpPopulationBinary(os);
+        }
+
+        virtual void flushLogs() override
         {
-            m_experiments[seedIdx]->dumpPopulation(os);
+            m_logWriter.flush();
+            flushJournal();
+        }
+
+        // Flush the population journal so that the readers can follow it at every iteration
+        void flushJournal()
+        {
+            if (m_journalStream.is_open())
+            {
+                m_experiments[0]->flushJournal();
+            }
+        }
+
+        virtual std::size_t iterationCount() const override
+        {
+            return m_iterationCount;
+        }
+
+        // Save the complete state
+        //   The continuation from the checkpoint is identical to the original run unless
+        //   the experiments use the asynchronous GA, whose commits depend on the timing of
+        //   the threads. The random engines of the island threads are saved as well.
+        virtual void saveCheckpoint(std::ostream & os) const override
+        {
+            Checkpoint::Writer writer(os);
+            writer.writeHeader();
+
+            writer.writeTag(Checkpoint::kHelperTag);
+            writer.write<uint64_t>(m_settings.seedCount);
+            writer.write<uint64_t>(m_iterationCount);
+            writer.write<double>(m_summaryRewardSum);
+            writer.write<double>(m_summarySystemErrorSum);
+            writer.write<double>(m_summaryPopulationSizeSum);
+            writer.write<double>(m_summaryCoveringOccurrenceRateSum);
+            writer.write<double>(m_summaryStepCountSum);
+            writer.write<ExperimentStats>(m_summaryStats);
+            writer.write<double>(m_exploitationReward);
+            writer.write<bool>(m_alreadyOutputSummaryHeader);
+            for (const ExperimentLogStream *pLogStream : logStreams())
+            {
+                pLogStream->saveState(writer);
+            }
+
+            writer.writeRandomEngine();
+            const std::vector<std::string> islandRandomEngineStates = this->islandRandomEngineStates();
+            writer.write<uint64_t>(islandRandomEngineStates.size());
+            for (auto && state : islandRandomEngineStates)
+            {
+                writer.writeRandomEngineState(state);
+            }
+
+            for (std::size_t i = 0; i < m_settings.seedCount; ++i)
+            {
+                m_experiments[i]->saveCheckpoint(writer);
+                m_explorationEnvironments[i]->saveState(writer);
+                m_exploitationEnvironments[i]->saveState(writer);
+            }
+        }
+
+        // Load the state saved by saveCheckpoint()
+        //   Throws std::runtime_error if the file cannot be read or does not match the experiments.
+        virtual void loadCheckpoint(const std::string & filename) override
+        {
+            std::ifstream ifs(filename, std::ios::binary);
+            if (!ifs)
+            {
+                throw std::runtime_error("Error: Cannot open file '" + filename + "'");
+            }
+
+            Checkpoint::Reader reader(ifs);
+            reader.readHeader();
+
+            reader.expectTag(Checkpoint::kHelperTag, "helper");
+            if (reader.read<uint64_t>() != m_settings.seedCount)
+            {
+                throw std::runtime_error("Checkpoint: The number of seeds does not match this experiment.");
+            }
+            m_iterationCount = reader.read<uint64_t>();
+            m_summaryRewardSum = reader.read<double>();
+            m_summarySystemErrorSum = reader.read<double>();
+            m_summaryPopulationSizeSum = reader.read<double>();
+            m_summaryCoveringOccurrenceRateSum = reader.read<double>();
+            m_summaryStepCountSum = reader.read<double>();
+            reader.read(m_summaryStats);
+            reader.read(m_exploitationReward);
+            reader.read(m_alreadyOutputSummaryHeader);
+            for (ExperimentLogStream *pLogStream : logStreams())
+            {
+                pLogStream->loadState(reader);
+            }
+
+            reader.readRandomEngine();
+            const uint64_t islandCount = reader.read<uint64_t>();
+            if (islandCount != 0 && islandCount != m_settings.seedCount)
+            {
+                throw std::runtime_error("Checkpoint: The number of islands does not match this experiment.");
+            }
+            m_islandRandomEngineStates.clear();
+            for (uint64_t i = 0; i < islandCount; ++i)
+            {
+                m_islandRandomEngineStates.push_back(reader.readRandomEngineState());
+            }
+
+            for (std::size_t i = 0; i < m_settings.seedCount; ++i)
+            {
+                m_experiments[i]->loadCheckpoint(reader);
+                m_explorationEnvironments[i]->loadState(reader);
+                m_exploitationEnvironments[i]->loadState(reader);
+            }
+        }
+
+        virtual void writeProfile() const override
+        {
+            if (m_settings.outputProfileFilename.empty())
+            {
+                return;
+            }
+
+            const std::string filename = m_settings.outputFilenamePrefix + m_settings.outputProfileFilename;
+            if (!Profiler::writeFile(filename, Profiler::snapshot()))
+            {
+                throw std::runtime_error("Error: Cannot write file '" + filename + "'");
+            }
+        }
+
+        virtual void writeTrace() const override
+        {
+            if (m_settings.outputTraceFilename.empty())
+            {
+                return;
+            }
+
+            Tracer::stop();
+            const std::string filename = m_settings.outputFilenamePrefix + m_settings.outputTraceFilename;
+            if (!Tracer::writeFile(filename))
+            {
+                throw std::runtime_error("Error: Cannot write file '" + filename + "'");
+            }
+        }
+
+        // Write the estimated footprint of each experiment as CSV (one line per seed)
+        virtual void writeMemoryReport() const override
+        {
+            if (m_settings.outputMemoryReportFilename.empty())
+            {
+                return;
+            }
+
+            const std::string filename = m_settings.outputFilenamePrefix + m_settings.outputMemoryReportFilename;
+            std::ofstream ofs(filename);
+            ofs << "Seed,MacroClassifiers,Numerosity,ClassifierBytes,ConditionBytes,PopulationSetBytes,ActionSetBytes,MatchSetBytes,FreeNodeBytes,OtherBytes,TotalBytes,BytesPerMacroClassifier,PeakStepAllocationBytes,ProcessResidentKiB\n";
+            const uint64_t residentSetKiB = MemoryAccounting::residentSetKiB();
+            for (std::size_t i = 0; i < m_experiments.size(); ++i)
+            {
+                const MemoryUsage usage = m_experiments[i]->memoryUsage();
+                ofs << i << ','
+                    << usage.classifierCount << ','
+                    << usage.numerositySum << ','
+                    << usage.classifierBytes << ','
+                    << usage.conditionBytes << ','
+                    << usage.populationSetBytes << ','
+                    << usage.actionSetBytes << ','
+                    << usage.matchSetBytes << ','
+                    << usage.freeNodeBytes << ','
+                    << usage.otherBytes << ','
+                    << usage.totalBytes() << ','
+                    << usage.bytesPerMacroClassifier() << ',';
+                if (MemoryAccounting::kEnabled)
+                {
+                    ofs << usage.peakStepAllocationBytes;
+                }
+                ofs << ',' << residentSetKiB << '\n';
+            }
+            if (!ofs)
+            {
+                throw std::runtime_error("Error: Cannot write file '" + filename + "'");
+            }
+        }
+
+        // Write the checkpoint in the background
+        //   The state is serialized into memory here and a background thread writes it to a
+        //   temporary file, which then replaces the checkpoint file. The experiment continues
+        //   while the file is written, and the previous checkpoint is kept if interrupted.
+        virtual void writeCheckpoint() override
+        {
+            if (m_settings.outputCheckpointFilename.empty())
+            {
+                return;
+            }
+
+            waitForCheckpoint();
+            flushLogs();
+
+            std::ostringstream oss(std::ios::binary);
+            saveCheckpoint(oss);
+
+            m_checkpointThread = std::thread([this, filename = m_settings.outputFilenamePrefix + m_settings.outputCheckpointFilename, data = oss.str()] {
+                try
+                {
+                    const std::string temporaryFilename = filename + ".tmp";
+                    {
+                        std::ofstream ofs(temporaryFilename, std::ios::binary);
+                        ofs.write(data.data(), data.size());
+                        if (!ofs)
+                        {
+                            throw std::runtime_error("Error: Cannot write file '" + temporaryFilename + "'");
+                        }
+                    }
+
+                    if (std::rename(temporaryFilename.c_str(), filename.c_str()) != 0)
+                    {
+                        // Some platforms do not replace the existing file
+                        std::remove(filename.c_str());
+                        if (std::rename(temporaryFilename.c_str(), filename.c_str()) != 0)
+                        {
+                            throw std::runtime_error("Error: Cannot write file '" + filename + "'");
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    m_checkpointException = std::current_exception();
+                }
+            });
+        }
+
+        virtual void waitForCheckpoint() override
+        {
+            if (m_checkpointThread.joinable())
+            {
+                m_checkpointThread.join();
+            }
+
+            if (m_checkpointException)
+            {
+                auto exception = m_checkpointException;
+                m_checkpointException = nullptr;
+                std::rethrow_exception(exception);
+            }
         }
     };
 
@@ -2,8 +2,13 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
 #include <cstddef>
 #include "simple_moving_average.hpp"
+#include "async_log_writer.hpp"
+#include "checkpoint.hpp"
 
 namespace xxr
 {
@@ -11,54 +16,171 @@ namespace xxr
     class ExperimentLogStream
     {
     private:
+        const std::string m_filename;
         std::ofstream m_ofs;
 
     protected:
         std::ostream & m_os;
 
+        // The writer of the file output (nullptr if the output is synchronous)
+        AsyncLogWriter *m_pAsyncWriter;
+
+        // The number of the lines written so far (including the ones before a checkpoint)
+        uint64_t m_lineCount;
+
+        // Keep only the first lineCount lines of the file and continue after them
+        //   Throws std::runtime_error if the file has fewer lines.
+        void truncateLines(uint64_t lineCount)
+        {
+            flush();
+            m_lineCount = lineCount;
+            if (!m_ofs.is_open())
+            {
+                return;
+            }
+
+            m_ofs.close();
+            std::string text;
+            {
+                std::ifstream ifs(m_filename);
+                std::string line;
+                for (uint64_t i = 0; i < lineCount; ++i)
+                {
+                    if (!std::getline(ifs, line))
+                    {
+                        throw std::runtime_error("Error: The log file '" + m_filename + "' has fewer lines than the checkpoint.");
+                    }
+                    text += line;
+                    text.push_back('\n');
+                }
+            }
+            m_ofs.open(m_filename);
+            m_ofs.write(text.data(), text.size());
+            m_ofs.flush();
+        }
+
+        void output(const std::string & str, bool endsLine)
+        {
+            if (endsLine)
+            {
+                ++m_lineCount;
+            }
+            if (m_pAsyncWriter != nullptr)
+            {
+                m_pAsyncWriter->writeText(m_os, str, endsLine);
+            }
+            else if (m_os)
+            {
+                if (endsLine)
+                {
+                    m_os << str << std::endl;
+                }
+                else
+                {
+                    m_os << str << std::flush;
+                }
+            }
+        }
+
+        void output(double value, bool endsLine)
+        {
+            if (endsLine)
+            {
+                ++m_lineCount;
+            }
+            if (m_pAsyncWriter != nullptr)
+            {
+                m_pAsyncWriter->writeValue(m_os, value, endsLine);
+            }
+            else if (m_os)
+            {
+                if (endsLine)
+                {
+                    m_os << value << std::endl;
+                }
+                else
+                {
+                    m_os << value << std::flush;
+                }
+            }
+        }
+
     public:
-        explicit ExperimentLogStream(const std::string & filename = "", bool useStdoutWhenEmpty = true)
-            : m_os(
+        // Constructor
+        //   If pAsyncWriter is given, the file output is written by it in the background
+        //   (the standard output is always written synchronously). If appendsToFile is true,
+        //   the existing file is kept to continue the log of a resumed experiment (see loadState()).
+        explicit ExperimentLogStream(const std::string & filename = "", bool useStdoutWhenEmpty = true, AsyncLogWriter *pAsyncWriter = nullptr, bool appendsToFile = false)
+            : m_filename(filename)
+            , m_os(
                 filename.empty()
                     ? (useStdoutWhenEmpty ? std::cout : m_ofs)
                     : m_ofs)
+            , m_pAsyncWriter(nullptr)
+            , m_lineCount(0)
+        {
+            if (!filename.empty())
+            {
+                m_ofs.open(filename, appendsToFile ? (std::ios::out | std::ios::app) : std::ios::out);
+            }
+
+            if (m_ofs.is_open())
+            {
+                m_pAsyncWriter = pAsyncWriter;
+            }
+        }
+
+        // Destructor
+        virtual ~ExperimentLogStream()
         {
-            m_ofs.open(filename);
+            // Write the remaining values before closing the file
+            flush();
         }
 
-        virtual ~ExperimentLogStream() = default;
+        explicit operator bool() const
+        {
+            return (m_pAsyncWriter != nullptr) || static_cast<bool>(m_os);
+        }
 
         void write(const std::string & str)
         {
-            if (m_os)
-            {
-                m_os << str << std::flush;
-            }
+            output(str, false);
         }
 
         void writeLine(const std::string & str)
         {
-            if (m_os)
-            {
-                m_os << str << std::endl;
-            }
+            output(str, true);
         }
 
         virtual void write(double value)
         {
-            if (m_os)
-            {
-                m_os << value << std::flush;
-            }
+            output(value, false);
         }
 
         virtual void writeLine(double value)
         {
-            if (m_os)
+            output(value, true);
+        }
+
+        // Wait until the values are written to the file
+        void flush()
+        {
+            if (m_pAsyncWriter != nullptr)
             {
-                m_os << value << std::endl;
+                m_pAsyncWriter->flush();
             }
         }
+
+        // Save/load the state of the log (the lines after the saved ones are removed from the file on load)
+        virtual void saveState(Checkpoint::Writer & writer) const
+        {
+            writer.write<uint64_t>(m_lineCount);
+        }
+
+        virtual void loadState(Checkpoint::Reader & reader)
+        {
+            truncateLines(reader.read<uint64_t>());
+        }
     };
 
     class SMAExperimentLogStream : public ExperimentLogStream
@@ -68,33 +190,60 @@ namespace xxr
         std::size_t m_count;
 
     public:
-        explicit SMAExperimentLogStream(const std::string & filename = "", std::size_t smaWidth = 1, bool useStdoutWhenEmpty = true)
-            : ExperimentLogStream(filename, useStdoutWhenEmpty)
+        explicit SMAExperimentLogStream(const std::string & filename = "", std::size_t smaWidth = 1, bool useStdoutWhenEmpty = true, AsyncLogWriter *pAsyncWriter = nullptr, bool appendsToFile = false)
+            : ExperimentLogStream(filename, useStdoutWhenEmpty, pAsyncWriter, appendsToFile)
             , m_sma(smaWidth)
             , m_count(0)
         {
         }
 
+        // Save/load the state of the log with the window of the moving average
+        virtual void saveState(Checkpoint::Writer & writer) const override
+        {
+            ExperimentLogStream::saveState(writer);
+            writer.write<uint64_t>(m_sma.order());
+            writer.writeVector(m_sma.samples());
+            writer.write<uint64_t>(m_sma.cursor());
+            writer.write<uint64_t>(m_count);
+        }
+
+        virtual void loadState(Checkpoint::Reader & reader) override
+        {
+            ExperimentLogStream::loadState(reader);
+            if (reader.read<uint64_t>() != m_sma.order())
+            {
+                throw std::runtime_error("Checkpoint: The width of the moving average (--sma) does not match this experiment.");
+            }
+            const std::vector<double> samples = reader.readVector<double>();
+            const uint64_t cursor = reader.read<uint64_t>();
+            if (samples.size() > m_sma.order() || cursor >= m_sma.order())
+            {
+                throw std::runtime_error("Checkpoint: Invalid state of the moving average.");
+            }
+            m_sma.restore(samples, cursor);
+            m_count = reader.read<uint64_t>();
+        }
+
         virtual void write(double value) override
         {
-            if (m_os)
+            if (*this)
             {
                 double smaValue = m_sma(value);
                 if (++m_count >= m_sma.order())
                 {
-                    m_os << smaValue << std::flush;
+                    output(smaValue, false);
                 }
             }
         }
 
         virtual void writeLine(double value) override
         {
-            if (m_os)
+            if (*this)
             {
                 double smaValue = m_sma(value);
                 if (++m_count >= m_sma.order())
                 {
-                    m_os << smaValue << std::endl;
+                    output(smaValue, true);
                 }
             }
         }
@@ -27,6 +27,9 @@ struct ExperimentSettings
     // The filename of summary log csv output
     std::string outputSummaryFilename = "summary.csv";
 
+    // Whether to append the event counters of the experiments (see ExperimentStats) to the summary log csv
+    bool outputStatsInSummary = false;
+
     // The filename of reward log csv output
     std::string outputRewardFilename = "";
 
@@ -42,11 +45,45 @@ struct ExperimentSettings
     // The classifier csv filename for initial population
     std::string inputClassifierFilename;
 
-    // Whether to use initial classifiers (--cinput) to resume previous experiment
+    // The classifier binary snapshot filename for initial population (see PopulationSnapshot)
+    std::string inputClassifierBinaryFilename;
+
+    // Whether to use initial classifiers (--cinput/--cinput-bin) to resume previous experiment
     //   "false": initialize p/epsilon/F/exp/ts/as to defaults
     //   "true": do not initialize values and set system time stamp to the same as that of the latest classifier
     bool useInputClassifierToResume = true;
 
+    // The checkpoint filename to resume the experiment from (see Checkpoint)
+    std::string inputCheckpointFilename;
+
+    // The filename of checkpoint output
+    std::string outputCheckpointFilename;
+
+    // The iteration interval of checkpoint output (set "0" to output only by saveCheckpoint())
+    std::size_t checkpointInterval = 0;
+
+    // The filename of the phase profile output at exit (".json": JSON, otherwise CSV; requires XXR_ENABLE_PROFILER, see Profiler)
+    std::string outputProfileFilename;
+
+    // The filename of the timeline trace output at exit (Chrome trace JSON; requires XXR_ENABLE_PROFILER, see Tracer)
+    std::string outputTraceFilename;
+
+    // The iterations recorded in the timeline trace (from traceFromIteration to traceToIteration - 1, counted from 0)
+    std::size_t traceFromIteration = 0;
+    std::size_t traceToIteration = 1000;
+
+    // The filename of the memory report csv output at exit (the estimated footprint of each experiment, see MemoryUsage)
+    std::string outputMemoryReportFilename;
+
+    // The filename of population journal output (the changes of the population of the first experiment, see PopulationJournal)
+    std::string outputJournalFilename;
+
     // The width of the simple moving average for the reward log
     std::size_t smaWidth = 1;
+
+    // The iteration interval of the classifier migration between islands (used only in the island model)
+    std::size_t migrationInterval = 1000;
+
+    // The number of the fittest classifiers migrated to the next island at once (used only in the island model)
+    std::size_t migrationCount = 10;
 };
@@ -0,0 +1,470 @@
+#pragma once
+#include <string>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <random>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include "experiment_helper.hpp"
+#include "spsc_queue.hpp"
+
+namespace xxr
+{
+
+    // Persistent threads of the islands (thread i runs the tasks of island i)
+    //   Each thread keeps its random engine (see Random::engine()) for the whole run, so the
+    //   island uses the same engine in every chunk of iterations, and the thread registers
+    //   its profile and trace buffers only once.
+    class IslandThreadPool
+    {
+    private:
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::function<void(std::size_t)> m_task;
+        uint64_t m_taskGeneration;
+        std::size_t m_runningThreadCount;
+        bool m_isStopping;
+        std::vector<std::exception_ptr> m_exceptions;
+
+        void run(std::size_t islandIdx, const std::string & randomEngineState)
+        {
+            Random::setEngineState(randomEngineState);
+
+            uint64_t taskGeneration = 0;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (true)
+            {
+                m_condition.wait(lock, [&]{ return m_isStopping || m_taskGeneration != taskGeneration; });
+                if (m_isStopping)
+                {
+                    break;
+                }
+                taskGeneration = m_taskGeneration;
+                lock.unlock();
+
+                try
+                {
+                    m_task(islandIdx);
+                }
+                catch (...)
+                {
+                    m_exceptions[islandIdx] = std::current_exception();
+                }
+
+                lock.lock();
+                if (--m_runningThreadCount == 0)
+                {
+                    m_condition.notify_all();
+                }
+            }
+        }
+
+    public:
+        // Constructor
+        //   The random engine of thread i starts from randomEngineStates[i] (see Random::engineState()).
+        explicit IslandThreadPool(const std::vector<std::string> & randomEngineStates)
+            : m_taskGeneration(0)
+            , m_runningThreadCount(0)
+            , m_isStopping(false)
+            , m_exceptions(randomEngineStates.size())
+        {
+            for (std::size_t i = 0; i < randomEngineStates.size(); ++i)
+            {
+                m_threads.emplace_back(&IslandThreadPool::run, this, i, randomEngineStates[i]);
+            }
+        }
+
+        IslandThreadPool(const IslandThreadPool &) = delete;
+        IslandThreadPool & operator=(const IslandThreadPool &) = delete;
+
+        // Destructor
+        ~IslandThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_isStopping = true;
+            }
+            m_condition.notify_all();
+            for (auto && thread : m_threads)
+            {
+                thread.join();
+            }
+        }
+
+        // Run task(islandIdx) in the thread of every island and wait for all of them
+        //   An exception thrown by the task is rethrown after all the threads finish.
+        void runOnIslands(std::function<void(std::size_t)> task)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_task = std::move(task);
+                std::fill(m_exceptions.begin(), m_exceptions.end(), nullptr);
+                m_runningThreadCount = m_threads.size();
+                ++m_taskGeneration;
+                m_condition.notify_all();
+                m_condition.wait(lock, [this]{ return m_runningThreadCount == 0; });
+            }
+
+            for (auto && exception : m_exceptions)
+            {
+                if (exception)
+                {
+                    std::rethrow_exception(exception);
+                }
+            }
+        }
+    };
+
+    // Experiment helper for the island model
+    //
+    //   Each experiment (= island, seedCount is used as the number of islands) has its own
+    //   population and random engine, and is trained in its own thread (see IslandThreadPool).
+    //   Every migrationInterval iterations, the islands stop, each island sends copies of its
+    //   migrationCount fittest classifiers to the next island (ring topology) through a
+    //   lock-free queue, and then inserts the classifiers received from the previous island
+    //   into its population. Since the islands meet at the migrations, a run depends only on
+    //   the random engines, which are seeded from the engine of the main thread and saved in
+    //   the checkpoints.
+    //
+    //   The logs are the average over the islands, in the same way as the average over seeds.
+    //   Call mergeIslands() after the iterations to merge all populations into the first island.
+    template <class Experiment, class Environment>
+    class IslandExperimentHelper : public ExperimentHelper<Experiment, Environment>
+    {
+    protected:
+        using ExperimentHelper<Experiment, Environment>::m_settings;
+        using ExperimentHelper<Experiment, Environment>::m_experiments;
+        using ExperimentHelper<Experiment, Environment>::m_explorationEnvironments;
+        using ExperimentHelper<Experiment, Environment>::m_exploitationEnvironments;
+        using ExperimentHelper<Experiment, Environment>::m_explorationCallback;
+        using ExperimentHelper<Experiment, Environment>::m_exploitationCallback;
+        using ExperimentHelper<Experiment, Environment>::m_summaryRewardSum;
+        using ExperimentHelper<Experiment, Environment>::m_summarySystemErrorSum;
+        using ExperimentHelper<Experiment, Environment>::m_summaryPopulationSizeSum;
+        using ExperimentHelper<Experiment, Environment>::m_summaryCoveringOccurrenceRateSum;
+        using ExperimentHelper<Experiment, Environment>::m_summaryStepCountSum;
+        using ExperimentHelper<Experiment, Environment>::m_iterationCount;
+
+        // The exploitation result of an island in an iteration
+        struct IterationLog
+        {
+            std::size_t stepCount;
+            double rewardSum;
+            double systemErrorSum;
+            double coveringOccurrenceSum;
+            double populationSizeSum;
+            double populationSize;
+        };
+
+        // The maximum number of iterations run in the island threads at once when summaryInterval is 0
+        static constexpr std::size_t kMaxChunkIterationCount = 10000;
+
+        // The capacity of the migration queue (in the number of migrations)
+        static constexpr std::size_t kMigrationQueueCapacity = 16;
+
+        // The threads of the islands (declared after the members used by the tasks)
+        std::unique_ptr<IslandThreadPool> m_threadPool;
+
+        // Migration queues (m_migrationQueues[i] receives the migrants of island i - 1)
+        //   The migrants are held as std::vector<ClassifierType> of the experiment, which differs by the representation in XCSR.
+        std::vector<std::unique_ptr<SPSCQueue<std::shared_ptr<void>>>> m_migrationQueues;
+
+        // Exploitation results of the current chunk (m_iterationLogs[islandIdx][iteration])
+        std::vector<std::vector<IterationLog>> m_iterationLogs;
+
+        // Mutex for the callbacks (the callbacks are not assumed to be thread-safe)
+        std::mutex m_callbackMutex;
+
+        virtual void runIslandExploitation(std::size_t islandIdx, IterationLog & log)
+        {
+            log = IterationLog{ 0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+            if (m_settings.exploitationCount > 0)
+            {
+                for (std::size_t k = 0; k < m_settings.exploitationCount; ++k)
+                {
+                    do
+                    {
+                        // Choose action
+                        auto action = this->callExperimentExploit(islandIdx);
+
+                        // Get reward
+                        double reward = m_exploitationEnvironments[islandIdx]->executeAction(action);
+                        if (m_settings.updateInExploitation)
+                        {
+                            m_experiments[islandIdx]->reward(reward, m_exploitationEnvironments[islandIdx]->isEndOfProblem());
+                        }
+                        log.rewardSum += reward;
+                        log.systemErrorSum += std::abs(reward - m_experiments[islandIdx]->prediction());
+                        log.coveringOccurrenceSum += static_cast<double>(m_experiments[islandIdx]->isCoveringPerformed());
+                        ++log.stepCount;
+
+                        // Run callback if needed
+                        {
+                            std::lock_guard<std::mutex> lock(m_callbackMutex);
+                            m_exploitationCallback(*m_exploitationEnvironments[islandIdx]);
+                        }
+                    } while (!m_exploitationEnvironments[islandIdx]->isEndOfProblem());
+
+                    log.populationSizeSum += m_experiments[islandIdx]->populationSize();
+                }
+                log.populationSize = static_cast<double>(m_experiments[islandIdx]->populationSize());
+            }
+        }
+
+        virtual void runIslandExploration(std::size_t islandIdx)
+        {
+            for (std::size_t k = 0; k < m_settings.explorationCount; ++k)
+            {
+                do
+                {
+                    // Get situation from environment and choose action
+                    auto action = this->callExperimentExplore(islandIdx);
+
+                    // Get reward
+                    double reward = m_explorationEnvironments[islandIdx]->executeAction(action);
+                    m_experiments[islandIdx]->reward(reward, m_explorationEnvironments[islandIdx]->isEndOfProblem());
+
+                    // Run callback if needed
+                    {
+                        std::lock_guard<std::mutex> lock(m_callbackMutex);
+                        m_explorationCallback(*m_explorationEnvironments[islandIdx]);
+                    }
+                } while (!m_explorationEnvironments[islandIdx]->isEndOfProblem());
+            }
+        }
+
+        // SEND MIGRANTS (send the fittest classifiers to the next island, called in the island thread)
+        virtual void sendMigrants(std::size_t islandIdx)
+        {
+            auto & sendQueue = *m_migrationQueues[(islandIdx + 1) % m_migrationQueues.size()];
+            const std::size_t migrationCount = m_settings.migrationCount;
+
+            m_experiments[islandIdx]->visit([&](auto & experiment) {
+                using ClassifierType = typename std::decay_t<decltype(experiment)>::ClassifierType;
+
+                auto migrants = std::make_shared<std::vector<ClassifierType>>(experiment.fittestClassifiers(migrationCount));
+                for (auto && cl : *migrants)
+                {
+                    cl.numerosity = 1;
+                }
+                sendQueue.push(std::move(migrants));
+            });
+        }
+
+        // RECEIVE MIGRANTS (insert the classifiers from the previous island, called in the island thread)
+        virtual void receiveMigrants(std::size_t islandIdx)
+        {
+            auto & receiveQueue = *m_migrationQueues[islandIdx];
+
+            m_experiments[islandIdx]->visit([&](auto & experiment) {
+                using ClassifierType = typename std::decay_t<decltype(experiment)>::ClassifierType;
+
+                std::shared_ptr<void> received;
+                while (receiveQueue.pop(received))
+                {
+                    experiment.insertClassifiers(*std::static_pointer_cast<std::vector<ClassifierType>>(received));
+                }
+            });
+        }
+
+        // Run iterations of an island (called in the island thread)
+        virtual void runIslandIterations(std::size_t islandIdx, std::size_t repeat)
+        {
+            for (std::size_t i = 0; i < repeat; ++i)
+            {
+                runIslandExploitation(islandIdx, m_iterationLogs[islandIdx][i]);
+                runIslandExploration(islandIdx);
+            }
+        }
+
+        virtual std::vector<std::string> islandRandomEngineStates() const override
+        {
+            std::vector<std::string> states(m_settings.seedCount);
+            m_threadPool->runOnIslands([&](std::size_t islandIdx) {
+                states[islandIdx] = Random::engineState();
+            });
+            return states;
+        }
+
+        // Sum up the exploitation results of the islands and output the logs (called in the main thread)
+        virtual void outputChunkLog(std::size_t repeat)
+        {
+            for (std::size_t i = 0; i < repeat; ++i)
+            {
+                if (m_settings.exploitationCount > 0)
+                {
+                    std::size_t totalStepCount = 0;
+                    double rewardSum = 0.0;
+                    double systemErrorSum = 0.0;
+                    double populationSizeSum = 0.0;
+                    for (std::size_t j = 0; j < m_settings.seedCount; ++j)
+                    {
+                        const auto & log = m_iterationLogs[j][i];
+                        m_summaryRewardSum += log.rewardSum / m_settings.exploitationCount / m_settings.seedCount;
+                        m_summarySystemErrorSum += log.systemErrorSum / m_settings.exploitationCount / m_settings.seedCount;
+                        m_summaryCoveringOccurrenceRateSum += log.coveringOccurrenceSum / m_settings.exploitationCount / m_settings.seedCount;
+                        m_summaryPopulationSizeSum += log.populationSize / m_settings.seedCount;
+                        totalStepCount += log.stepCount;
+                        rewardSum += log.rewardSum;
+                        systemErrorSum += log.systemErrorSum;
+                        populationSizeSum += log.populationSizeSum;
+                    }
+
+                    m_summaryStepCountSum += static_cast<double>(totalStepCount) / m_settings.exploitationCount / m_settings.seedCount;
+
+                    this->outputIterationLog(totalStepCount, rewardSum, systemErrorSum, populationSizeSum);
+                }
+                ++m_iterationCount;
+            }
+        }
+
+    public:
+        template <class... Args>
+        IslandExperimentHelper(
+            const ExperimentSettings & settings,
+            const typename Experiment::ConstantsType & constants,
+            std::vector<std::unique_ptr<Environment>> && explorationEnvironments,
+            std::vector<std::unique_ptr<Environment>> && exploitationEnvironments,
+            std::function<void(Environment &)> explorationCallback = [](Environment &){},
+            std::function<void(Environment &)> exploitationCallback = [](Environment &){},
+            Args && ... args
+        )
+            : ExperimentHelper<Experiment, Environment>(
+                settings,
+                constants,
+                std::move(explorationEnvironments),
+                std::move(exploitationEnvironments),
+                std::move(explorationCallback),
+                std::move(exploitationCallback),
+                std::forward<Args>(args)...)
+            , m_iterationLogs(settings.seedCount)
+        {
+            for (std::size_t i = 0; i < settings.seedCount; ++i)
+            {
+                m_migrationQueues.push_back(std::make_unique<SPSCQueue<std::shared_ptr<void>>>(kMigrationQueueCapacity));
+            }
+
+            // The random engines of the islands (seeded from the engine of the main thread unless restored from the checkpoint)
+            std::vector<std::string> randomEngineStates = this->m_islandRandomEngineStates;
+            if (!settings.inputCheckpointFilename.empty() && randomEngineStates.size() != settings.seedCount)
+            {
+                throw std::runtime_error("Checkpoint: The checkpoint was not written by the island model.");
+            }
+            if (randomEngineStates.empty())
+            {
+                for (std::size_t i = 0; i < settings.seedCount; ++i)
+                {
+                    std::ostringstream oss;
+                    oss << std::mt19937(Random::engine()());
+                    randomEngineStates.push_back(oss.str());
+                }
+            }
+            m_threadPool = std::make_unique<IslandThreadPool>(randomEngineStates);
+        }
+
+        // Destructor (the threads are stopped before the members are destroyed)
+        virtual ~IslandExperimentHelper()
+        {
+            m_threadPool.reset();
+        }
+
+        virtual void runIteration(std::size_t repeat = 1) override
+        {
+            while (repeat > 0)
+            {
+                // Run the islands until the next summary output
+                std::size_t chunkSize;
+                if (m_settings.summaryInterval > 0)
+                {
+                    chunkSize = m_settings.summaryInterval - m_iterationCount % m_settings.summaryInterval;
+                }
+                else
+                {
+                    chunkSize = kMaxChunkIterationCount;
+                }
+                if (m_settings.checkpointInterval > 0 && !m_settings.outputCheckpointFilename.empty())
+                {
+                    chunkSize = std::min(chunkSize, m_settings.checkpointInterval - m_iterationCount % m_settings.checkpointInterval);
+                }
+                if (m_settings.migrationInterval > 0)
+                {
+                    chunkSize = std::min(chunkSize, m_settings.migrationInterval - m_iterationCount % m_settings.migrationInterval);
+                }
+                if (!m_settings.outputTraceFilename.empty())
+                {
+                    // Stop at the boundaries of the trace window
+                    for (std::size_t boundary : { m_settings.traceFromIteration, m_settings.traceToIteration })
+                    {
+                        if (boundary > m_iterationCount)
+                        {
+                            chunkSize = std::min(chunkSize, boundary - m_iterationCount);
+                        }
+                    }
+                }
+                chunkSize = std::min(chunkSize, repeat);
+
+                for (auto && logs : m_iterationLogs)
+                {
+                    logs.resize(chunkSize);
+                }
+
+                this->updateTracer();
+
+                m_threadPool->runOnIslands([this, chunkSize](std::size_t islandIdx) {
+                    runIslandIterations(islandIdx, chunkSize);
+                });
+
+                outputChunkLog(chunkSize);
+
+                // MIGRATE (all islands send before any island receives)
+                if (m_settings.migrationInterval > 0 && m_iterationCount % m_settings.migrationInterval == 0)
+                {
+                    m_threadPool->runOnIslands([this](std::size_t islandIdx) {
+                        sendMigrants(islandIdx);
+                    });
+                    m_threadPool->runOnIslands([this](std::size_t islandIdx) {
+                        receiveMigrants(islandIdx);
+                    });
+                }
+                this->flushJournal();
+
+                if (this->isCheckpointDue())
+                {
+                    this->writeCheckpoint();
+                }
+
+                repeat -= chunkSize;
+            }
+        }
+
+        // MERGE ISLANDS (merge the populations of all islands into the first island)
+        virtual void mergeIslands() override
+        {
+            for (std::size_t j = 1; j < m_settings.seedCount; ++j)
+            {
+                std::shared_ptr<void> classifiers;
+                m_experiments[j]->visit([&](auto & experiment) {
+                    using ClassifierType = typename std::decay_t<decltype(experiment)>::ClassifierType;
+                    classifiers = std::make_shared<std::vector<ClassifierType>>(experiment.fittestClassifiers(experiment.populationSize()));
+                });
+                m_experiments[0]->visit([&](auto & experiment) {
+                    using ClassifierType = typename std::decay_t<decltype(experiment)>::ClassifierType;
+                    experiment.insertClassifiers(*std::static_pointer_cast<std::vector<ClassifierType>>(classifiers), true);
+                });
+            }
+        }
+    };
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <iterator>
+#include <vector>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace xxr
+{
+
+    // Read-only memory-mapped file
+    //   (On Windows, the file is read into a buffer instead.)
+    class MappedFile
+    {
+    protected:
+        const char *m_data;
+        std::size_t m_size;
+#if defined(_WIN32)
+        std::vector<char> m_buffer;
+#endif
+
+    public:
+        // Constructor
+        //   Throws std::runtime_error if the file cannot be opened or mapped.
+        explicit MappedFile(const std::string & filename) : m_data(nullptr), m_size(0)
+        {
+#if defined(_WIN32)
+            std::ifstream ifs(filename, std::ios::binary);
+            if (!ifs)
+            {
+                throw std::runtime_error("Error: Cannot open file '" + filename + "'");
+            }
+            m_buffer.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+            m_data = m_buffer.data();
+            m_size = m_buffer.size();
+#else
+            const int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw std::runtime_error("Error: Cannot open file '" + filename + "'");
+            }
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                ::close(fd);
+                throw std::runtime_error("Error: Cannot read file '" + filename + "'");
+            }
+
+            // Zero-length files cannot be mapped
+            if (st.st_size > 0)
+            {
+                void *p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED)
+                {
+                    ::close(fd);
+                    throw std::runtime_error("Error: Cannot map file '" + filename + "'");
+                }
+                m_data = static_cast<const char *>(p);
+                m_size = static_cast<std::size_t>(st.st_size);
+            }
+            ::close(fd);
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile & operator=(const MappedFile &) = delete;
+
+        // Destructor
+        ~MappedFile()
+        {
+#if !defined(_WIN32)
+            if (m_data != nullptr)
+            {
+                ::munmap(const_cast<char *>(m_data), m_size);
+            }
+#endif
+        }
+
+        const char *data() const noexcept
+        {
+            return m_data;
+        }
+
+        std::size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        // Whether count elements of elementSize bytes at the offset end at or before the limit
+        //   (checked by division, so the crafted headers of a broken file cannot overflow it)
+        static bool fits(uint64_t offset, uint64_t elementSize, uint64_t count, uint64_t limit) noexcept
+        {
+            return offset <= limit && (count == 0 || elementSize <= (limit - offset) / count);
+        }
+    };
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "text_format.hpp"
+
+namespace xxr { namespace PopulationCSV
+{
+
+    // Buffered writer of the population CSV (the output of dumpPopulation())
+    //   The rows are formatted straight into string buffers with TextFormat instead of
+    //   std::ostream, and the population can be split into chunks formatted in parallel.
+    //   With the default format, the text is identical to the former stream output.
+
+    struct Format
+    {
+        // The number of significant digits of the values
+        //   (0: the default (6 digits, 3 digits for the XCSR conditions),
+        //    TextFormat::kRoundTripPrecision: the digits that restore the same values)
+        int precision = 0;
+
+        // The number of threads formatting the rows (0: the number of hardware threads)
+        std::size_t threadCount = 1;
+    };
+
+    // The number of classifiers formatted by a thread at once
+    constexpr std::size_t kChunkClassifierCount = 8192;
+
+    // Append "Condition,Action,prediction,epsilon,F,exp,ts,as,n,acc" of the classifier as a line
+    template <class StoredClassifier>
+    void appendClassifier(std::string & str, const StoredClassifier & cl, int precision)
+    {
+        const int valuePrecision = (precision == 0) ? TextFormat::kDefaultPrecision : precision;
+
+        cl.condition.appendTo(str, precision);
+        str.push_back(',');
+        TextFormat::appendValue(str, cl.action);
+        str.push_back(',');
+        TextFormat::appendValue(str, cl.prediction, valuePrecision);
+        str.push_back(',');
+        TextFormat::appendValue(str, cl.epsilon, valuePrecision);
+        str.push_back(',');
+        TextFormat::appendValue(str, cl.fitness, valuePrecision);
+        str.push_back(',');
+        TextFormat::appendValue(str, cl.experience);
+        str.push_back(',');
+        TextFormat::appendValue(str, cl.timeStamp);
+        str.push_back(',');
+        TextFormat::appendValue(str, cl.actionSetSize, valuePrecision);
+        str.push_back(',');
+        TextFormat::appendValue(str, cl.numerosity);
+        str.push_back(',');
+        TextFormat::appendValue(str, cl.accuracy(), valuePrecision);
+        str.push_back('\n');
+    }
+
+    // Append the graph of the intervals of the XCSR condition (e.g. "|.oOOo.....|...|,")
+    template <class Condition, typename T>
+    void appendIntervalGraph(std::string & str, const Condition & condition, T minValue, T maxValue)
+    {
+        for (auto && symbol : condition)
+        {
+            str.push_back('|');
+
+            auto normalizedLowerLimit = (symbol.lower() - minValue) / (maxValue - minValue);
+            auto normalizedUpperLimit = (symbol.upper() - minValue) / (maxValue - minValue);
+
+            for (int i = 0; i < 10; ++i)
+            {
+                if (normalizedLowerLimit < i / 10.0 && (i + 1) / 10.0 < normalizedUpperLimit)
+                {
+                    str.push_back('O');
+                }
+                else if ((i / 10.0 <= normalizedLowerLimit && normalizedLowerLimit <= (i + 1) / 10.0)
+                    || (i / 10.0 <= normalizedUpperLimit && normalizedUpperLimit <= (i + 1) / 10.0))
+                {
+                    str.push_back('o');
+                }
+                else
+                {
+                    str.push_back('.');
+                }
+            }
+        }
+        str += "|,";
+    }
+
+    // Write the rows of the classifiers in the order of the population
+    //   appendRow(std::string &, const StoredClassifier &) appends the line of a classifier.
+    //   The chunks of kChunkClassifierCount classifiers are formatted by threadCount threads
+    //   (see TextFormat::writeChunks(), it must be safe to call appendRow concurrently).
+    template <class ClassifierPtrSet, class AppendRow>
+    void writeRows(std::ostream & os, const ClassifierPtrSet & population, std::size_t threadCount, AppendRow && appendRow)
+    {
+        using Iterator = decltype(population.begin());
+
+        // The first classifiers of the chunks (and the end)
+        std::vector<Iterator> chunkBegins;
+        {
+            std::size_t i = 0;
+            for (auto it = population.begin(); it != population.end(); ++it, ++i)
+            {
+                if (i % kChunkClassifierCount == 0)
+                {
+                    chunkBegins.push_back(it);
+                }
+            }
+            chunkBegins.push_back(population.end());
+        }
+        const std::size_t chunkCount = chunkBegins.size() - 1;
+
+        TextFormat::writeChunks(os, chunkCount, threadCount, [&](std::string & str, std::size_t chunkIdx) {
+            for (auto it = chunkBegins[chunkIdx]; it != chunkBegins[chunkIdx + 1]; ++it)
+            {
+                appendRow(str, **it);
+            }
+        });
+    }
+
+}}
@@ -0,0 +1,584 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <type_traits>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace xxr
+{
+
+    // Append-only binary journal of the changes of a population [P]
+    //
+    //   Layout (native byte order):
+    //     Header  : magic, version, byte order mark, symbol kind and size
+    //     Records : RecordHeader (kind, payload size) followed by the payload
+    //
+    //   The classifiers are referred to by their IDs (see StoredClassifier::id). The first
+    //   record is BASE, which lists the IDs of the classifiers in [P] when the journal was
+    //   started. Its IDs correspond to the records of a population snapshot written at that
+    //   time (the snapshot and [P] are ordered by ID), so the journal can be replayed onto
+    //   the snapshot (see PopulationJournal::Replayer).
+    //
+    //   Every record is written at once, so a reader tailing the file sees either a complete
+    //   record or a truncated one at the end, which it can retry later.
+    namespace PopulationJournal
+    {
+        constexpr char kMagic[8] = { 'X', 'X', 'R', 'J', 'R', 'N', 'L', '\0' };
+
+        constexpr uint32_t kVersion = 1;
+
+        // Written as is to detect the byte order mismatch
+        constexpr uint32_t kByteOrderMark = 0x01020304;
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrderMark;
+            uint32_t symbolKind; // Symbol::binaryKind()
+            uint32_t reserved;
+            uint64_t symbolSize; // Symbol::binarySize()
+        };
+
+        enum class RecordKind : uint32_t
+        {
+            BASE = 1,        // timeStamp, count, IDs[count]
+            INSERTION,       // InsertionRecord, encoded symbols[conditionLength]
+            NUMEROSITY,      // ID, numerosity
+            DELETION,        // ID
+            SUBSUMPTION,     // subsumer ID, numerosity of subsumer, count, subsumed IDs[count]
+            UPDATE,          // count, UpdateEntry[count] (the parameters of an action set)
+            TIME_STAMP,      // timeStamp, count, IDs[count] (the GA time stamps of an action set)
+            CLEAR,           // (no payload)
+        };
+
+        struct RecordHeader
+        {
+            uint32_t kind;
+            uint32_t size; // the size of the payload
+        };
+
+        struct InsertionRecord
+        {
+            uint64_t id;
+            int64_t action;
+            double prediction;
+            double epsilon;
+            double fitness;
+            double actionSetSize;
+            uint64_t experience;
+            uint64_t timeStamp;
+            uint64_t numerosity;
+            uint64_t conditionLength;
+        };
+
+        struct UpdateEntry
+        {
+            uint64_t id;
+            double prediction;
+            double epsilon;
+            double fitness;
+            double actionSetSize;
+            uint64_t experience;
+        };
+
+        class Writer
+        {
+        private:
+            std::ostream & m_os;
+
+            // The record being built (reused to avoid allocation in every record)
+            std::vector<unsigned char> m_record;
+
+            uint64_t m_recordCount;
+
+            void beginRecord(RecordKind kind)
+            {
+                m_record.resize(sizeof(RecordHeader));
+                RecordHeader recordHeader = { static_cast<uint32_t>(kind), 0 };
+                std::memcpy(m_record.data(), &recordHeader, sizeof(recordHeader));
+            }
+
+            template <typename T>
+            void put(const T & value)
+            {
+                static_assert(std::is_trivially_copyable<T>::value, "PopulationJournal::Writer::put() requires a trivially copyable type");
+                const std::size_t offset = m_record.size();
+                m_record.resize(offset + sizeof(T));
+                std::memcpy(m_record.data() + offset, &value, sizeof(T));
+            }
+
+            void endRecord()
+            {
+                const uint32_t size = static_cast<uint32_t>(m_record.size() - sizeof(RecordHeader));
+                std::memcpy(m_record.data() + offsetof(RecordHeader, size), &size, sizeof(size));
+                m_os.write(reinterpret_cast<const char *>(m_record.data()), m_record.size());
+                ++m_recordCount;
+            }
+
+        public:
+            // Constructor (writes the header)
+            Writer(std::ostream & os, uint32_t symbolKind, uint64_t symbolSize)
+                : m_os(os)
+                , m_recordCount(0)
+            {
+                Header header;
+                std::memset(&header, 0, sizeof(header));
+                std::memcpy(header.magic, kMagic, sizeof(kMagic));
+                header.version = kVersion;
+                header.byteOrderMark = kByteOrderMark;
+                header.symbolKind = symbolKind;
+                header.symbolSize = symbolSize;
+                m_os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            }
+
+            Writer(const Writer &) = delete;
+            Writer & operator=(const Writer &) = delete;
+
+            // Destructor
+            ~Writer() = default;
+
+            template <class ClassifierPtrSet>
+            void writeBase(const ClassifierPtrSet & population, uint64_t timeStamp)
+            {
+                beginRecord(RecordKind::BASE);
+                put<uint64_t>(timeStamp);
+                put<uint64_t>(population.size());
+                for (auto && cl : population)
+                {
+                    put<uint64_t>(cl->id);
+                }
+                endRecord();
+            }
+
+            template <class StoredClassifier>
+            void writeInsertion(const StoredClassifier & cl)
+            {
+                using SymbolType = typename StoredClassifier::SymbolType;
+
+                InsertionRecord record;
+                record.id = cl.id;
+                record.action = static_cast<int64_t>(cl.action);
+                record.prediction = cl.prediction;
+                record.epsilon = cl.epsilon;
+                record.fitness = cl.fitness;
+                record.actionSetSize = cl.actionSetSize;
+                record.experience = cl.experience;
+                record.timeStamp = cl.timeStamp;
+                record.numerosity = cl.numerosity;
+                record.conditionLength = cl.condition.size();
+
+                beginRecord(RecordKind::INSERTION);
+                put(record);
+                const std::size_t offset = m_record.size();
+                m_record.resize(offset + SymbolType::binarySize() * cl.condition.size());
+                unsigned char *p = m_record.data() + offset;
+                for (auto && symbol : cl.condition)
+                {
+                    symbol.writeBinary(p);
+                    p += SymbolType::binarySize();
+                }
+                endRecord();
+            }
+
+            void writeNumerosity(uint64_t id, uint64_t numerosity)
+            {
+                beginRecord(RecordKind::NUMEROSITY);
+                put<uint64_t>(id);
+                put<uint64_t>(numerosity);
+                endRecord();
+            }
+
+            void writeDeletion(uint64_t id)
+            {
+                beginRecord(RecordKind::DELETION);
+                put<uint64_t>(id);
+                endRecord();
+            }
+
+            void writeSubsumption(uint64_t subsumerId, uint64_t numerosity, const std::vector<uint64_t> & subsumedIds)
+            {
+                beginRecord(RecordKind::SUBSUMPTION);
+                put<uint64_t>(subsumerId);
+                put<uint64_t>(numerosity);
+                put<uint64_t>(subsumedIds.size());
+                for (uint64_t id : subsumedIds)
+                {
+                    put<uint64_t>(id);
+                }
+                endRecord();
+            }
+
+            // Write the parameters of the classifiers in the action set that are in [P]
+            template <class ClassifierPtrSet, class Population>
+            void writeUpdate(const ClassifierPtrSet & actionSet, const Population & population)
+            {
+                beginRecord(RecordKind::UPDATE);
+                const std::size_t countOffset = m_record.size();
+                put<uint64_t>(0);
+                uint64_t count = 0;
+                for (auto && cl : actionSet)
+                {
+                    if (population.count(cl))
+                    {
+                        put(UpdateEntry{ cl->id, cl->prediction, cl->epsilon, cl->fitness, cl->actionSetSize, cl->experience });
+                        ++count;
+                    }
+                }
+                std::memcpy(m_record.data() + countOffset, &count, sizeof(count));
+                endRecord();
+            }
+
+            // Write the time stamps set to the classifiers in the action set that are in [P]
+            template <class ClassifierPtrSet, class Population>
+            void writeTimeStamp(const ClassifierPtrSet & actionSet, const Population & population, uint64_t timeStamp)
+            {
+                beginRecord(RecordKind::TIME_STAMP);
+                put<uint64_t>(timeStamp);
+                const std::size_t countOffset = m_record.size();
+                put<uint64_t>(0);
+                uint64_t count = 0;
+                for (auto && cl : actionSet)
+                {
+                    if (population.count(cl))
+                    {
+                        put<uint64_t>(cl->id);
+                        ++count;
+                    }
+                }
+                std::memcpy(m_record.data() + countOffset, &count, sizeof(count));
+                endRecord();
+            }
+
+            void writeClear()
+            {
+                beginRecord(RecordKind::CLEAR);
+                endRecord();
+            }
+
+            void flush()
+            {
+                m_os.flush();
+            }
+
+            uint64_t recordCount() const noexcept
+            {
+                return m_recordCount;
+            }
+        };
+
+        // Replayer of a journal onto a base population
+        //   The base classifiers must be in the order of [P] when the journal was started
+        //   (e.g. PopulationSnapshot::View::classifiers() of the snapshot written at that time).
+        //   replay() can be called repeatedly on a growing file to follow the journal.
+        template <class Classifier>
+        class Replayer
+        {
+        public:
+            using SymbolType = typename Classifier::SymbolType;
+            using ConditionType = typename Classifier::ConditionType;
+            using ActionType = typename Classifier::ActionType;
+
+        protected:
+            std::vector<Classifier> m_baseClassifiers;
+
+            // The classifiers by ID (the order of [P])
+            std::map<uint64_t, Classifier> m_classifiers;
+
+            bool m_isHeaderRead;
+            bool m_isBaseApplied;
+            uint64_t m_timeStamp;
+            uint64_t m_recordCount;
+
+            // Cursor over the payload of a record
+            class PayloadReader
+            {
+            private:
+                const unsigned char *m_p;
+                const unsigned char * const m_end;
+
+            public:
+                explicit PayloadReader(const std::vector<unsigned char> & payload)
+                    : m_p(payload.data())
+                    , m_end(payload.data() + payload.size())
+                {
+                }
+
+                const unsigned char *skip(std::size_t size)
+                {
+                    if (static_cast<std::size_t>(m_end - m_p) < size)
+                    {
+                        throw std::runtime_error("PopulationJournal::Replayer: The journal is broken.");
+                    }
+                    const unsigned char *p = m_p;
+                    m_p += size;
+                    return p;
+                }
+
+                template <typename T>
+                T read()
+                {
+                    T value;
+                    std::memcpy(&value, skip(sizeof(T)), sizeof(T));
+                    return value;
+                }
+            };
+
+            Classifier & classifierOf(uint64_t id)
+            {
+                auto it = m_classifiers.find(id);
+                if (it == m_classifiers.end())
+                {
+                    throw std::runtime_error("PopulationJournal::Replayer: Unknown classifier ID (" + std::to_string(id) + ").");
+                }
+                return it->second;
+            }
+
+            // Read the bytes, or rewind the stream to pos and return false if the bytes have not been written yet
+            static bool readOrRewind(std::istream & is, std::streampos pos, void *data, std::size_t size)
+            {
+                is.read(static_cast<char *>(data), size);
+                if (static_cast<std::size_t>(is.gcount()) != size)
+                {
+                    is.clear();
+                    is.seekg(pos);
+                    return false;
+                }
+                return true;
+            }
+
+            void readHeader(const Header & header)
+            {
+                if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+                {
+                    throw std::runtime_error("PopulationJournal::Replayer: Not a population journal.");
+                }
+                if (header.byteOrderMark != kByteOrderMark)
+                {
+                    throw std::runtime_error("PopulationJournal::Replayer: The journal has a different byte order.");
+                }
+                if (header.version != kVersion)
+                {
+                    throw std::runtime_error("PopulationJournal::Replayer: Unsupported journal version (" + std::to_string(header.version) + ").");
+                }
+                if (header.symbolKind != SymbolType::binaryKind() || header.symbolSize != SymbolType::binarySize())
+                {
+                    throw std::runtime_error("PopulationJournal::Replayer: The journal was written with a different representation.");
+                }
+            }
+
+            virtual void apply(RecordKind kind, PayloadReader & reader)
+            {
+                if (!m_isBaseApplied && kind != RecordKind::BASE)
+                {
+                    throw std::runtime_error("PopulationJournal::Replayer: The journal does not begin with the base record.");
+                }
+
+                switch (kind)
+                {
+                case RecordKind::BASE:
+                    {
+                        if (m_isBaseApplied)
+                        {
+                            throw std::runtime_error("PopulationJournal::Replayer: The journal has more than one base record.");
+                        }
+                        m_timeStamp = reader.read<uint64_t>();
+                        const uint64_t count = reader.read<uint64_t>();
+                        if (count != m_baseClassifiers.size())
+                        {
+                            throw std::runtime_error("PopulationJournal::Replayer: The base population does not match the journal.");
+                        }
+                        for (uint64_t i = 0; i < count; ++i)
+                        {
+                            m_classifiers.emplace(reader.read<uint64_t>(), std::move(m_baseClassifiers[i]));
+                        }
+                        m_baseClassifiers.clear();
+                        m_isBaseApplied = true;
+                    }
+                    break;
+
+                case RecordKind::INSERTION:
+                    {
+                        const auto record = reader.read<InsertionRecord>();
+                        std::vector<SymbolType> symbols;
+                        symbols.reserve(record.conditionLength);
+                        const unsigned char *p = reader.skip(SymbolType::binarySize() * record.conditionLength);
+                        for (uint64_t i = 0; i < record.conditionLength; ++i)
+                        {
+                            symbols.push_back(SymbolType::readBinary(p));
+                            p += SymbolType::binarySize();
+                        }
+                        Classifier cl(ConditionType(symbols), static_cast<ActionType>(record.action), record.prediction, record.epsilon, record.fitness, record.timeStamp);
+                        cl.experience = record.experience;
+                        cl.actionSetSize = record.actionSetSize;
+                        cl.numerosity = record.numerosity;
+                        if (!m_classifiers.emplace(record.id, std::move(cl)).second)
+                        {
+                            throw std::runtime_error("PopulationJournal::Replayer: Duplicate classifier ID (" + std::to_string(record.id) + ").");
+                        }
+                    }
+                    break;
+
+                case RecordKind::NUMEROSITY:
+                    {
+                        auto & cl = classifierOf(reader.read<uint64_t>());
+                        cl.numerosity = reader.read<uint64_t>();
+                    }
+                    break;
+
+                case RecordKind::DELETION:
+                    {
+                        const uint64_t id = reader.read<uint64_t>();
+                        classifierOf(id);
+                        m_classifiers.erase(id);
+                    }
+                    break;
+
+                case RecordKind::SUBSUMPTION:
+                    {
+                        auto & subsumer = classifierOf(reader.read<uint64_t>());
+                        subsumer.numerosity = reader.read<uint64_t>();
+                        const uint64_t count = reader.read<uint64_t>();
+                        for (uint64_t i = 0; i < count; ++i)
+                        {
+                            const uint64_t id = reader.read<uint64_t>();
+                            classifierOf(id);
+                            m_classifiers.erase(id);
+                        }
+                    }
+                    break;
+
+                case RecordKind::UPDATE:
+                    {
+                        const uint64_t count = reader.read<uint64_t>();
+                        for (uint64_t i = 0; i < count; ++i)
+                        {
+                            const auto entry = reader.read<UpdateEntry>();
+                            auto & cl = classifierOf(entry.id);
+                            cl.prediction = entry.prediction;
+                            cl.epsilon = entry.epsilon;
+                            cl.fitness = entry.fitness;
+                            cl.actionSetSize = entry.actionSetSize;
+                            cl.experience = entry.experience;
+                        }
+                    }
+                    break;
+
+                case RecordKind::TIME_STAMP:
+                    {
+                        m_timeStamp = reader.read<uint64_t>();
+                        const uint64_t count = reader.read<uint64_t>();
+                        for (uint64_t i = 0; i < count; ++i)
+                        {
+                            classifierOf(reader.read<uint64_t>()).timeStamp = m_timeStamp;
+                        }
+                    }
+                    break;
+
+                case RecordKind::CLEAR:
+                    m_classifiers.clear();
+                    break;
+
+                default:
+                    throw std::runtime_error("PopulationJournal::Replayer: Unknown record kind (" + std::to_string(static_cast<uint32_t>(kind)) + ").");
+                }
+            }
+
+        public:
+            // Constructor (replays onto an empty population)
+            Replayer()
+                : Replayer(std::vector<Classifier>())
+            {
+            }
+
+            // Constructor (replays onto the base classifiers)
+            explicit Replayer(std::vector<Classifier> baseClassifiers)
+                : m_baseClassifiers(std::move(baseClassifiers))
+                , m_isHeaderRead(false)
+                , m_isBaseApplied(false)
+                , m_timeStamp(0)
+                , m_recordCount(0)
+            {
+            }
+
+            // Destructor
+            virtual ~Replayer() = default;
+
+            // Apply the complete records in the stream and return the number of the applied records
+            //   The stream is left at the beginning of a truncated record at the end (if any),
+            //   so that the following call continues from it after the file grows.
+            //   Throws std::runtime_error if the journal is broken or does not match the base.
+            std::size_t replay(std::istream & is)
+            {
+                if (!m_isHeaderRead)
+                {
+                    Header header;
+                    if (!readOrRewind(is, is.tellg(), &header, sizeof(header)))
+                    {
+                        return 0;
+                    }
+                    readHeader(header);
+                    m_isHeaderRead = true;
+                }
+
+                std::size_t appliedCount = 0;
+                std::vector<unsigned char> payload;
+                while (true)
+                {
+                    const std::streampos pos = is.tellg();
+                    RecordHeader recordHeader;
+                    if (!readOrRewind(is, pos, &recordHeader, sizeof(recordHeader)))
+                    {
+                        break;
+                    }
+                    payload.resize(recordHeader.size);
+                    if (!payload.empty() && !readOrRewind(is, pos, payload.data(), payload.size()))
+                    {
+                        break;
+                    }
+
+                    PayloadReader reader(payload);
+                    apply(static_cast<RecordKind>(recordHeader.kind), reader);
+                    ++appliedCount;
+                    ++m_recordCount;
+                }
+                return appliedCount;
+            }
+
+            // The classifiers in the order of [P]
+            std::vector<Classifier> classifiers() const
+            {
+                std::vector<Classifier> classifiers;
+                classifiers.reserve(m_classifiers.size());
+                for (auto && pair : m_classifiers)
+                {
+                    classifiers.push_back(pair.second);
+                }
+                return classifiers;
+            }
+
+            std::size_t size() const noexcept
+            {
+                return m_classifiers.size();
+            }
+
+            // The latest GA time stamp in the journal
+            uint64_t timeStamp() const noexcept
+            {
+                return m_timeStamp;
+            }
+
+            // The number of the records applied so far
+            uint64_t recordCount() const noexcept
+            {
+                return m_recordCount;
+            }
+        };
+    }
+
+}
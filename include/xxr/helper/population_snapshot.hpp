@@ -0,0 +1,496 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cfloat>
+#include <cmath>
+#include <cassert>
+
+#include "../xcs/action_registry.hpp"
+#include "../xcs/constants.hpp"
+#include "../xcsr/constants.hpp"
+#include "../random.hpp"
+#include "mapped_file.hpp"
+
+namespace xxr
+{
+
+    // Binary population snapshot
+    //
+    //   Layout (native byte order, all sections are 8-byte aligned):
+    //     Header         : magic, version, layout of the records, section offsets
+    //     ConstantsBlock : the constants of the experiment (XCS and XCSR fields)
+    //     Action table   : actionCount x int64 (the sorted action choices)
+    //     Records        : classifierCount x recordSize bytes
+    //                      (RecordHeader followed by conditionLength encoded symbols)
+    //
+    //   The records have a fixed stride, so the file can be memory-mapped and read
+    //   without parsing (see PopulationSnapshot::View).
+    namespace PopulationSnapshot
+    {
+        constexpr char kMagic[8] = { 'X', 'X', 'R', 'P', 'O', 'P', '\0', '\0' };
+
+        constexpr uint32_t kVersion = 1;
+
+        // Written as is to detect the byte order mismatch
+        constexpr uint32_t kByteOrderMark = 0x01020304;
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrderMark;
+            uint32_t headerSize;
+            uint32_t symbolKind; // Symbol::binaryKind()
+            uint64_t symbolSize; // Symbol::binarySize()
+            uint64_t conditionLength;
+            uint64_t actionCount;
+            uint64_t classifierCount;
+            uint64_t recordSize;
+            uint64_t timeStamp; // the system time stamp of the experiment
+            uint64_t constantsOffset;
+            uint64_t constantsSize;
+            uint64_t actionsOffset;
+            uint64_t recordsOffset;
+        };
+
+        // Constants of XCS and XCSR
+        //   (The XCSR-only fields are zero for XCS.)
+        struct ConstantsBlock
+        {
+            uint64_t n;
+            double beta;
+            double alpha;
+            double epsilonZero;
+            double nu;
+            double gamma;
+            uint64_t thetaGA;
+            double chi;
+            uint64_t crossoverMethod;
+            double mu;
+            uint64_t thetaDel;
+            double delta;
+            uint64_t thetaSub;
+            double tau;
+            double dontCareProbability;
+            double initialPrediction;
+            double initialEpsilon;
+            double initialFitness;
+            double exploreProbability;
+            uint64_t thetaMna;
+            uint64_t flags; // see ConstantsFlag
+            double blxAlpha;
+            double minValue;
+            double maxValue;
+            double coveringMaxSpread;
+            double mutationMaxChange;
+            double subsumptionTolerance;
+        };
+
+        enum ConstantsFlag : uint64_t
+        {
+            DO_GA_SUBSUMPTION = 1 << 0,
+            DO_ACTION_SET_SUBSUMPTION = 1 << 1,
+            DO_ACTION_MUTATION = 1 << 2,
+            USE_MAM = 1 << 3,
+            DO_RANGE_RESTRICTION = 1 << 4,
+            DO_COVERING_RANDOM_RANGE_TRUNCATION = 1 << 5,
+        };
+
+        struct RecordHeader
+        {
+            double prediction;
+            double epsilon;
+            double fitness;
+            double actionSetSize;
+            uint64_t experience;
+            uint64_t timeStamp;
+            uint64_t numerosity;
+            uint64_t actionIdx; // index in the action table
+        };
+
+        inline constexpr uint64_t alignTo8(uint64_t size) noexcept
+        {
+            return (size + 7) / 8 * 8;
+        }
+
+        inline void setRepresentationConstants(ConstantsBlock &, const xcs_impl::Constants &)
+        {
+        }
+
+        inline void setRepresentationConstants(ConstantsBlock & block, const xcsr_impl::Constants & constants)
+        {
+            block.blxAlpha = constants.blxAlpha;
+            block.minValue = constants.minValue;
+            block.maxValue = constants.maxValue;
+            block.coveringMaxSpread = constants.coveringMaxSpread;
+            block.mutationMaxChange = constants.mutationMaxChange;
+            block.subsumptionTolerance = constants.subsumptionTolerance;
+            if (constants.doRangeRestriction) block.flags |= DO_RANGE_RESTRICTION;
+            if (constants.doCoveringRandomRangeTruncation) block.flags |= DO_COVERING_RANDOM_RANGE_TRUNCATION;
+        }
+
+        template <class Constants>
+        ConstantsBlock makeConstantsBlock(const Constants & constants)
+        {
+            ConstantsBlock block;
+            std::memset(&block, 0, sizeof(block));
+            block.n = constants.n;
+            block.beta = constants.beta;
+            block.alpha = constants.alpha;
+            block.epsilonZero = constants.epsilonZero;
+            block.nu = constants.nu;
+            block.gamma = constants.gamma;
+            block.thetaGA = constants.thetaGA;
+            block.chi = constants.chi;
+            block.crossoverMethod = static_cast<uint64_t>(constants.crossoverMethod);
+            block.mu = constants.mu;
+            block.thetaDel = constants.thetaDel;
+            block.delta = constants.delta;
+            block.thetaSub = constants.thetaSub;
+            block.tau = constants.tau;
+            block.dontCareProbability = constants.dontCareProbability;
+            block.initialPrediction = constants.initialPrediction;
+            block.initialEpsilon = constants.initialEpsilon;
+            block.initialFitness = constants.initialFitness;
+            block.exploreProbability = constants.exploreProbability;
+            block.thetaMna = constants.thetaMna;
+            if (constants.doGASubsumption) block.flags |= DO_GA_SUBSUMPTION;
+            if (constants.doActionSetSubsumption) block.flags |= DO_ACTION_SET_SUBSUMPTION;
+            if (constants.doActionMutation) block.flags |= DO_ACTION_MUTATION;
+            if (constants.useMAM) block.flags |= USE_MAM;
+            setRepresentationConstants(block, constants);
+            return block;
+        }
+
+        template <class Symbol>
+        constexpr uint64_t recordSize(uint64_t conditionLength) noexcept
+        {
+            return alignTo8(sizeof(RecordHeader) + Symbol::binarySize() * conditionLength);
+        }
+
+        // Write the classifiers (ClassifierPtrSet such as the population [P]) as a snapshot
+        template <class ClassifierPtrSet, class Constants, typename Action>
+        void write(std::ostream & os, const ClassifierPtrSet & classifiers, const Constants & constants, const xcs_impl::ActionRegistry<Action> & actionRegistry, uint64_t timeStamp)
+        {
+            using SymbolType = typename ClassifierPtrSet::SymbolType;
+
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, kMagic, sizeof(kMagic));
+            header.version = kVersion;
+            header.byteOrderMark = kByteOrderMark;
+            header.headerSize = sizeof(Header);
+            header.symbolKind = SymbolType::binaryKind();
+            header.symbolSize = SymbolType::binarySize();
+            header.conditionLength = (classifiers.size() == 0) ? 0 : (*classifiers.begin())->condition.size();
+            header.actionCount = actionRegistry.size();
+            header.classifierCount = classifiers.size();
+            header.recordSize = recordSize<SymbolType>(header.conditionLength);
+            header.timeStamp = timeStamp;
+            header.constantsOffset = alignTo8(sizeof(Header));
+            header.constantsSize = sizeof(ConstantsBlock);
+            header.actionsOffset = alignTo8(header.constantsOffset + header.constantsSize);
+            header.recordsOffset = alignTo8(header.actionsOffset + sizeof(int64_t) * header.actionCount);
+
+            const char padding[8] = {};
+            const ConstantsBlock constantsBlock = makeConstantsBlock(constants);
+
+            os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            os.write(padding, header.constantsOffset - sizeof(header));
+            os.write(reinterpret_cast<const char *>(&constantsBlock), sizeof(constantsBlock));
+            os.write(padding, header.actionsOffset - (header.constantsOffset + header.constantsSize));
+            for (auto && action : actionRegistry)
+            {
+                const int64_t value = static_cast<int64_t>(action);
+                os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+            }
+            os.write(padding, header.recordsOffset - (header.actionsOffset + sizeof(int64_t) * header.actionCount));
+
+            std::vector<unsigned char> record(header.recordSize);
+            for (auto && cl : classifiers)
+            {
+                if (cl->condition.size() != header.conditionLength)
+                {
+                    throw std::runtime_error("PopulationSnapshot::write: The condition lengths of the classifiers are not the same.");
+                }
+
+                std::fill(record.begin(), record.end(), 0);
+
+                RecordHeader recordHeader;
+                recordHeader.prediction = cl->prediction;
+                recordHeader.epsilon = cl->epsilon;
+                recordHeader.fitness = cl->fitness;
+                recordHeader.actionSetSize = cl->actionSetSize;
+                recordHeader.experience = cl->experience;
+                recordHeader.timeStamp = cl->timeStamp;
+                recordHeader.numerosity = cl->numerosity;
+                recordHeader.actionIdx = actionRegistry.indexOf(cl->action);
+                std::memcpy(record.data(), &recordHeader, sizeof(recordHeader));
+
+                unsigned char *p = record.data() + sizeof(RecordHeader);
+                for (auto && symbol : cl->condition)
+                {
+                    symbol.writeBinary(p);
+                    p += SymbolType::binarySize();
+                }
+
+                os.write(reinterpret_cast<const char *>(record.data()), record.size());
+            }
+
+            if (!os)
+            {
+                throw std::runtime_error("PopulationSnapshot::write: Failed to write the snapshot.");
+            }
+        }
+
+        // Read-only view of a snapshot file
+        //   The file is memory-mapped (see MappedFile), and the classifiers
+        //   are decoded on access. exploit() chooses an action directly from the mapped
+        //   records without building a population.
+        template <class Classifier>
+        class View
+        {
+        public:
+            using type = typename Classifier::type;
+            using SymbolType = typename Classifier::SymbolType;
+            using ConditionType = typename Classifier::ConditionType;
+            using ActionType = typename Classifier::ActionType;
+
+        protected:
+            const MappedFile m_file;
+            const unsigned char * const m_data;
+            const std::size_t m_size;
+            Header m_header;
+            ConstantsBlock m_constants;
+            std::vector<ActionType> m_actions;
+
+            const unsigned char *recordAt(std::size_t idx) const
+            {
+                return m_data + m_header.recordsOffset + m_header.recordSize * idx;
+            }
+
+            RecordHeader recordHeaderAt(std::size_t idx) const
+            {
+                RecordHeader recordHeader;
+                std::memcpy(&recordHeader, recordAt(idx), sizeof(recordHeader));
+                return recordHeader;
+            }
+
+            void validate(const std::string & filename)
+            {
+                const std::string prefix = "PopulationSnapshot::View: '" + filename + "' ";
+
+                if (m_size < sizeof(Header))
+                {
+                    throw std::runtime_error(prefix + "is too small.");
+                }
+                std::memcpy(&m_header, m_data, sizeof(m_header));
+
+                if (std::memcmp(m_header.magic, kMagic, sizeof(kMagic)) != 0)
+                {
+                    throw std::runtime_error(prefix + "is not a population snapshot.");
+                }
+                if (m_header.byteOrderMark != kByteOrderMark)
+                {
+                    throw std::runtime_error(prefix + "has a different byte order.");
+                }
+                if (m_header.version != kVersion)
+                {
+                    throw std::runtime_error(prefix + "has an unsupported version (" + std::to_string(m_header.version) + ").");
+                }
+                if (m_header.symbolKind != SymbolType::binaryKind() || m_header.symbolSize != SymbolType::binarySize())
+                {
+                    throw std::runtime_error(prefix + "was written with a different representation.");
+                }
+                // (The condition of a record is not longer than the file, so recordSize() cannot overflow)
+                if (m_header.conditionLength > m_size / SymbolType::binarySize()
+                    || m_header.recordSize != recordSize<SymbolType>(m_header.conditionLength)
+                    || m_header.constantsSize != sizeof(ConstantsBlock)
+                    || !MappedFile::fits(m_header.constantsOffset, sizeof(ConstantsBlock), 1, m_header.actionsOffset)
+                    || !MappedFile::fits(m_header.actionsOffset, sizeof(int64_t), m_header.actionCount, m_header.recordsOffset)
+                    || !MappedFile::fits(m_header.recordsOffset, m_header.recordSize, m_header.classifierCount, m_size))
+                {
+                    throw std::runtime_error(prefix + "is broken.");
+                }
+
+                std::memcpy(&m_constants, m_data + m_header.constantsOffset, sizeof(m_constants));
+
+                m_actions.clear();
+                for (std::size_t i = 0; i < m_header.actionCount; ++i)
+                {
+                    int64_t value;
+                    std::memcpy(&value, m_data + m_header.actionsOffset + sizeof(int64_t) * i, sizeof(value));
+                    m_actions.push_back(static_cast<ActionType>(value));
+                }
+
+                for (std::size_t i = 0; i < m_header.classifierCount; ++i)
+                {
+                    if (recordHeaderAt(i).actionIdx >= m_header.actionCount)
+                    {
+                        throw std::runtime_error(prefix + "has an invalid action index.");
+                    }
+                }
+            }
+
+        public:
+            // Constructor
+            explicit View(const std::string & filename)
+                : m_file(filename)
+                , m_data(reinterpret_cast<const unsigned char *>(m_file.data()))
+                , m_size(m_file.size())
+            {
+                validate(filename);
+            }
+
+            View(const View &) = delete;
+            View & operator=(const View &) = delete;
+
+            // Destructor
+            ~View() = default;
+
+            const Header & header() const noexcept
+            {
+                return m_header;
+            }
+
+            const ConstantsBlock & constants() const noexcept
+            {
+                return m_constants;
+            }
+
+            // The action choices (sorted in the same order as the action registry)
+            const std::vector<ActionType> & actions() const noexcept
+            {
+                return m_actions;
+            }
+
+            std::size_t size() const noexcept
+            {
+                return m_header.classifierCount;
+            }
+
+            uint64_t timeStamp() const noexcept
+            {
+                return m_header.timeStamp;
+            }
+
+            // DOES MATCH (without decoding the whole classifier)
+            bool matches(std::size_t idx, const std::vector<type> & situation) const
+            {
+                assert(situation.size() == m_header.conditionLength);
+
+                const unsigned char *p = recordAt(idx) + sizeof(RecordHeader);
+                for (std::size_t i = 0; i < m_header.conditionLength; ++i)
+                {
+                    if (!SymbolType::readBinary(p).matches(situation[i]))
+                    {
+                        return false;
+                    }
+                    p += SymbolType::binarySize();
+                }
+                return true;
+            }
+
+            Classifier classifierAt(std::size_t idx) const
+            {
+                const RecordHeader recordHeader = recordHeaderAt(idx);
+
+                std::vector<SymbolType> symbols;
+                symbols.reserve(m_header.conditionLength);
+                const unsigned char *p = recordAt(idx) + sizeof(RecordHeader);
+                for (std::size_t i = 0; i < m_header.conditionLength; ++i)
+                {
+                    symbols.push_back(SymbolType::readBinary(p));
+                    p += SymbolType::binarySize();
+                }
+
+                Classifier cl(ConditionType(symbols), m_actions[recordHeader.actionIdx], recordHeader.prediction, recordHeader.epsilon, recordHeader.fitness, recordHeader.timeStamp);
+                cl.experience = recordHeader.experience;
+                cl.actionSetSize = recordHeader.actionSetSize;
+                cl.numerosity = recordHeader.numerosity;
+                return cl;
+            }
+
+            std::vector<Classifier> classifiers() const
+            {
+                std::vector<Classifier> classifiers;
+                classifiers.reserve(size());
+                for (std::size_t i = 0; i < size(); ++i)
+                {
+                    classifiers.push_back(classifierAt(i));
+                }
+                return classifiers;
+            }
+
+            // Choose the action with the highest fitness-weighted prediction among the matching records
+            // (same as the greedy exploitation of the experiment, but without covering and updates)
+            //   A random action is chosen if no record matches.
+            ActionType exploit(const std::vector<type> & situation, double *pPrediction = nullptr) const
+            {
+                std::vector<double> pa(m_actions.size(), 0.0);
+                std::vector<double> fsa(m_actions.size(), 0.0);
+                std::vector<bool> paActions(m_actions.size(), false);
+                bool matched = false;
+                for (std::size_t i = 0; i < size(); ++i)
+                {
+                    if (matches(i, situation))
+                    {
+                        const RecordHeader recordHeader = recordHeaderAt(i);
+                        pa[recordHeader.actionIdx] += recordHeader.prediction * recordHeader.fitness;
+                        fsa[recordHeader.actionIdx] += recordHeader.fitness;
+                        paActions[recordHeader.actionIdx] = true;
+                        matched = true;
+                    }
+                }
+
+                if (!matched)
+                {
+                    if (pPrediction != nullptr)
+                    {
+                        *pPrediction = m_constants.initialPrediction;
+                    }
+                    return m_actions[Random::nextInt<std::size_t>(0, m_actions.size() - 1)];
+                }
+
+                double maxPA = -100000.0;
+                std::vector<std::size_t> maxPAActionIdxs;
+                for (std::size_t i = 0; i < m_actions.size(); ++i)
+                {
+                    if (!paActions[i])
+                    {
+                        continue;
+                    }
+
+                    if (std::abs(fsa[i]) > 0.0)
+                    {
+                        pa[i] /= fsa[i];
+                    }
+
+                    if (std::abs(maxPA - pa[i]) < DBL_EPSILON)
+                    {
+                        maxPAActionIdxs.push_back(i);
+                    }
+                    else if (maxPA < pa[i])
+                    {
+                        maxPAActionIdxs.assign(1, i);
+                        maxPA = pa[i];
+                    }
+                }
+
+                if (pPrediction != nullptr)
+                {
+                    *pPrediction = maxPA;
+                }
+                return m_actions[maxPAActionIdxs[Random::nextInt<std::size_t>(0, maxPAActionIdxs.size() - 1)]];
+            }
+        };
+    }
+
+}
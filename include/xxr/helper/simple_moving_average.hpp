@@ -1,4 +1,6 @@
 #pragma once
+#include <vector>
+#include <algorithm>
 #include <cstddef>
 #include <cassert>
 
@@ -54,6 +56,27 @@ namespace xxr
         {
             return m_order;
         }
+
+        // The stored samples (in the order of the ring buffer) and the position of the next one
+        std::vector<T> samples() const
+        {
+            return std::vector<T>(m_pBuffer, m_pBuffer + m_valueCount);
+        }
+
+        std::size_t cursor() const
+        {
+            return m_cursor;
+        }
+
+        // Restore the state of samples() and cursor() (e.g. from a checkpoint)
+        void restore(const std::vector<T> & samples, std::size_t cursor)
+        {
+            assert(samples.size() <= m_order && cursor < m_order);
+
+            std::copy(samples.begin(), samples.end(), m_pBuffer);
+            m_valueCount = samples.size();
+            m_cursor = cursor;
+        }
     };
 
     // Simple Moving Average
@@ -83,6 +106,9 @@ namespace xxr
         }
 
         using UnrecursiveFilter<T>::order;
+        using UnrecursiveFilter<T>::samples;
+        using UnrecursiveFilter<T>::cursor;
+        using UnrecursiveFilter<T>::restore;
     };
 
 }
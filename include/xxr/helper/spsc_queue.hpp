@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <utility>
+#include <cstddef>
+
+namespace xxr
+{
+
+    // Bounded lock-free single-producer single-consumer queue
+    // (push() must be called from only one thread, and pop() from only one thread)
+    template <typename T>
+    class SPSCQueue
+    {
+    private:
+        // Ring buffer (one slot is always kept empty to distinguish full from empty)
+        std::vector<T> m_buffer;
+
+        // The index of the next element to pop (written only by the consumer)
+        std::atomic<std::size_t> m_head;
+
+        // The index of the next slot to push (written only by the producer)
+        std::atomic<std::size_t> m_tail;
+
+    public:
+        explicit SPSCQueue(std::size_t capacity)
+            : m_buffer(capacity + 1)
+            , m_head(0)
+            , m_tail(0)
+        {
+        }
+
+        SPSCQueue(const SPSCQueue &) = delete;
+        SPSCQueue & operator=(const SPSCQueue &) = delete;
+
+        // Returns false if the queue is full
+        bool push(T value)
+        {
+            const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            const std::size_t next = (tail + 1) % m_buffer.size();
+            if (next == m_head.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            m_buffer[tail] = std::move(value);
+            m_tail.store(next, std::memory_order_release);
+            return true;
+        }
+
+        // Returns false if the queue is empty
+        bool pop(T & value)
+        {
+            const std::size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            value = std::move(m_buffer[head]);
+            m_head.store((head + 1) % m_buffer.size(), std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const
+        {
+            return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+        }
+
+        std::size_t capacity() const noexcept
+        {
+            return m_buffer.size() - 1;
+        }
+    };
+
+}
@@ -0,0 +1,368 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <type_traits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <cfloat>
+#include <cmath>
+
+namespace xxr { namespace TextFormat
+{
+
+    // Formatting of numbers into a string buffer (without std::ostream)
+    //   The values are formatted in the same way as "std::ostream << value" with the default
+    //   flags (and std::setprecision(precision) for the floating-point values), so the text is
+    //   identical to the output of the streams.
+
+    // The default number of significant digits of std::ostream
+    constexpr int kDefaultPrecision = 6;
+
+    // The precision for the text from which the same value is restored (15 digits if they are enough, otherwise max_digits10)
+    constexpr int kRoundTripPrecision = -1;
+
+    inline void appendValue(std::string & str, bool value)
+    {
+        str.push_back(value ? '1' : '0');
+    }
+
+    template <typename T>
+    std::enable_if_t<std::is_integral<T>::value> appendValue(std::string & str, T value)
+    {
+        if (value >= 0 && value < 10)
+        {
+            str.push_back(static_cast<char>('0' + value));
+            return;
+        }
+
+        char buffer[24];
+        char *p = buffer + sizeof(buffer);
+        const bool isNegative = (value < 0);
+        unsigned long long absValue = isNegative ? 0ULL - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+        do
+        {
+            *--p = static_cast<char>('0' + absValue % 10);
+            absValue /= 10;
+        } while (absValue > 0);
+        if (isNegative)
+        {
+            *--p = '-';
+        }
+        str.append(p, buffer + sizeof(buffer));
+    }
+
+    namespace Detail
+    {
+        constexpr double kPowersOf10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+        };
+
+        // The largest power of 10 that is exactly representable in double
+        constexpr int kMaxExactExponent = 22;
+
+        // The most significant digits that fit in an integer exactly representable in double
+        constexpr int kMaxFastPrecision = 15;
+
+        // Scale the absolute value to the integer of precision digits (m * 10^exponent ~= value)
+        //   Returns false if the result may differ from the correctly rounded one of printf
+        //   (the scaled value is too close to a rounding tie, or the powers are not exact).
+        inline bool toDecimal(double absValue, int precision, uint64_t & m, int & exponent)
+        {
+            if (precision < 1 || precision > kMaxFastPrecision || !(absValue >= 1e-300 && absValue < 1e300))
+            {
+                return false;
+            }
+
+            exponent = static_cast<int>(std::floor(std::log10(absValue)));
+            double scaled = 0.0;
+            for (int retryCount = 0; retryCount < 2; ++retryCount)
+            {
+                const int k = precision - 1 - exponent;
+                if (k > kMaxExactExponent || k < -kMaxExactExponent)
+                {
+                    return false;
+                }
+                scaled = (k >= 0) ? absValue * kPowersOf10[k] : absValue / kPowersOf10[-k];
+
+                // Correct the exponent if log10() is off by one
+                if (scaled >= kPowersOf10[precision])
+                {
+                    ++exponent;
+                }
+                else if (scaled < kPowersOf10[precision - 1])
+                {
+                    --exponent;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            if (scaled >= kPowersOf10[precision] || scaled < kPowersOf10[precision - 1])
+            {
+                return false;
+            }
+
+            // The scaled value has the error of at most 1/2 ULP (one rounding of the exact powers)
+            const double integralPart = std::floor(scaled);
+            const double fractionalPart = scaled - integralPart;
+            if (std::abs(fractionalPart - 0.5) <= scaled * DBL_EPSILON)
+            {
+                return false;
+            }
+
+            m = static_cast<uint64_t>(integralPart) + (fractionalPart > 0.5 ? 1 : 0);
+            if (m >= static_cast<uint64_t>(kPowersOf10[precision]))
+            {
+                // Rounded up to the next power of 10 (e.g. 9.999996 -> 10.0000)
+                m /= 10;
+                ++exponent;
+            }
+            return true;
+        }
+
+        // Format m * 10^(exponent - precision + 1) in the same way as "%.<precision>g"
+        inline int formatDecimal(char *buffer, bool isNegative, uint64_t m, int exponent, int precision)
+        {
+            char digits[24];
+            for (int i = precision - 1; i >= 0; --i)
+            {
+                digits[i] = static_cast<char>('0' + m % 10);
+                m /= 10;
+            }
+
+            // Remove the trailing zeros
+            int digitCount = precision;
+            while (digitCount > 1 && digits[digitCount - 1] == '0')
+            {
+                --digitCount;
+            }
+
+            char *p = buffer;
+            if (isNegative)
+            {
+                *p++ = '-';
+            }
+            if (exponent >= -4 && exponent < precision)
+            {
+                // Fixed notation
+                if (exponent >= 0)
+                {
+                    for (int i = 0; i <= exponent; ++i)
+                    {
+                        *p++ = (i < digitCount) ? digits[i] : '0';
+                    }
+                    if (digitCount > exponent + 1)
+                    {
+                        *p++ = '.';
+                        for (int i = exponent + 1; i < digitCount; ++i)
+                        {
+                            *p++ = digits[i];
+                        }
+                    }
+                }
+                else
+                {
+                    *p++ = '0';
+                    *p++ = '.';
+                    for (int i = 0; i < -exponent - 1; ++i)
+                    {
+                        *p++ = '0';
+                    }
+                    for (int i = 0; i < digitCount; ++i)
+                    {
+                        *p++ = digits[i];
+                    }
+                }
+            }
+            else
+            {
+                // Scientific notation (at least two digits of the exponent)
+                *p++ = digits[0];
+                if (digitCount > 1)
+                {
+                    *p++ = '.';
+                    for (int i = 1; i < digitCount; ++i)
+                    {
+                        *p++ = digits[i];
+                    }
+                }
+                *p++ = 'e';
+                *p++ = (exponent < 0) ? '-' : '+';
+                const int absExponent = std::abs(exponent);
+                if (absExponent >= 100)
+                {
+                    *p++ = static_cast<char>('0' + absExponent / 100);
+                }
+                *p++ = static_cast<char>('0' + absExponent / 10 % 10);
+                *p++ = static_cast<char>('0' + absExponent % 10);
+            }
+            return static_cast<int>(p - buffer);
+        }
+
+        // Format the value with "%.<precision>g" (buffer: at least 40 bytes)
+        //   Returns the length, which may be larger than the buffer size (like snprintf).
+        inline int formatGeneral(char *buffer, std::size_t bufferSize, double value, int precision)
+        {
+            uint64_t m;
+            int exponent;
+            if (toDecimal(std::abs(value), precision, m, exponent))
+            {
+                return formatDecimal(buffer, value < 0, m, exponent, precision);
+            }
+            return std::snprintf(buffer, bufferSize, "%.*g", precision, value);
+        }
+
+        // Format the value with the digits that restore the same value when parsed
+        //   (kMaxFastPrecision digits if they are enough, otherwise max_digits10)
+        inline int formatRoundTrip(char *buffer, std::size_t bufferSize, double value)
+        {
+            uint64_t m;
+            int exponent;
+            if (toDecimal(std::abs(value), kMaxFastPrecision, m, exponent))
+            {
+                // m and 10^k are exact, so the result of a single multiplication or division
+                // is the correctly rounded value of the decimal (the same as strtod())
+                const int k = exponent - kMaxFastPrecision + 1;
+                if (k <= kMaxExactExponent && k >= -kMaxExactExponent)
+                {
+                    const double parsedValue = (k >= 0) ? static_cast<double>(m) * kPowersOf10[k] : static_cast<double>(m) / kPowersOf10[-k];
+                    if (parsedValue == std::abs(value))
+                    {
+                        return formatDecimal(buffer, value < 0, m, exponent, kMaxFastPrecision);
+                    }
+                }
+            }
+            return std::snprintf(buffer, bufferSize, "%.*g", std::numeric_limits<double>::max_digits10, value);
+        }
+    }
+
+    // Append the value with "%.<precision>g" (or kRoundTripPrecision)
+    template <typename T>
+    std::enable_if_t<std::is_floating_point<T>::value> appendValue(std::string & str, T value, int precision = kDefaultPrecision)
+    {
+        // Integral values (e.g. the prediction 1000, the accuracy 1) are written as integers
+        //   "%.<precision>g" writes the integers less than 10^precision without a decimal point.
+        const int integralDigits = (precision < 0) ? std::numeric_limits<T>::digits10 : std::min(precision, std::numeric_limits<T>::digits10);
+        if (std::abs(value) < Detail::kPowersOf10[integralDigits] && value == std::floor(value) && !(value == 0 && std::signbit(value)))
+        {
+            appendValue(str, static_cast<long long>(value));
+            return;
+        }
+
+        char buffer[40];
+        int length;
+        if (precision < 0)
+        {
+            if (std::is_same<T, double>::value)
+            {
+                length = Detail::formatRoundTrip(buffer, sizeof(buffer), static_cast<double>(value));
+            }
+            else
+            {
+                length = std::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<T>::max_digits10, static_cast<double>(value));
+            }
+        }
+        else
+        {
+            length = Detail::formatGeneral(buffer, sizeof(buffer), static_cast<double>(value), precision);
+            if (length >= static_cast<int>(sizeof(buffer)))
+            {
+                // Too many digits for the buffer
+                const std::size_t firstSize = str.size();
+                str.resize(firstSize + length + 1);
+                std::snprintf(&str[firstSize], length + 1, "%.*g", precision, static_cast<double>(value));
+                str.resize(firstSize + length);
+                return;
+            }
+        }
+        str.append(buffer, length);
+    }
+
+    // Format the chunks [0, chunkCount) in parallel and write them to the stream in order
+    //   formatChunk(std::string &, std::size_t chunkIdx) appends the text of a chunk to the
+    //   (cleared) string, and must be safe to call concurrently. The chunks are formatted by
+    //   threadCount threads (0: the number of hardware threads) in rounds of 4 chunks per
+    //   thread to bound the memory of the formatted text, and each round is written before the
+    //   next one. An exception thrown by formatChunk is rethrown after the round.
+    template <class FormatChunk>
+    void writeChunks(std::ostream & os, std::size_t chunkCount, std::size_t threadCount, FormatChunk && formatChunk)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+        }
+        threadCount = std::min(threadCount, chunkCount);
+
+        if (threadCount <= 1)
+        {
+            std::string str;
+            for (std::size_t chunkIdx = 0; chunkIdx < chunkCount; ++chunkIdx)
+            {
+                str.clear();
+                formatChunk(str, chunkIdx);
+                os.write(str.data(), str.size());
+            }
+            return;
+        }
+
+        const std::size_t roundChunkCount = threadCount * 4;
+        std::vector<std::string> outputs(roundChunkCount);
+        std::vector<std::exception_ptr> exceptions(threadCount);
+        for (std::size_t roundFirst = 0; roundFirst < chunkCount; roundFirst += roundChunkCount)
+        {
+            const std::size_t roundLast = std::min(roundFirst + roundChunkCount, chunkCount);
+            std::atomic<std::size_t> nextChunkIdx(roundFirst);
+            auto work = [&](std::size_t threadIdx) {
+                try
+                {
+                    std::size_t chunkIdx;
+                    while ((chunkIdx = nextChunkIdx++) < roundLast)
+                    {
+                        std::string & str = outputs[chunkIdx - roundFirst];
+                        str.clear();
+                        formatChunk(str, chunkIdx);
+                    }
+                }
+                catch (...)
+                {
+                    exceptions[threadIdx] = std::current_exception();
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (std::size_t i = 1; i < threadCount; ++i)
+            {
+                threads.emplace_back(work, i);
+            }
+            work(0);
+            for (auto && thread : threads)
+            {
+                thread.join();
+            }
+
+            for (auto && exception : exceptions)
+            {
+                if (exception)
+                {
+                    std::rethrow_exception(exception);
+                }
+            }
+
+            for (std::size_t i = roundFirst; i < roundLast; ++i)
+            {
+                os.write(outputs[i - roundFirst].data(), outputs[i - roundFirst].size());
+            }
+        }
+    }
+
+}}
@@ -0,0 +1,312 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+namespace xxr { namespace WorkloadTrace
+{
+
+    // Binary trace of the situations, the actions and the rewards of an environment
+    //   (written by RecordingEnvironment and replayed by ReplayEnvironment)
+    //
+    //   Layout (native byte order, the values are written as is):
+    //     Header  : magic, version, byte order mark, value types, situation length, flags
+    //     Actions : the available actions (in ascending order)
+    //     Steps   : until the end of the file, each of
+    //               situation | action | reward (double) | isEndOfProblem (uint8)
+    //               | the rewards of all the available actions (double x actions, if kHasRewardTable)
+    //   The bool values are written as uint8.
+
+    constexpr char kMagic[8] = { 'X', 'X', 'R', 'W', 'L', 'O', 'A', 'D' };
+    constexpr uint32_t kVersion = 1;
+    constexpr uint32_t kByteOrderMark = 0x01020304;
+
+    // Flags
+    constexpr uint32_t kHasRewardTable = 1;
+
+    enum class ValueType : uint32_t
+    {
+        BOOL = 1,
+        INT32,
+        INT64,
+        FLOAT32,
+        FLOAT64,
+    };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrderMark;
+        ValueType situationType;
+        ValueType actionType;
+        uint64_t situationLength;
+        uint64_t actionCount;
+        uint32_t flags;
+        uint32_t reserved;
+    };
+
+    // The stored type of the situation values and the actions
+    template <typename T>
+    struct ValueTraits;
+
+    template <>
+    struct ValueTraits<bool>
+    {
+        using StoredType = uint8_t;
+        static constexpr ValueType kType = ValueType::BOOL;
+    };
+
+    template <>
+    struct ValueTraits<int>
+    {
+        using StoredType = int32_t;
+        static constexpr ValueType kType = ValueType::INT32;
+    };
+
+    template <>
+    struct ValueTraits<long long>
+    {
+        using StoredType = int64_t;
+        static constexpr ValueType kType = ValueType::INT64;
+    };
+
+    template <>
+    struct ValueTraits<float>
+    {
+        using StoredType = float;
+        static constexpr ValueType kType = ValueType::FLOAT32;
+    };
+
+    template <>
+    struct ValueTraits<double>
+    {
+        using StoredType = double;
+        static constexpr ValueType kType = ValueType::FLOAT64;
+    };
+
+    // A trace loaded into memory (the steps are stored contiguously)
+    template <typename T, typename Action>
+    struct Trace
+    {
+        std::vector<Action> actions; // the available actions in ascending order
+        std::size_t situationLength = 0;
+        bool hasRewardTable = false;
+
+        std::vector<T> situations; // stepCount() x situationLength
+        std::vector<Action> takenActions;
+        std::vector<double> rewards;
+        std::vector<bool> endOfProblemFlags;
+        std::vector<double> rewardTable; // stepCount() x actions.size() (empty if !hasRewardTable)
+
+        std::size_t stepCount() const noexcept
+        {
+            return takenActions.size();
+        }
+    };
+
+    template <typename T, typename Action>
+    class Writer
+    {
+    private:
+        std::ostream & m_os;
+        const std::size_t m_situationLength;
+        const std::size_t m_actionCount;
+        const bool m_hasRewardTable;
+        uint64_t m_stepCount;
+
+        template <typename U>
+        void writeValue(const U & value)
+        {
+            const typename ValueTraits<U>::StoredType storedValue = static_cast<typename ValueTraits<U>::StoredType>(value);
+            m_os.write(reinterpret_cast<const char *>(&storedValue), sizeof(storedValue));
+        }
+
+    public:
+        // Constructor (writes the header)
+        Writer(std::ostream & os, std::size_t situationLength, const std::vector<Action> & actions, bool hasRewardTable)
+            : m_os(os)
+            , m_situationLength(situationLength)
+            , m_actionCount(actions.size())
+            , m_hasRewardTable(hasRewardTable)
+            , m_stepCount(0)
+        {
+            Header header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, kMagic, sizeof(kMagic));
+            header.version = kVersion;
+            header.byteOrderMark = kByteOrderMark;
+            header.situationType = ValueTraits<T>::kType;
+            header.actionType = ValueTraits<Action>::kType;
+            header.situationLength = situationLength;
+            header.actionCount = actions.size();
+            header.flags = hasRewardTable ? kHasRewardTable : 0;
+            m_os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+            for (Action action : actions)
+            {
+                writeValue(action);
+            }
+        }
+
+        // Throws std::runtime_error if the length of the situation is not the one of the header
+        void writeStep(const std::vector<T> & situation, Action action, double reward, bool isEndOfProblem, const std::vector<double> & rewardTable)
+        {
+            if (situation.size() != m_situationLength)
+            {
+                throw std::runtime_error("WorkloadTrace::Writer: The length of the situation changed.");
+            }
+            for (const T & value : situation)
+            {
+                writeValue(value);
+            }
+            writeValue(action);
+            writeValue(reward);
+            writeValue(isEndOfProblem);
+            if (m_hasRewardTable)
+            {
+                assert(rewardTable.size() == m_actionCount);
+                for (double value : rewardTable)
+                {
+                    writeValue(value);
+                }
+            }
+            ++m_stepCount;
+        }
+
+        uint64_t stepCount() const noexcept
+        {
+            return m_stepCount;
+        }
+
+        bool good() const
+        {
+            return m_os.good();
+        }
+    };
+
+    namespace detail
+    {
+
+        // Returns false at the end of the stream (throws std::runtime_error in the middle of a value)
+        template <typename U>
+        bool readValue(std::istream & is, U & value)
+        {
+            typename ValueTraits<U>::StoredType storedValue;
+            is.read(reinterpret_cast<char *>(&storedValue), sizeof(storedValue));
+            if (is.gcount() == 0)
+            {
+                return false;
+            }
+            if (static_cast<std::size_t>(is.gcount()) != sizeof(storedValue))
+            {
+                throw std::runtime_error("WorkloadTrace: Unexpected end of the trace.");
+            }
+            value = static_cast<U>(storedValue);
+            return true;
+        }
+
+        template <typename U>
+        void expectValue(std::istream & is, U & value)
+        {
+            if (!readValue(is, value))
+            {
+                throw std::runtime_error("WorkloadTrace: Unexpected end of the trace.");
+            }
+        }
+
+    }
+
+    // Throws std::runtime_error if the stream is not a valid trace of the types
+    template <typename T, typename Action>
+    Trace<T, Action> read(std::istream & is)
+    {
+        Header header;
+        is.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (static_cast<std::size_t>(is.gcount()) != sizeof(header) || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+        {
+            throw std::runtime_error("WorkloadTrace: Not a workload trace.");
+        }
+        if (header.version != kVersion)
+        {
+            throw std::runtime_error("WorkloadTrace: Unsupported trace version (" + std::to_string(header.version) + ").");
+        }
+        if (header.byteOrderMark != kByteOrderMark)
+        {
+            throw std::runtime_error("WorkloadTrace: The trace was written on a machine with a different byte order.");
+        }
+        if (header.situationType != ValueTraits<T>::kType || header.actionType != ValueTraits<Action>::kType)
+        {
+            throw std::runtime_error("WorkloadTrace: The value types of the trace do not match this environment.");
+        }
+        if (header.situationLength == 0)
+        {
+            throw std::runtime_error("WorkloadTrace: The trace has empty situations.");
+        }
+
+        Trace<T, Action> trace;
+        trace.situationLength = header.situationLength;
+        trace.hasRewardTable = ((header.flags & kHasRewardTable) != 0);
+        trace.actions.resize(header.actionCount);
+        for (std::size_t i = 0; i < trace.actions.size(); ++i)
+        {
+            Action action;
+            detail::expectValue(is, action);
+            trace.actions[i] = action;
+        }
+
+        while (true)
+        {
+            T value;
+            if (!detail::readValue(is, value))
+            {
+                break;
+            }
+            trace.situations.push_back(value);
+            for (std::size_t i = 1; i < trace.situationLength; ++i)
+            {
+                detail::expectValue(is, value);
+                trace.situations.push_back(value);
+            }
+
+            Action action;
+            double reward;
+            bool isEndOfProblem;
+            detail::expectValue(is, action);
+            detail::expectValue(is, reward);
+            detail::expectValue(is, isEndOfProblem);
+            trace.takenActions.push_back(action);
+            trace.rewards.push_back(reward);
+            trace.endOfProblemFlags.push_back(isEndOfProblem);
+
+            if (trace.hasRewardTable)
+            {
+                for (std::size_t i = 0; i < trace.actions.size(); ++i)
+                {
+                    detail::expectValue(is, reward);
+                    trace.rewardTable.push_back(reward);
+                }
+            }
+        }
+
+        return trace;
+    }
+
+    template <typename T, typename Action>
+    Trace<T, Action> readFile(const std::string & filename)
+    {
+        std::ifstream ifs(filename, std::ios::binary);
+        if (!ifs)
+        {
+            throw std::runtime_error("WorkloadTrace: Cannot open file '" + filename + "'.");
+        }
+        return read<T, Action>(ifs);
+    }
+
+}}
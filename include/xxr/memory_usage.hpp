@@ -0,0 +1,254 @@
+#pragma once
+#include <string>
+#include <fstream>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+
+namespace xxr
+{
+
+    // Estimated heap footprint of an experiment (see AbstractExperiment::memoryUsage())
+    //   The sizes are computed from the layout of the containers (not measured), so they are
+    //   available in any build. Each heap block is rounded up in the same way as the common
+    //   malloc implementations (a size_t header and 16-byte granularity).
+    struct MemoryUsage
+    {
+        // The bytes of the bookkeeping of a node of std::set (the color and the three links of the red-black tree)
+        static constexpr std::size_t kSetNodeHeaderBytes = 4 * sizeof(void *);
+
+        // The bytes of the control block of std::make_shared (the vtable pointer and the two reference counts)
+        static constexpr std::size_t kSharedControlBlockBytes = sizeof(void *) + 2 * sizeof(int);
+
+        // The heap block size of an allocation of the bytes
+        static std::size_t allocationBytes(std::size_t bytes) noexcept
+        {
+            if (bytes == 0)
+            {
+                return 0;
+            }
+            const std::size_t blockBytes = (bytes + sizeof(std::size_t) + 15) / 16 * 16;
+            return (blockBytes < 32) ? 32 : blockBytes;
+        }
+
+        uint64_t classifierCount = 0; // the macroclassifiers in [P]
+        uint64_t numerositySum = 0;
+
+        uint64_t classifierBytes = 0;    // the classifier objects with the control blocks of shared_ptr
+        uint64_t conditionBytes = 0;     // the heap buffers of the symbols of the conditions
+        uint64_t populationSetBytes = 0; // the nodes of [P]
+        uint64_t actionSetBytes = 0;     // the nodes of [A] and [A]_-1
+        uint64_t matchSetBytes = 0;      // the nodes of [M] and its buffers of the sums for the prediction array
+        uint64_t freeNodeBytes = 0;      // the nodes kept for reuse by [P], [M], [A] and [A]_-1 (see NodePoolAllocator)
+        uint64_t otherBytes = 0;         // the experiment object and its buffers (including the scratch buffers of [P], [A] and GA, excluding the GA worker thread)
+
+        // The peak of the bytes allocated (and not yet freed) in a call of explore(), exploit() or reward()
+        //   Measured only if xxr is built with XXR_ENABLE_MEMORY_ACCOUNTING (see MemoryAccounting).
+        uint64_t peakStepAllocationBytes = 0;
+
+        uint64_t totalBytes() const noexcept
+        {
+            return classifierBytes + conditionBytes + populationSetBytes + actionSetBytes + matchSetBytes + freeNodeBytes + otherBytes;
+        }
+
+        // The bytes of [P] per macroclassifier (the classifier, its condition and its node in [P])
+        double bytesPerMacroClassifier() const noexcept
+        {
+            return (classifierCount > 0) ? static_cast<double>(classifierBytes + conditionBytes + populationSetBytes) / classifierCount : 0.0;
+        }
+    };
+
+    // Counting hook of the global operator new/delete (for the transient allocation of the steps)
+    //   Define XXR_ENABLE_MEMORY_ACCOUNTING (e.g. "make MEMORY=1") to enable the counters, and
+    //   XXR_MEMORY_ACCOUNTING_IMPLEMENTATION before including xxr in exactly one translation
+    //   unit of the program to replace the global operators. The counters are per thread, so
+    //   the allocations of a step are not mixed with the ones of the other experiments running
+    //   in parallel (the blocks freed by another thread are subtracted from that thread).
+    namespace MemoryAccounting
+    {
+
+#ifdef XXR_ENABLE_MEMORY_ACCOUNTING
+        constexpr bool kEnabled = true;
+#else
+        constexpr bool kEnabled = false;
+#endif
+
+        struct ThreadCounter
+        {
+            int64_t liveBytes;
+            int64_t peakBytes;
+            uint64_t allocationCount;
+        };
+
+        // (Trivial type without dynamic initialization, so it can be used inside operator new)
+        inline ThreadCounter & threadCounter() noexcept
+        {
+            thread_local ThreadCounter counter = { 0, 0, 0 };
+            return counter;
+        }
+
+        inline void recordAllocation(std::size_t bytes) noexcept
+        {
+            ThreadCounter & counter = threadCounter();
+            counter.liveBytes += static_cast<int64_t>(bytes);
+            ++counter.allocationCount;
+            if (counter.liveBytes > counter.peakBytes)
+            {
+                counter.peakBytes = counter.liveBytes;
+            }
+        }
+
+        inline void recordDeallocation(std::size_t bytes) noexcept
+        {
+            threadCounter().liveBytes -= static_cast<int64_t>(bytes);
+        }
+
+        // Record the peak of the bytes allocated in the scope into peakBytes (if larger)
+        class ScopedPeak
+        {
+#ifdef XXR_ENABLE_MEMORY_ACCOUNTING
+        private:
+            uint64_t & m_peakBytes;
+            const int64_t m_baseBytes;
+            const int64_t m_outerPeakBytes;
+
+        public:
+            explicit ScopedPeak(uint64_t & peakBytes) noexcept
+                : m_peakBytes(peakBytes)
+                , m_baseBytes(threadCounter().liveBytes)
+                , m_outerPeakBytes(threadCounter().peakBytes)
+            {
+                threadCounter().peakBytes = m_baseBytes;
+            }
+
+            ~ScopedPeak()
+            {
+                ThreadCounter & counter = threadCounter();
+                const int64_t peakBytes = counter.peakBytes - m_baseBytes;
+                if (peakBytes > 0 && static_cast<uint64_t>(peakBytes) > m_peakBytes)
+                {
+                    m_peakBytes = static_cast<uint64_t>(peakBytes);
+                }
+                if (m_outerPeakBytes > counter.peakBytes)
+                {
+                    counter.peakBytes = m_outerPeakBytes;
+                }
+            }
+#else
+        public:
+            explicit ScopedPeak(uint64_t &) noexcept
+            {
+            }
+#endif
+
+            ScopedPeak(const ScopedPeak &) = delete;
+            ScopedPeak & operator=(const ScopedPeak &) = delete;
+        };
+
+        // The size of the header placed before the blocks to remember their sizes (keeps the alignment of malloc)
+        constexpr std::size_t kBlockHeaderBytes = 16;
+
+        inline void *allocate(std::size_t bytes) noexcept
+        {
+            void *p = std::malloc(bytes + kBlockHeaderBytes);
+            if (p == nullptr)
+            {
+                return nullptr;
+            }
+            *static_cast<std::size_t *>(p) = bytes;
+            recordAllocation(bytes);
+            return static_cast<char *>(p) + kBlockHeaderBytes;
+        }
+
+        inline void deallocate(void *ptr) noexcept
+        {
+            if (ptr == nullptr)
+            {
+                return;
+            }
+            // (computed as an integer since the compiler cannot see the header before the block)
+            void *p = reinterpret_cast<void *>(reinterpret_cast<std::uintptr_t>(ptr) - kBlockHeaderBytes);
+            recordDeallocation(*static_cast<std::size_t *>(p));
+            std::free(p);
+        }
+
+        // The resident set size of the process in KiB (Linux only, 0 if unknown)
+        inline uint64_t residentSetKiB()
+        {
+#if defined(__linux__)
+            std::ifstream ifs("/proc/self/status");
+            std::string line;
+            while (std::getline(ifs, line))
+            {
+                if (line.compare(0, 6, "VmRSS:") == 0)
+                {
+                    return std::stoull(line.substr(6));
+                }
+            }
+#endif
+            return 0;
+        }
+
+    }
+
+}
+
+#if defined(XXR_ENABLE_MEMORY_ACCOUNTING) && defined(XXR_MEMORY_ACCOUNTING_IMPLEMENTATION)
+
+void *operator new(std::size_t bytes)
+{
+    void *p = xxr::MemoryAccounting::allocate(bytes);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](std::size_t bytes)
+{
+    return operator new(bytes);
+}
+
+void *operator new(std::size_t bytes, const std::nothrow_t &) noexcept
+{
+    return xxr::MemoryAccounting::allocate(bytes);
+}
+
+void *operator new[](std::size_t bytes, const std::nothrow_t &) noexcept
+{
+    return xxr::MemoryAccounting::allocate(bytes);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    xxr::MemoryAccounting::deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    xxr::MemoryAccounting::deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    xxr::MemoryAccounting::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    xxr::MemoryAccounting::deallocate(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+    xxr::MemoryAccounting::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+    xxr::MemoryAccounting::deallocate(ptr);
+}
+
+#endif
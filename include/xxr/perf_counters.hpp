@@ -0,0 +1,244 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace xxr { namespace PerfCounters
+{
+
+    // Hardware performance counters of the threads (Linux perf_event_open)
+    //   Call enable() before running the experiments to read the counters around the phases of
+    //   Profiler (built with XXR_ENABLE_PROFILER) and around the steps in xxr-bench. The counters
+    //   of each thread (including the GA worker thread) are opened as a group on first use and
+    //   read by a single read() call, and the values are scaled if the kernel multiplexed the
+    //   group. Only the user-space events are counted. The counters that cannot be opened (e.g.
+    //   no PMU in a virtual machine, or perf_event_paranoid) are reported as unavailable.
+
+    enum class Counter : std::size_t
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_READ_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+    };
+
+    constexpr std::size_t kCounterCount = 5;
+
+    inline const char *counterName(Counter counter)
+    {
+        static const char * const names[kCounterCount] = {
+            "Cycles",
+            "Instructions",
+            "L1DReadMisses",
+            "LLCMisses",
+            "BranchMisses",
+        };
+        return names[static_cast<std::size_t>(counter)];
+    }
+
+    struct Values
+    {
+        std::array<uint64_t, kCounterCount> counts = {};
+
+        uint64_t operator[](Counter counter) const
+        {
+            return counts[static_cast<std::size_t>(counter)];
+        }
+
+        Values & operator+= (const Values & obj)
+        {
+            for (std::size_t i = 0; i < kCounterCount; ++i)
+            {
+                counts[i] += obj.counts[i];
+            }
+            return *this;
+        }
+
+        // The difference from a previous reading (0 if the scaled value went backwards)
+        friend Values operator- (const Values & lhs, const Values & rhs)
+        {
+            Values values;
+            for (std::size_t i = 0; i < kCounterCount; ++i)
+            {
+                values.counts[i] = (lhs.counts[i] > rhs.counts[i]) ? lhs.counts[i] - rhs.counts[i] : 0;
+            }
+            return values;
+        }
+    };
+
+    // The counters of the calling thread
+    class ThreadCounters
+    {
+    private:
+        std::array<int, kCounterCount> m_fds;
+        std::array<std::size_t, kCounterCount> m_groupIdxs; // the positions of the counters in the group
+        int m_leaderFd;
+        std::size_t m_groupSize;
+
+#if defined(__linux__)
+        static int openCounter(Counter counter, int groupFd)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            switch (counter)
+            {
+            case Counter::CYCLES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case Counter::INSTRUCTIONS:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case Counter::L1D_READ_MISSES:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            case Counter::LLC_MISSES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            case Counter::BRANCH_MISSES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            }
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0 /* calling thread */, -1 /* any cpu */, groupFd, 0));
+        }
+#endif
+
+    public:
+        // Constructor (opens the counters)
+        ThreadCounters()
+            : m_leaderFd(-1)
+            , m_groupSize(0)
+        {
+            m_fds.fill(-1);
+            m_groupIdxs.fill(0);
+#if defined(__linux__)
+            for (std::size_t i = 0; i < kCounterCount; ++i)
+            {
+                m_fds[i] = openCounter(static_cast<Counter>(i), m_leaderFd);
+                if (m_fds[i] >= 0)
+                {
+                    if (m_leaderFd < 0)
+                    {
+                        m_leaderFd = m_fds[i];
+                    }
+                    m_groupIdxs[i] = m_groupSize++;
+                }
+            }
+#endif
+        }
+
+        ThreadCounters(const ThreadCounters &) = delete;
+        ThreadCounters & operator=(const ThreadCounters &) = delete;
+
+        // Destructor
+        ~ThreadCounters()
+        {
+#if defined(__linux__)
+            for (int fd : m_fds)
+            {
+                if (fd >= 0)
+                {
+                    close(fd);
+                }
+            }
+#endif
+        }
+
+        bool isAvailable(Counter counter) const noexcept
+        {
+            return m_fds[static_cast<std::size_t>(counter)] >= 0;
+        }
+
+        // The values counted since the counters were opened (0 for the unavailable counters)
+        Values read() const
+        {
+            Values values;
+#if defined(__linux__)
+            if (m_leaderFd < 0)
+            {
+                return values;
+            }
+
+            // { nr, time_enabled, time_running, values[nr] }
+            uint64_t buffer[3 + kCounterCount];
+            const ssize_t bytes = ::read(m_leaderFd, buffer, sizeof(buffer));
+            if (bytes < static_cast<ssize_t>((3 + m_groupSize) * sizeof(uint64_t)))
+            {
+                return values;
+            }
+            const uint64_t timeEnabled = buffer[1];
+            const uint64_t timeRunning = buffer[2];
+            for (std::size_t i = 0; i < kCounterCount; ++i)
+            {
+                if (m_fds[i] >= 0)
+                {
+                    uint64_t value = buffer[3 + m_groupIdxs[i]];
+                    if (timeRunning > 0 && timeRunning < timeEnabled)
+                    {
+                        value = static_cast<uint64_t>(static_cast<double>(value) * timeEnabled / timeRunning);
+                    }
+                    values.counts[i] = value;
+                }
+            }
+#endif
+            return values;
+        }
+    };
+
+    inline std::atomic<bool> & enabledFlag()
+    {
+        static std::atomic<bool> isEnabled(false);
+        return isEnabled;
+    }
+
+    inline void enable()
+    {
+        enabledFlag().store(true, std::memory_order_relaxed);
+    }
+
+    inline void disable()
+    {
+        enabledFlag().store(false, std::memory_order_relaxed);
+    }
+
+    inline bool isEnabled() noexcept
+    {
+        return enabledFlag().load(std::memory_order_relaxed);
+    }
+
+    inline ThreadCounters & threadCounters()
+    {
+        thread_local ThreadCounters counters;
+        return counters;
+    }
+
+    // Whether the counter can be read in the calling thread
+    inline bool isAvailable(Counter counter)
+    {
+        return threadCounters().isAvailable(counter);
+    }
+
+    // The current values of the calling thread (0 if not enabled)
+    inline Values read()
+    {
+        return isEnabled() ? threadCounters().read() : Values();
+    }
+
+}}
@@ -0,0 +1,379 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "tracer.hpp"
+#include "perf_counters.hpp"
+
+// Phase timers of the hot path of the experiments
+//   The timers are compiled in only if XXR_ENABLE_PROFILER is defined before including xxr
+//   (e.g. "make PROFILE=1"). Otherwise XXR_PROFILE_SCOPE() expands to nothing, and
+//   Profiler::snapshot() returns an empty profile.
+//
+//   The time of a scope excludes the time of the nested scopes (e.g. the deletion in the
+//   covering is counted as the deletion, not as the covering), so the sum of the phases
+//   is the total time spent in the instrumented code. The timers of each thread are
+//   accumulated separately (including the GA worker thread) and summed up by snapshot().
+//   While Tracer is started, the scopes are also recorded as the events of the timeline, and
+//   while PerfCounters is enabled, the hardware counters are accumulated in the same way as the time.
+#ifdef XXR_ENABLE_PROFILER
+#define XXR_PROFILE_CONCAT_IMPL(a, b) a##b
+#define XXR_PROFILE_CONCAT(a, b) XXR_PROFILE_CONCAT_IMPL(a, b)
+#define XXR_PROFILE_SCOPE(phase) const ::xxr::Profiler::ScopedTimer XXR_PROFILE_CONCAT(xxrProfileScopedTimer, __LINE__)(::xxr::Profiler::Phase::phase)
+#else
+#define XXR_PROFILE_SCOPE(phase) ((void)0)
+#endif
+
+namespace xxr { namespace Profiler
+{
+
+#ifdef XXR_ENABLE_PROFILER
+    constexpr bool kEnabled = true;
+#else
+    constexpr bool kEnabled = false;
+#endif
+
+    enum class Phase : std::size_t
+    {
+        MATCHING,         // forming [M] (MatchSet::regenerate())
+        COVERING,         // generating and inserting the covering classifiers
+        PREDICTION_ARRAY, // forming PA
+        ACTION_SET,       // forming [A] (ActionSet::regenerate())
+        UPDATE,           // updating the parameters of [A] (ActionSet::update())
+        GA,               // selection, crossover, mutation and insertion of GA
+        SUBSUMPTION,      // GA subsumption and action set subsumption
+        DELETION,         // deletion from [P] (Population::deleteExtraClassifiers())
+    };
+
+    constexpr std::size_t kPhaseCount = 8;
+
+    inline const char *phaseName(Phase phase)
+    {
+        static const char * const names[kPhaseCount] = {
+            "Matching",
+            "Covering",
+            "PredictionArray",
+            "ActionSet",
+            "Update",
+            "GA",
+            "Subsumption",
+            "Deletion",
+        };
+        return names[static_cast<std::size_t>(phase)];
+    }
+
+    // The accumulated calls and time of the phases
+    struct Profile
+    {
+        std::array<uint64_t, kPhaseCount> callCounts = {};
+        std::array<uint64_t, kPhaseCount> nanoseconds = {};
+        std::array<PerfCounters::Values, kPhaseCount> counters = {}; // (zero unless PerfCounters is enabled)
+
+        Profile & operator+= (const Profile & obj)
+        {
+            for (std::size_t i = 0; i < kPhaseCount; ++i)
+            {
+                callCounts[i] += obj.callCounts[i];
+                nanoseconds[i] += obj.nanoseconds[i];
+                counters[i] += obj.counters[i];
+            }
+            return *this;
+        }
+
+        // The difference from a previous snapshot
+        friend Profile operator- (const Profile & lhs, const Profile & rhs)
+        {
+            Profile profile;
+            for (std::size_t i = 0; i < kPhaseCount; ++i)
+            {
+                profile.callCounts[i] = lhs.callCounts[i] - rhs.callCounts[i];
+                profile.nanoseconds[i] = lhs.nanoseconds[i] - rhs.nanoseconds[i];
+                profile.counters[i] = lhs.counters[i] - rhs.counters[i];
+            }
+            return profile;
+        }
+
+        double secondsOf(Phase phase) const
+        {
+            return nanoseconds[static_cast<std::size_t>(phase)] * 1e-9;
+        }
+
+        uint64_t totalNanoseconds() const
+        {
+            uint64_t sum = 0;
+            for (auto && value : nanoseconds)
+            {
+                sum += value;
+            }
+            return sum;
+        }
+    };
+
+    // The timers of a thread
+    //   The values are written only by the owner thread and read by snapshot() in any thread.
+    class ThreadProfile
+    {
+    private:
+        std::array<std::atomic<uint64_t>, kPhaseCount> m_callCounts;
+        std::array<std::atomic<uint64_t>, kPhaseCount> m_nanoseconds;
+        std::array<std::array<std::atomic<uint64_t>, PerfCounters::kCounterCount>, kPhaseCount> m_counters;
+
+    public:
+        ThreadProfile()
+        {
+            for (std::size_t i = 0; i < kPhaseCount; ++i)
+            {
+                m_callCounts[i].store(0, std::memory_order_relaxed);
+                m_nanoseconds[i].store(0, std::memory_order_relaxed);
+                for (auto && counter : m_counters[i])
+                {
+                    counter.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Add the time (called only by the owner thread, so no atomic read-modify-write is needed)
+        void add(Phase phase, uint64_t nanoseconds)
+        {
+            const std::size_t i = static_cast<std::size_t>(phase);
+            m_callCounts[i].store(m_callCounts[i].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            m_nanoseconds[i].store(m_nanoseconds[i].load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+        }
+
+        void addCounters(Phase phase, const PerfCounters::Values & values)
+        {
+            const std::size_t i = static_cast<std::size_t>(phase);
+            for (std::size_t j = 0; j < PerfCounters::kCounterCount; ++j)
+            {
+                m_counters[i][j].store(m_counters[i][j].load(std::memory_order_relaxed) + values.counts[j], std::memory_order_relaxed);
+            }
+        }
+
+        void addTo(Profile & profile) const
+        {
+            for (std::size_t i = 0; i < kPhaseCount; ++i)
+            {
+                profile.callCounts[i] += m_callCounts[i].load(std::memory_order_relaxed);
+                profile.nanoseconds[i] += m_nanoseconds[i].load(std::memory_order_relaxed);
+                for (std::size_t j = 0; j < PerfCounters::kCounterCount; ++j)
+                {
+                    profile.counters[i].counts[j] += m_counters[i][j].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+
+    // The timers of all the threads (kept after the threads exit)
+    class Registry
+    {
+    private:
+        std::mutex m_mutex;
+        std::vector<std::shared_ptr<ThreadProfile>> m_threadProfiles;
+
+    public:
+        static Registry & instance()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        std::shared_ptr<ThreadProfile> registerThread()
+        {
+            auto threadProfile = std::make_shared<ThreadProfile>();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_threadProfiles.push_back(threadProfile);
+            return threadProfile;
+        }
+
+        Profile snapshot()
+        {
+            Profile profile;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto && threadProfile : m_threadProfiles)
+            {
+                threadProfile->addTo(profile);
+            }
+            return profile;
+        }
+    };
+
+    inline ThreadProfile & threadProfile()
+    {
+        thread_local std::shared_ptr<ThreadProfile> threadProfile = Registry::instance().registerThread();
+        return *threadProfile;
+    }
+
+    // Measure the time until the end of the scope (use XXR_PROFILE_SCOPE() instead of this)
+    class ScopedTimer
+    {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        const Phase m_phase;
+        ScopedTimer * const m_pParent;
+        uint64_t m_nestedNanoseconds;
+        const bool m_readsCounters;
+        PerfCounters::Values m_beginCounters;
+        PerfCounters::Values m_nestedCounters;
+        const Clock::time_point m_begin;
+
+        static ScopedTimer * & current()
+        {
+            thread_local ScopedTimer *pCurrent = nullptr;
+            return pCurrent;
+        }
+
+    public:
+        explicit ScopedTimer(Phase phase)
+            : m_phase(phase)
+            , m_pParent(current())
+            , m_nestedNanoseconds(0)
+            , m_readsCounters(PerfCounters::isEnabled())
+            , m_beginCounters(m_readsCounters ? PerfCounters::threadCounters().read() : PerfCounters::Values())
+            , m_begin(Clock::now())
+        {
+            current() = this;
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer & operator=(const ScopedTimer &) = delete;
+
+        ~ScopedTimer()
+        {
+            const Clock::time_point end = Clock::now();
+            const uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_begin).count());
+            const PerfCounters::Values counted = m_readsCounters ? PerfCounters::threadCounters().read() - m_beginCounters : PerfCounters::Values();
+            if (m_pParent != nullptr && m_pParent->m_phase == m_phase)
+            {
+                // A scope nested in the same phase (e.g. GA::run() in Experiment::runGA()) is a part of the parent
+                m_pParent->m_nestedNanoseconds += m_nestedNanoseconds;
+                m_pParent->m_nestedCounters += m_nestedCounters;
+            }
+            else
+            {
+                threadProfile().add(m_phase, (elapsed > m_nestedNanoseconds) ? elapsed - m_nestedNanoseconds : 0);
+                if (m_readsCounters)
+                {
+                    threadProfile().addCounters(m_phase, counted - m_nestedCounters);
+                }
+                if (m_pParent != nullptr)
+                {
+                    m_pParent->m_nestedNanoseconds += elapsed;
+                    m_pParent->m_nestedCounters += counted;
+                }
+            }
+            current() = m_pParent;
+
+            if (Tracer::isActive())
+            {
+                Tracer::record(phaseName(m_phase), m_begin, end);
+            }
+        }
+    };
+
+    // The accumulated profile of all the threads so far
+    inline Profile snapshot()
+    {
+        return kEnabled ? Registry::instance().snapshot() : Profile();
+    }
+
+    // Write the profile as CSV ("Phase,Calls,Seconds,NsPerCall,Ratio")
+    //   If PerfCounters is enabled, the totals of the counters follow (empty if unavailable).
+    inline void writeCSV(std::ostream & os, const Profile & profile)
+    {
+        const uint64_t total = profile.totalNanoseconds();
+        const bool writesCounters = PerfCounters::isEnabled();
+        os << "Phase,Calls,Seconds,NsPerCall,Ratio";
+        if (writesCounters)
+        {
+            for (std::size_t j = 0; j < PerfCounters::kCounterCount; ++j)
+            {
+                os << ',' << PerfCounters::counterName(static_cast<PerfCounters::Counter>(j));
+            }
+        }
+        os << '\n';
+        for (std::size_t i = 0; i < kPhaseCount; ++i)
+        {
+            os  << phaseName(static_cast<Phase>(i)) << ','
+                << profile.callCounts[i] << ','
+                << profile.nanoseconds[i] * 1e-9 << ','
+                << ((profile.callCounts[i] > 0) ? static_cast<double>(profile.nanoseconds[i]) / profile.callCounts[i] : 0.0) << ','
+                << ((total > 0) ? static_cast<double>(profile.nanoseconds[i]) / total : 0.0);
+            if (writesCounters)
+            {
+                for (std::size_t j = 0; j < PerfCounters::kCounterCount; ++j)
+                {
+                    os << ',';
+                    if (PerfCounters::isAvailable(static_cast<PerfCounters::Counter>(j)))
+                    {
+                        os << profile.counters[i].counts[j];
+                    }
+                }
+            }
+            os << '\n';
+        }
+    }
+
+    // Write the profile as JSON
+    inline void writeJSON(std::ostream & os, const Profile & profile)
+    {
+        const uint64_t total = profile.totalNanoseconds();
+        os << "{\n  \"enabled\": " << (kEnabled ? "true" : "false") << ",\n  \"totalSeconds\": " << total * 1e-9 << ",\n  \"phases\": {\n";
+        for (std::size_t i = 0; i < kPhaseCount; ++i)
+        {
+            os  << "    \"" << phaseName(static_cast<Phase>(i)) << "\": { "
+                << "\"calls\": " << profile.callCounts[i]
+                << ", \"seconds\": " << profile.nanoseconds[i] * 1e-9
+                << ", \"nsPerCall\": " << ((profile.callCounts[i] > 0) ? static_cast<double>(profile.nanoseconds[i]) / profile.callCounts[i] : 0.0)
+                << ", \"ratio\": " << ((total > 0) ? static_cast<double>(profile.nanoseconds[i]) / total : 0.0);
+            if (PerfCounters::isEnabled())
+            {
+                os << ", \"counters\": { ";
+                for (std::size_t j = 0; j < PerfCounters::kCounterCount; ++j)
+                {
+                    os << ((j > 0) ? ", " : "") << '"' << PerfCounters::counterName(static_cast<PerfCounters::Counter>(j)) << "\": ";
+                    if (PerfCounters::isAvailable(static_cast<PerfCounters::Counter>(j)))
+                    {
+                        os << profile.counters[i].counts[j];
+                    }
+                    else
+                    {
+                        os << "null";
+                    }
+                }
+                os << " }";
+            }
+            os << " }" << ((i + 1 < kPhaseCount) ? "," : "") << "\n";
+        }
+        os << "  }\n}\n";
+    }
+
+    // Write the profile to the file (JSON if the filename ends with ".json", otherwise CSV)
+    inline bool writeFile(const std::string & filename, const Profile & profile)
+    {
+        std::ofstream ofs(filename);
+        if (!ofs)
+        {
+            return false;
+        }
+        if (filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0)
+        {
+            writeJSON(ofs, profile);
+        }
+        else
+        {
+            writeCSV(ofs, profile);
+        }
+        return static_cast<bool>(ofs);
+    }
+
+}}
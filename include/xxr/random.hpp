@@ -1,6 +1,8 @@
 #pragma once
 
 #include <random>
+#include <string>
+#include <sstream>
 #include <vector>
 #include <set>
 #include <unordered_set>
@@ -18,17 +20,47 @@ namespace xxr
     private:
         static auto && device()
         {
-            static std::random_device device;
+            static thread_local std::random_device device;
             return device;
         }
 
-        static auto && engine()
+    public:
+        // Random engine of the current thread
+        // (each thread has its own engine so that worker threads do not share the state)
+        static std::mt19937 & engine()
         {
-            static std::mt19937 engine(device()());
+            static thread_local std::mt19937 engine(device()());
             return engine;
         }
 
-    public:
+        // Reseed the random engine of the current thread
+        static void seed(std::mt19937::result_type value)
+        {
+            engine().seed(value);
+        }
+
+        // The state of the random engine of the current thread as text
+        static std::string engineState()
+        {
+            std::ostringstream oss;
+            oss << engine();
+            return oss.str();
+        }
+
+        // Restore the state of engineState() into the random engine of the current thread
+        // (returns false and keeps the engine if the text is not a valid state)
+        static bool setEngineState(const std::string & state)
+        {
+            std::istringstream iss(state);
+            std::mt19937 newEngine;
+            if (!(iss >> newEngine))
+            {
+                return false;
+            }
+            engine() = newEngine;
+            return true;
+        }
+
         template <typename T = double>
         static T nextDouble(T min = 0.0, T max = 1.0)
         {
@@ -75,10 +107,18 @@ namespace xxr
         template <typename T>
         static std::size_t rouletteWheelSelection(const std::vector<T> & container)
         {
-            // Prepare a roulette wheel by the weights
-            T sum = 0;
             std::vector<T> rouletteWheel;
             rouletteWheel.reserve(container.size());
+            return rouletteWheelSelection(container, rouletteWheel);
+        }
+
+        // (The roulette wheel is prepared in the given buffer, which can be kept to avoid allocation)
+        template <typename T>
+        static std::size_t rouletteWheelSelection(const std::vector<T> & container, std::vector<T> & rouletteWheel)
+        {
+            // Prepare a roulette wheel by the weights
+            T sum = 0;
+            rouletteWheel.clear();
             for (auto && value : container)
             {
                 sum += value;
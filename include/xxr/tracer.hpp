@@ -0,0 +1,276 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Timeline of the hot path of the experiments (Chrome trace format)
+//   The tracer records the begin and end times of the phases of Profiler (matching, covering,
+//   update, GA, deletion, ...) and of explore(), exploit() and reward() while it is started,
+//   so that the latency spikes can be seen on a timeline (chrome://tracing or Perfetto).
+//   It is compiled in together with the profiler (XXR_ENABLE_PROFILER, e.g. "make PROFILE=1").
+//   Otherwise XXR_TRACE_SCOPE() expands to nothing and the trace has no events.
+//
+//   The events are kept in a ring buffer per thread (the oldest events are overwritten when
+//   the buffer is full), so the memory and the file size are bounded even in long runs.
+#ifdef XXR_ENABLE_PROFILER
+#define XXR_TRACE_CONCAT_IMPL(a, b) a##b
+#define XXR_TRACE_CONCAT(a, b) XXR_TRACE_CONCAT_IMPL(a, b)
+#define XXR_TRACE_SCOPE(name) const ::xxr::Tracer::ScopedEvent XXR_TRACE_CONCAT(xxrTraceScopedEvent, __LINE__)(name)
+#else
+#define XXR_TRACE_SCOPE(name) ((void)0)
+#endif
+
+namespace xxr { namespace Tracer
+{
+
+#ifdef XXR_ENABLE_PROFILER
+    constexpr bool kEnabled = true;
+#else
+    constexpr bool kEnabled = false;
+#endif
+
+    using Clock = std::chrono::steady_clock;
+
+    // The default number of the events kept per thread
+    constexpr std::size_t kDefaultCapacity = 1 << 20;
+
+    struct Event
+    {
+        const char *name; // (a string literal)
+        Clock::time_point begin;
+        Clock::time_point end;
+    };
+
+    // The ring buffer of the events of a thread
+    //   The mutex is locked only while the tracer is started (by the owner thread) or dumped.
+    class ThreadBuffer
+    {
+    private:
+        mutable std::mutex m_mutex;
+        std::vector<Event> m_events;
+        std::size_t m_capacity;
+        std::size_t m_nextIdx; // the index to be overwritten next (after the buffer is full)
+        uint64_t m_droppedEventCount;
+        const std::size_t m_threadIdx;
+
+    public:
+        explicit ThreadBuffer(std::size_t threadIdx)
+            : m_capacity(kDefaultCapacity)
+            , m_nextIdx(0)
+            , m_droppedEventCount(0)
+            , m_threadIdx(threadIdx)
+        {
+        }
+
+        void push(const Event & event)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_events.size() < m_capacity)
+            {
+                m_events.push_back(event);
+            }
+            else if (m_capacity > 0)
+            {
+                m_events[m_nextIdx] = event;
+                m_nextIdx = (m_nextIdx + 1) % m_capacity;
+                ++m_droppedEventCount;
+            }
+        }
+
+        void clear(std::size_t capacity)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_events.clear();
+            m_capacity = capacity;
+            m_nextIdx = 0;
+            m_droppedEventCount = 0;
+        }
+
+        // Append the events in the recorded order and returns the number of the dropped events
+        uint64_t copyTo(std::vector<Event> & events) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            events.insert(events.end(), m_events.begin() + m_nextIdx, m_events.end());
+            events.insert(events.end(), m_events.begin(), m_events.begin() + m_nextIdx);
+            return m_droppedEventCount;
+        }
+
+        std::size_t threadIdx() const noexcept
+        {
+            return m_threadIdx;
+        }
+    };
+
+    // The buffers of all the threads (kept after the threads exit)
+    class Registry
+    {
+    private:
+        std::mutex m_mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> m_threadBuffers;
+        std::atomic<bool> m_isActive;
+        std::size_t m_capacity;
+        Clock::time_point m_origin;
+
+    public:
+        Registry()
+            : m_isActive(false)
+            , m_capacity(kDefaultCapacity)
+            , m_origin(Clock::now())
+        {
+        }
+
+        static Registry & instance()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        std::shared_ptr<ThreadBuffer> registerThread()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto threadBuffer = std::make_shared<ThreadBuffer>(m_threadBuffers.size());
+            threadBuffer->clear(m_capacity);
+            m_threadBuffers.push_back(threadBuffer);
+            return threadBuffer;
+        }
+
+        bool isActive() const noexcept
+        {
+            return m_isActive.load(std::memory_order_relaxed);
+        }
+
+        // Clear the events and start recording
+        void start(std::size_t capacityPerThread)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_capacity = capacityPerThread;
+            for (auto && threadBuffer : m_threadBuffers)
+            {
+                threadBuffer->clear(capacityPerThread);
+            }
+            m_origin = Clock::now();
+            m_isActive.store(true, std::memory_order_relaxed);
+        }
+
+        void stop()
+        {
+            m_isActive.store(false, std::memory_order_relaxed);
+        }
+
+        // Write the events as Chrome trace JSON (the times are in microseconds from start())
+        void writeJSON(std::ostream & os)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            uint64_t droppedEventCount = 0;
+            bool isFirst = true;
+            os << "{\"traceEvents\":[\n";
+            for (auto && threadBuffer : m_threadBuffers)
+            {
+                std::vector<Event> events;
+                droppedEventCount += threadBuffer->copyTo(events);
+                if (events.empty())
+                {
+                    continue;
+                }
+
+                os  << (isFirst ? "" : ",\n")
+                    << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadBuffer->threadIdx()
+                    << ",\"args\":{\"name\":\"Thread " << threadBuffer->threadIdx() << "\"}}";
+                isFirst = false;
+
+                for (auto && event : events)
+                {
+                    if (event.begin < m_origin)
+                    {
+                        continue; // (began before start())
+                    }
+                    const int64_t begin = std::chrono::duration_cast<std::chrono::nanoseconds>(event.begin - m_origin).count();
+                    const int64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(event.end - event.begin).count();
+                    os  << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"xxr\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadBuffer->threadIdx()
+                        << ",\"ts\":" << begin / 1000 << '.' << std::to_string(1000 + begin % 1000).substr(1)
+                        << ",\"dur\":" << duration / 1000 << '.' << std::to_string(1000 + duration % 1000).substr(1) << '}';
+                }
+            }
+            os << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":" << droppedEventCount << "}}\n";
+        }
+    };
+
+    inline ThreadBuffer & threadBuffer()
+    {
+        thread_local std::shared_ptr<ThreadBuffer> threadBuffer = Registry::instance().registerThread();
+        return *threadBuffer;
+    }
+
+    inline bool isActive() noexcept
+    {
+        return kEnabled && Registry::instance().isActive();
+    }
+
+    // Clear the events recorded so far and start recording
+    inline void start(std::size_t capacityPerThread = kDefaultCapacity)
+    {
+        Registry::instance().start(capacityPerThread);
+    }
+
+    inline void stop()
+    {
+        Registry::instance().stop();
+    }
+
+    inline void record(const char *name, Clock::time_point begin, Clock::time_point end)
+    {
+        threadBuffer().push(Event{ name, begin, end });
+    }
+
+    // Record the time until the end of the scope (use XXR_TRACE_SCOPE() instead of this)
+    class ScopedEvent
+    {
+    private:
+        const char * const m_name;
+        const bool m_isActive;
+        const Clock::time_point m_begin;
+
+    public:
+        explicit ScopedEvent(const char *name)
+            : m_name(name)
+            , m_isActive(isActive())
+            , m_begin(m_isActive ? Clock::now() : Clock::time_point())
+        {
+        }
+
+        ScopedEvent(const ScopedEvent &) = delete;
+        ScopedEvent & operator=(const ScopedEvent &) = delete;
+
+        ~ScopedEvent()
+        {
+            if (m_isActive && isActive())
+            {
+                record(m_name, m_begin, Clock::now());
+            }
+        }
+    };
+
+    inline void writeJSON(std::ostream & os)
+    {
+        Registry::instance().writeJSON(os);
+    }
+
+    inline bool writeFile(const std::string & filename)
+    {
+        std::ofstream ofs(filename);
+        if (!ofs)
+        {
+            return false;
+        }
+        writeJSON(ofs);
+        return static_cast<bool>(ofs);
+    }
+
+}}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <vector>
+#include <unordered_set>
+#include <bitset>
+#include <algorithm>
+#include <string>
+#include <stdexcept>
+#include <cassert>
+#include <cstddef>
+
+#include "../random.hpp"
+
+namespace xxr { namespace xcs_impl
+{
+
+    // Available action choices mapped to dense indices [0, size())
+    //   The actions are sorted so that the index of an action is found by binary search
+    //   (no hashing), and a subset of the actions is represented by a fixed-size bitmask
+    //   (no allocation).
+    template <typename Action>
+    class ActionRegistry
+    {
+    public:
+        using ActionType = Action;
+
+        // The maximum number of action choices
+        static constexpr std::size_t kMaxActionCount = 256;
+
+        // Subset of the action choices (the i-th bit corresponds to actionAt(i))
+        using ActionMask = std::bitset<kMaxActionCount>;
+
+    protected:
+        std::vector<Action> m_actions;
+
+        ActionMask m_fullMask;
+
+    public:
+        // Constructor
+        //   Throws std::invalid_argument if there are more than kMaxActionCount actions.
+        explicit ActionRegistry(const std::unordered_set<Action> & availableActions)
+            : m_actions(availableActions.begin(), availableActions.end())
+        {
+            assert(!m_actions.empty());
+            if (m_actions.size() > kMaxActionCount)
+            {
+                throw std::invalid_argument("ActionRegistry: The number of available actions must not exceed " + std::to_string(kMaxActionCount) + ".");
+            }
+
+            std::sort(m_actions.begin(), m_actions.end());
+
+            for (std::size_t i = 0; i < m_actions.size(); ++i)
+            {
+                m_fullMask.set(i);
+            }
+        }
+
+        std::size_t size() const noexcept
+        {
+            return m_actions.size();
+        }
+
+        Action actionAt(std::size_t idx) const
+        {
+            return m_actions[idx];
+        }
+
+        // Returns the index of the action (the action must be one of the choices)
+        std::size_t indexOf(Action action) const
+        {
+            auto it = std::lower_bound(m_actions.begin(), m_actions.end(), action);
+            assert(it != m_actions.end() && *it == action);
+            return static_cast<std::size_t>(it - m_actions.begin());
+        }
+
+        bool contains(Action action) const
+        {
+            return std::binary_search(m_actions.begin(), m_actions.end(), action);
+        }
+
+        const std::vector<Action> & actions() const noexcept
+        {
+            return m_actions;
+        }
+
+        auto begin() const noexcept
+        {
+            return m_actions.begin();
+        }
+
+        auto end() const noexcept
+        {
+            return m_actions.end();
+        }
+
+        // Returns the mask of all action choices
+        const ActionMask & fullMask() const noexcept
+        {
+            return m_fullMask;
+        }
+
+        // Choose an action uniform randomly
+        Action chooseRandom() const
+        {
+            return m_actions[Random::nextInt<std::size_t>(0, m_actions.size() - 1)];
+        }
+
+        // Choose an action uniform randomly from the actions in the mask
+        Action chooseRandom(const ActionMask & mask) const
+        {
+            const std::size_t count = mask.count();
+            assert(count > 0);
+
+            std::size_t n = Random::nextInt<std::size_t>(0, count - 1);
+            for (std::size_t i = 0; i < m_actions.size(); ++i)
+            {
+                if (mask.test(i) && n-- == 0)
+                {
+                    return m_actions[i];
+                }
+            }
+
+            assert(false);
+            return m_actions.front();
+        }
+    };
+
+}}
@@ -1,12 +1,13 @@
 #pragma once
 
 #include <vector>
-#include <unordered_set>
-#include <unordered_map>
 #include <cstdint>
 #include <cstddef>
 #include <cmath>
 
+#include "../profiler.hpp"
+#include "../memory_usage.hpp"
+
 namespace xxr { namespace xcs_impl
 {
 
@@ -29,29 +30,36 @@ namespace xxr { namespace xcs_impl
     protected:
         using ClassifierPtrSetType::m_set;
         using ClassifierPtrSetType::m_pConstants;
-        using ClassifierPtrSetType::m_availableActions;
+        using ClassifierPtrSetType::m_pActionRegistry;
 
         GA m_ga;
 
-        // UPDATE FITNESS
-        virtual void updateFitness()
-        {
-            double accuracySum = 0.0;
+        // Scratch buffers for update() (kept to avoid allocation in every step)
+        std::vector<StoredClassifierType *> m_updateTargets;
+        std::vector<double> m_relativeAccuracies;
 
-            for (auto && cl : m_set)
-            {
-                accuracySum += cl->accuracy() * cl->numerosity;
-            }
+        // Scratch buffer for doSubsumption()
+        std::vector<ClassifierPtr> m_subsumedClassifiers;
 
-            for (auto && cl : m_set)
+        // UPDATE FITNESS
+        //   The accuracy of each classifier (kappa * n) must be computed into
+        //   m_relativeAccuracies beforehand, in the same order as m_updateTargets.
+        virtual void updateFitness(double accuracySum)
+        {
+            const std::size_t size = m_updateTargets.size();
+            const double beta = m_pConstants->beta;
+            for (std::size_t i = 0; i < size; ++i)
             {
-                cl->fitness += m_pConstants->beta * (cl->accuracy() * cl->numerosity / accuracySum - cl->fitness);
+                auto & fitness = m_updateTargets[i]->fitness;
+                fitness += beta * (m_relativeAccuracies[i] / accuracySum - fitness);
             }
         }
 
         // DO ACTION SET SUBSUMPTION
         virtual void doSubsumption(PopulationType & population)
         {
+            XXR_PROFILE_SCOPE(SUBSUMPTION);
+
             ClassifierPtr cl;
 
             for (auto && c : m_set)
@@ -67,36 +75,37 @@ namespace xxr { namespace xcs_impl
 
             if (cl.get() != nullptr)
             {
-                std::vector<ClassifierPtr> removedClassifiers;
+                std::vector<ClassifierPtr> & removedClassifiers = m_subsumedClassifiers;
+                removedClassifiers.clear();
                 for (auto && c : m_set)
                 {
                     if (cl->isMoreGeneral(*c))
                     {
-                        cl->numerosity += c->numerosity;
                         removedClassifiers.push_back(c);
                     }
                 }
 
+                population.subsume(cl, removedClassifiers);
                 for (auto && removedClassifier : removedClassifiers)
                 {
-                    population.erase(removedClassifier);
                     m_set.erase(removedClassifier);
                 }
+                removedClassifiers.clear();
             }
         }
 
     public:
         // Constructor
-        ActionSet(const ConstantsType *pConstants, const std::unordered_set<ActionType> & availableActions)
-            : ClassifierPtrSetType(pConstants, availableActions)
-            , m_ga(pConstants, availableActions)
+        ActionSet(const ConstantsType *pConstants, const ActionRegistry<ActionType> *pActionRegistry)
+            : ClassifierPtrSetType(pConstants, pActionRegistry)
+            , m_ga(pConstants, pActionRegistry)
         {
         }
 
         template <class MatchSet>
-        ActionSet(const MatchSet & matchSet, ActionType action, const ConstantsType *pConstants, const std::unordered_set<ActionType> & availableActions)
-            : ClassifierPtrSetType(pConstants, availableActions)
-            , m_ga(pConstants, availableActions)
+        ActionSet(const MatchSet & matchSet, ActionType action, const ConstantsType *pConstants, const ActionRegistry<ActionType> *pActionRegistry)
+            : ClassifierPtrSetType(pConstants, pActionRegistry)
+            , m_ga(pConstants, pActionRegistry)
         {
             regenerate(matchSet, action);
         }
@@ -104,10 +113,21 @@ namespace xxr { namespace xcs_impl
         // Destructor
         virtual ~ActionSet() = default;
 
+        // The heap bytes of the scratch buffers of the action set and GA (see MemoryUsage)
+        std::size_t bufferBytes() const noexcept
+        {
+            return MemoryUsage::allocationBytes(m_updateTargets.capacity() * sizeof(StoredClassifierType *))
+                + MemoryUsage::allocationBytes(m_relativeAccuracies.capacity() * sizeof(double))
+                + MemoryUsage::allocationBytes(m_subsumedClassifiers.capacity() * sizeof(ClassifierPtr))
+                + m_ga.bufferBytes();
+        }
+
         // GENERATE ACTION SET
         template <class MatchSet>
         void regenerate(const MatchSet & matchSet, ActionType action)
         {
+            XXR_PROFILE_SCOPE(ACTION_SET);
+
             m_set.clear();
 
             for (auto && cl : matchSet)
@@ -126,6 +146,17 @@ namespace xxr { namespace xcs_impl
 
         // RUN GA (refer to GA::run() for the latter part)
         virtual void runGA(const std::vector<type> & situation, PopulationType & population, uint64_t timeStamp)
+        {
+            if (prepareGA(timeStamp))
+            {
+                population.recordTimeStampUpdate(*this, timeStamp);
+                m_ga.run(*this, situation, population);
+            }
+        }
+
+        // Check the GA threshold and update the time stamps of the classifiers
+        // (Returns true if the GA should be applied to this action set)
+        virtual bool prepareGA(uint64_t timeStamp)
         {
             double numerositySum = 0.0;
             for (auto && cl : m_set)
@@ -148,22 +179,34 @@ namespace xxr { namespace xcs_impl
                     cl->timeStamp = timeStamp;
                 }
 
-                m_ga.run(*this, situation, population);
+                return true;
             }
+
+            return false;
         }
 
         // UPDATE SET
         virtual void update(double p, PopulationType & population)
         {
+            XXR_PROFILE_SCOPE(UPDATE);
+
             // Calculate numerosity sum used for updating action set size estimate
+            // (and gather the classifiers into the contiguous scratch buffer)
             uint64_t numerositySum = 0;
+            m_updateTargets.clear();
             for (auto && cl : m_set)
             {
                 numerositySum += cl->numerosity;
+                m_updateTargets.push_back(cl.get());
             }
 
-            for (auto && cl : m_set)
+            // Update the parameters and compute the accuracy once for each classifier
+            m_relativeAccuracies.resize(m_updateTargets.size());
+            double accuracySum = 0.0;
+            for (std::size_t i = 0; i < m_updateTargets.size(); ++i)
             {
+                auto cl = m_updateTargets[i];
+
                 ++cl->experience;
 
                 // Update prediction, prediction error
@@ -187,9 +230,14 @@ namespace xxr { namespace xcs_impl
                 {
                     cl->actionSetSize += m_pConstants->beta * (numerositySum - cl->actionSetSize);
                 }
+
+                m_relativeAccuracies[i] = cl->accuracy() * cl->numerosity;
+                accuracySum += m_relativeAccuracies[i];
             }
 
-            updateFitness();
+            updateFitness(accuracySum);
+
+            population.recordParameterUpdate(*this);
 
             if (m_pConstants->doActionSetSubsumption)
             {
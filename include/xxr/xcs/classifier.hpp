@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <cassert>
+#include <cmath>
 
 namespace xxr { namespace xcs_impl
 {
@@ -175,11 +176,32 @@ namespace xxr { namespace xcs_impl
             {
                 return 1.0;
             }
+            else if (nu >= 0.0 && nu <= 64.0 && nu == std::floor(nu))
+            {
+                // (epsilon / epsilonZero)^(-nu) by repeated squaring for integral nu (default: 5)
+                return alpha * integerPower(epsilonZero / epsilon, static_cast<unsigned int>(nu));
+            }
             else
             {
                 return alpha * pow(epsilon / epsilonZero, -nu);
             }
         }
+
+    protected:
+        static double integerPower(double base, unsigned int exponent)
+        {
+            double result = 1.0;
+            while (exponent > 0)
+            {
+                if (exponent & 1)
+                {
+                    result *= base;
+                }
+                base *= base;
+                exponent >>= 1;
+            }
+            return result;
+        }
     };
 
     // Classifier in [P] (have a reference to Constants)
@@ -205,6 +227,12 @@ namespace xxr { namespace xcs_impl
         using Classifier::actionSetSize;
         using Classifier::numerosity;
 
+        // ID
+        //   The serial number assigned when the classifier is inserted into [P] (0 if not
+        //   inserted yet). The classifier sets are ordered by the IDs, so that the order of
+        //   the classifiers does not depend on their memory addresses.
+        uint64_t id;
+
     protected:
         // Constants
         const Constants * const m_pConstants;
@@ -215,36 +243,42 @@ namespace xxr { namespace xcs_impl
 
         StoredClassifier(const Classifier & obj, const Constants *pConstants)
             : Classifier(obj)
+            , id(0)
             , m_pConstants(pConstants)
         {
         }
 
         StoredClassifier(const ConditionType & condition, ActionType action, uint64_t timeStamp, const Constants *pConstants)
             : Classifier(condition, action, pConstants->initialPrediction, pConstants->initialEpsilon, pConstants->initialFitness, timeStamp)
+            , id(0)
             , m_pConstants(pConstants)
         {
         }
 
         StoredClassifier(const ConditionActionPairType & conditionActionPair, uint64_t timeStamp, const Constants *pConstants)
             : Classifier(conditionActionPair, pConstants->initialPrediction, pConstants->initialEpsilon, pConstants->initialFitness, timeStamp)
+            , id(0)
             , m_pConstants(pConstants)
         {
         }
 
         StoredClassifier(ConditionActionPairType && conditionActionPair, uint64_t timeStamp, const Constants *pConstants)
             : Classifier(std::move(conditionActionPair), pConstants->initialPrediction, pConstants->initialEpsilon, pConstants->initialFitness, timeStamp)
+            , id(0)
             , m_pConstants(pConstants)
         {
         }
 
         StoredClassifier(const std::vector<type> & situation, ActionType action, uint64_t timeStamp, const Constants *pConstants)
             : Classifier(situation, action, pConstants->initialPrediction, pConstants->initialEpsilon, pConstants->initialFitness, timeStamp)
+            , id(0)
             , m_pConstants(pConstants)
         {
         }
 
         StoredClassifier(const std::string & condition, ActionType action, uint64_t timeStamp, const Constants *pConstants)
             : Classifier(condition, action, pConstants->initialPrediction, pConstants->initialEpsilon, pConstants->initialFitness, timeStamp)
+            , id(0)
             , m_pConstants(pConstants)
         {
         }
@@ -3,10 +3,25 @@
 #include <vector>
 #include <set>
 #include <memory>
+#include <algorithm>
+#include <cstdint>
+
+#include "action_registry.hpp"
+#include "node_pool_allocator.hpp"
 
 namespace xxr { namespace xcs_impl
 {
 
+    // Order of the classifiers in the classifier sets (by the IDs of StoredClassifier)
+    template <class ClassifierPtr>
+    struct ClassifierIdLess
+    {
+        bool operator() (const ClassifierPtr & lhs, const ClassifierPtr & rhs) const noexcept
+        {
+            return lhs->id < rhs->id;
+        }
+    };
+
     template <class StoredClassifier>
     class ClassifierPtrSet
     {
@@ -20,49 +35,79 @@ namespace xxr { namespace xcs_impl
         using ClassifierType = typename StoredClassifier::ClassifierType;
         using StoredClassifierType = StoredClassifier;
         using ClassifierPtr = std::shared_ptr<StoredClassifier>;
+        // (The nodes are reused by the later insertions, see NodePoolAllocator)
+        using SetType = std::set<ClassifierPtr, ClassifierIdLess<ClassifierPtr>, NodePoolAllocator<ClassifierPtr>>;
 
     protected:
         const ConstantsType * const m_pConstants;
-        const std::unordered_set<ActionType> m_availableActions;
+        const ActionRegistry<ActionType> * const m_pActionRegistry;
+
+        // The last classifier ID assigned by this set
+        //   (declared before m_set, which may be initialized with classifiers)
+        uint64_t m_lastClassifierId = 0;
+
+        SetType m_set;
 
-        std::set<ClassifierPtr> m_set;
+        // Assign the ID to the classifier if not assigned yet
+        void assignClassifierId(const ClassifierPtr & cl) noexcept
+        {
+            if (cl->id == 0)
+            {
+                cl->id = ++m_lastClassifierId;
+            }
+            else
+            {
+                m_lastClassifierId = std::max(m_lastClassifierId, cl->id);
+            }
+        }
 
     private:
-        static std::set<ClassifierPtr> makeSetFromClassifiers(const std::vector<ClassifierType> & classifiers, const ConstantsType *pConstants)
+        SetType makeSetFromClassifiers(const std::vector<ClassifierType> & classifiers, const ConstantsType *pConstants)
         {
-            std::set<ClassifierPtr> set;
+            SetType set;
             for (auto && cl : classifiers)
             {
-                set.emplace(std::make_shared<StoredClassifier>(cl, pConstants));
+                auto storedClassifier = std::make_shared<StoredClassifier>(cl, pConstants);
+                assignClassifierId(storedClassifier);
+                set.insert(storedClassifier);
             }
             return set;
         }
 
     public:
         // Constructor
-        ClassifierPtrSet(const ConstantsType *pConstants, const std::unordered_set<ActionType> & availableActions)
+        ClassifierPtrSet(const ConstantsType *pConstants, const ActionRegistry<ActionType> *pActionRegistry)
             : m_pConstants(pConstants)
-            , m_availableActions(availableActions)
+            , m_pActionRegistry(pActionRegistry)
         {
         }
 
-        ClassifierPtrSet(const std::set<ClassifierPtr> & set, const ConstantsType *pConstants, const std::unordered_set<ActionType> & availableActions)
-            : m_set(set)
-            , m_pConstants(pConstants)
-            , m_availableActions(availableActions)
+        ClassifierPtrSet(const SetType & set, const ConstantsType *pConstants, const ActionRegistry<ActionType> *pActionRegistry)
+            : m_pConstants(pConstants)
+            , m_pActionRegistry(pActionRegistry)
+            , m_set(set)
         {
+            for (auto && cl : m_set)
+            {
+                m_lastClassifierId = std::max(m_lastClassifierId, cl->id);
+            }
         }
 
-        ClassifierPtrSet(const std::vector<ClassifierType> & initialClassifiers, const ConstantsType *pConstants, const std::unordered_set<ActionType> & availableActions)
-            : m_set(makeSetFromClassifiers(initialClassifiers, pConstants))
-            , m_pConstants(pConstants)
-            , m_availableActions(availableActions)
+        ClassifierPtrSet(const std::vector<ClassifierType> & initialClassifiers, const ConstantsType *pConstants, const ActionRegistry<ActionType> *pActionRegistry)
+            : m_pConstants(pConstants)
+            , m_pActionRegistry(pActionRegistry)
+            , m_set(makeSetFromClassifiers(initialClassifiers, pConstants))
         {
         }
 
         // Destructor
         virtual ~ClassifierPtrSet() = default;
 
+        const ActionRegistry<ActionType> * actionRegistry() const noexcept
+        {
+            return m_pActionRegistry;
+        }
+
         auto empty() const noexcept
         {
             return m_set.empty();
@@ -73,6 +118,12 @@ namespace xxr { namespace xcs_impl
             return m_set.size();
         }
 
+        // The number of the nodes kept for reuse by the later insertions (see NodePoolAllocator)
+        std::size_t freeNodeCount() const noexcept
+        {
+            return m_set.get_allocator().pool().freeNodeCount();
+        }
+
         auto begin() const noexcept
         {
             return m_set.begin();
@@ -93,16 +144,16 @@ namespace xxr { namespace xcs_impl
             return m_set.cend();
         }
 
-        template <class... Args>
-        auto insert(Args && ... args)
+        // Insert the classifier (the ID is assigned if not assigned yet)
+        auto insert(const ClassifierPtr & cl)
         {
-            return m_set.insert(std::forward<Args>(args)...);
+            assignClassifierId(cl);
+            return m_set.insert(cl);
         }
 
-        template <class... Args>
-        auto emplace(Args && ... args)
+        auto emplace(const ClassifierPtr & cl)
         {
-            return m_set.emplace(std::forward<Args>(args)...);
+            return insert(cl);
         }
 
         template <class... Args>
@@ -133,6 +184,17 @@ namespace xxr { namespace xcs_impl
         {
             return m_set.count(std::forward<Args>(args)...);
         }
+
+        // The last classifier ID assigned by this set (the next classifier gets the next ID)
+        uint64_t lastClassifierId() const noexcept
+        {
+            return m_lastClassifierId;
+        }
+
+        void setLastClassifierId(uint64_t id) noexcept
+        {
+            m_lastClassifierId = id;
+        }
     };
 
 }}
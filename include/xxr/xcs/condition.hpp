@@ -58,6 +58,22 @@ namespace xxr { namespace xcs_impl
             return str;
         }
 
+        // Append toString() to the string (the precision is passed to the symbols)
+        void appendTo(std::string & str, int precision = 0) const
+        {
+            const std::size_t firstSize = str.size();
+            for (auto && symbol : m_symbols)
+            {
+                symbol.appendTo(str, precision);
+            }
+
+            // Erase last whitespace
+            if (str.size() > firstSize && str.back() == ' ')
+            {
+                str.pop_back();
+            }
+        }
+
         virtual Symbol & operator[] (std::size_t idx)
         {
             return m_symbols[idx];
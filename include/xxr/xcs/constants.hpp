@@ -136,6 +136,11 @@ namespace xxr { namespace xcs_impl
         //   prediction and the prediction error of classifiers
         bool useMAM = true;
 
+        // useAsyncGA
+        //   Whether to run the GA (and the following deletion) in a background thread
+        //   (the offspring are applied to the population a few steps later; see GAWorker)
+        bool useAsyncGA = false;
+
         virtual ~Constants() = default;
     };
 
@@ -6,12 +6,17 @@
 #include <memory>
 #include <type_traits>
 #include <vector>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <stdexcept>
 #include <cstdint>
 #include <cstddef>
 #include <cmath>
 
 #include "../experiment.hpp"
 #include "constants.hpp"
+#include "action_registry.hpp"
 #include "symbol.hpp"
 #include "condition.hpp"
 #include "classifier.hpp"
@@ -20,9 +25,13 @@
 #include "match_set.hpp"
 #include "action_set.hpp"
 #include "ga.hpp"
+#include "ga_worker.hpp"
 #include "prediction_array.hpp"
 #include "../random.hpp"
+#include "../tracer.hpp"
 #include "../helper/csv.hpp"
+#include "../helper/population_snapshot.hpp"
+#include "../helper/population_journal.hpp"
 
 namespace xxr { namespace xcs_impl
 {
@@ -93,10 +102,18 @@ namespace xxr { namespace xcs_impl
         ConstantsType constants;
 
     protected:
+        // Available action choices
+        const ActionRegistry<Action> m_actionRegistry;
+
         // [P]
         //   The population [P] consists of all classifier that exist in XCS at any time.
         PopulationType m_population;
 
+        // [M]
+        //   The match set is kept and regenerated in every step (its nodes and buffers are
+        //   reused) and cleared at the end of the step.
+        MatchSetType m_matchSet;
+
         // [A]
         //   The action set [A] is formed out of the current [M].
         //   It includes all classifiers of [M] that propose the executed action.
@@ -107,9 +124,6 @@ namespace xxr { namespace xcs_impl
         //   execution cycle.
         ActionSet m_prevActionSet;
 
-        // Available action choices
-        std::unordered_set<Action> m_availableActions;
-
         uint64_t m_timeStamp;
 
         bool m_expectsReward;
@@ -120,26 +134,76 @@ namespace xxr { namespace xcs_impl
 
         // Prediction value of the previous action decision (just for logging)
         double m_prediction;
-        std::unordered_map<int, double> m_predictions;
+        std::vector<double> m_predictions; // indexed by the action index of the action registry
 
         // Covering occurrence of the previous action decision (just for logging)
         bool m_isCoveringPerformed;
 
+        // The peak of the transient allocation in a step (only with XXR_ENABLE_MEMORY_ACCOUNTING)
+        uint64_t m_peakStepAllocationBytes;
+
+        // Journal of the changes of [P] (only while recording)
+        std::unique_ptr<PopulationJournal::Writer> m_journalWriter;
+
+        // Background GA worker (only if useAsyncGA is set in the constants)
+        mutable std::mutex m_populationMutex;
+        std::unique_ptr<GAWorker<ActionSet>> m_gaWorker;
+
+        // Lock [P] against the background GA worker (does nothing in the synchronous GA mode)
+        std::unique_lock<std::mutex> lockPopulation() const
+        {
+            if (m_gaWorker)
+            {
+                m_gaWorker->throttle();
+                return std::unique_lock<std::mutex>(m_populationMutex);
+            }
+            else
+            {
+                return std::unique_lock<std::mutex>();
+            }
+        }
+
+        // RUN GA (queue the request to the background worker in the asynchronous GA mode)
+        void runGA(ActionSet & actionSet, const std::vector<T> & situation)
+        {
+            XXR_PROFILE_SCOPE(GA);
+
+            if (m_gaWorker)
+            {
+                if (actionSet.prepareGA(m_timeStamp))
+                {
+                    m_population.recordTimeStampUpdate(actionSet, m_timeStamp);
+                    m_gaWorker->request(actionSet, situation, m_timeStamp);
+                }
+            }
+            else
+            {
+                actionSet.runGA(situation, m_population, m_timeStamp);
+            }
+        }
+
     public:
         // Constructor
         Experiment(const std::unordered_set<Action> & availableActions, const ConstantsType & constants)
             : constants(constants)
-            , m_population(&this->constants, availableActions)
-            , m_actionSet(&this->constants, availableActions)
-            , m_prevActionSet(&this->constants, availableActions)
-            , m_availableActions(availableActions)
+            , m_actionRegistry(availableActions)
+            , m_population(&this->constants, &m_actionRegistry)
+            , m_matchSet(&this->constants, &m_actionRegistry)
+            , m_actionSet(&this->constants, &m_actionRegistry)
+            , m_prevActionSet(&this->constants, &m_actionRegistry)
             , m_timeStamp(0)
             , m_expectsReward(false)
             , m_prevReward(0.0)
             , m_isPrevModeExplore(false)
             , m_prediction(0.0)
+            , m_predictions(m_actionRegistry.size(), constants.initialPrediction)
             , m_isCoveringPerformed(false)
+            , m_peakStepAllocationBytes(0)
         {
+            if (this->constants.useAsyncGA)
+            {
+                m_gaWorker = std::make_unique<GAWorker<ActionSet>>(&this->constants, &m_actionRegistry, m_population, m_populationMutex);
+            }
         }
 
         // Destructor
@@ -150,22 +214,28 @@ namespace xxr { namespace xcs_impl
         {
             assert(!m_expectsReward);
 
+            const MemoryAccounting::ScopedPeak memoryPeak(m_peakStepAllocationBytes);
+            XXR_TRACE_SCOPE("Explore");
+            auto lock = lockPopulation();
+
             // [M]
             //   The match set [M] is formed out of the current [P].
             //   It includes all classifiers that match the current situation.
-            const MatchSetType matchSet(m_population, situation, m_timeStamp, &this->constants, m_availableActions);
-            m_isCoveringPerformed = matchSet.isCoveringPerformed();
+            m_matchSet.regenerate(m_population, situation, m_timeStamp);
+            m_isCoveringPerformed = m_matchSet.isCoveringPerformed();
 
-            const PredictionArray predictionArray(matchSet, &this->constants, this->constants.exploreProbability);
+            const PredictionArray predictionArray(m_matchSet, &this->constants, this->constants.exploreProbability);
 
             const Action action = predictionArray.selectAction();
             m_prediction = predictionArray.predictionFor(action);
-            for (const auto & action : m_availableActions)
+            for (std::size_t i = 0; i < m_predictions.size(); ++i)
             {
-                m_predictions[action] = predictionArray.predictionFor(action);
+                m_predictions[i] = predictionArray.predictionAt(i);
             }
 
-            m_actionSet.regenerate(matchSet, action);
+            m_actionSet.regenerate(m_matchSet, action);
+            m_matchSet.clear();
+            m_population.stats().recordActionSetSize(m_actionSet.size());
 
             m_expectsReward = true;
             m_isPrevModeExplore = true;
@@ -174,7 +244,7 @@ namespace xxr { namespace xcs_impl
             {
                 double p = m_prevReward + constants.gamma * predictionArray.max();
                 m_prevActionSet.update(p, m_population);
-                m_prevActionSet.runGA(m_prevSituation, m_population, m_timeStamp);
+                runGA(m_prevActionSet, m_prevSituation);
             }
 
             m_prevSituation = situation;
@@ -186,12 +256,16 @@ namespace xxr { namespace xcs_impl
         {
             assert(m_expectsReward);
 
+            const MemoryAccounting::ScopedPeak memoryPeak(m_peakStepAllocationBytes);
+            XXR_TRACE_SCOPE("Reward");
+            auto lock = lockPopulation();
+
             if (isEndOfProblem)
             {
                 m_actionSet.update(value, m_population);
                 if (m_isPrevModeExplore) // Do not perform GA operations in exploitation
                 {
-                    m_actionSet.runGA(m_prevSituation, m_population, m_timeStamp);
+                    runGA(m_actionSet, m_prevSituation);
                 }
                 m_prevActionSet.clear();
             }
@@ -213,6 +287,10 @@ namespace xxr { namespace xcs_impl
         // (Set update to true when testing multi-step problems. If update is true, make sure to call reward() after this.)
         virtual Action exploit(const std::vector<T> & situation, bool update = false) override
         {
+            const MemoryAccounting::ScopedPeak memoryPeak(m_peakStepAllocationBytes);
+            XXR_TRACE_SCOPE("Exploit");
+            auto lock = lockPopulation();
+
             if (update)
             {
                 assert(!m_expectsReward);
@@ -220,14 +298,16 @@ namespace xxr { namespace xcs_impl
                 // [M]
                 //   The match set [M] is formed out of the current [P].
                 //   It includes all classifiers that match the current situation.
-                const MatchSetType matchSet(m_population, situation, m_timeStamp, &this->constants, m_availableActions);
-                m_isCoveringPerformed = matchSet.isCoveringPerformed();
+                m_matchSet.regenerate(m_population, situation, m_timeStamp);
+                m_isCoveringPerformed = m_matchSet.isCoveringPerformed();
 
-                const GreedyPredictionArray<MatchSetType> predictionArray(matchSet, &this->constants);
+                const GreedyPredictionArray<MatchSetType> predictionArray(m_matchSet, &this->constants);
 
                 const Action action = predictionArray.selectAction();
 
-                m_actionSet.regenerate(matchSet, action);
+                m_actionSet.regenerate(m_matchSet, action);
+                m_matchSet.clear();
+                m_population.stats().recordActionSetSize(m_actionSet.size());
 
                 m_expectsReward = true;
                 m_isPrevModeExplore = false;
@@ -246,26 +326,20 @@ namespace xxr { namespace xcs_impl
             }
             else
             {
-                // Create new match set as sandbox
-                MatchSetType matchSet(&this->constants, m_availableActions);
-                for (auto && cl : m_population)
-                {
-                    if (cl->condition.matches(situation))
-                    {
-                        matchSet.insert(cl);
-                    }
-                }
+                // Use the match set as sandbox (without covering)
+                m_matchSet.regenerateWithoutCovering(m_population, situation);
 
-                if (!matchSet.empty())
+                if (!m_matchSet.empty())
                 {
                     m_isCoveringPerformed = false;
 
-                    GreedyPredictionArray<MatchSetType> predictionArray(matchSet, &this->constants);
+                    GreedyPredictionArray<MatchSetType> predictionArray(m_matchSet, &this->constants);
+                    m_matchSet.clear();
                     const Action action = predictionArray.selectAction();
                     m_prediction = predictionArray.predictionFor(action);
-                    for (const auto & action : m_availableActions)
+                    for (std::size_t i = 0; i < m_predictions.size(); ++i)
                     {
-                        m_predictions[action] = predictionArray.predictionFor(action);
+                        m_predictions[i] = predictionArray.predictionAt(i);
                     }
                     return action;
                 }
@@ -273,11 +347,8 @@ namespace xxr { namespace xcs_impl
                 {
                     m_isCoveringPerformed = true;
                     m_prediction = this->constants.initialPrediction;
-                    for (const auto & action : m_availableActions)
-                    {
-                        m_predictions[action] = this->constants.initialPrediction;
-                    }
-                    return Random::chooseFrom(m_availableActions);
+                    std::fill(m_predictions.begin(), m_predictions.end(), this->constants.initialPrediction);
+                    return m_actionRegistry.chooseRandom();
                 }
             }
         }
@@ -293,7 +364,7 @@ namespace xxr { namespace xcs_impl
         // (Call this function after explore() or exploit())
         double predictionFor(int action) const
         {
-            return m_predictions.at(action);
+            return m_predictions[m_actionRegistry.indexOf(action)];
         }
 
         // Get if covering is performed in the previous action decision
@@ -305,6 +376,9 @@ namespace xxr { namespace xcs_impl
 
         virtual std::vector<ClassifierType> getMatchingClassifiers(const std::vector<T> & situation) const
         {
+            flushGA();
+            auto lock = lockPopulation();
+
             std::vector<ClassifierType> classifiers;
             for (auto && cl : m_population)
             {
@@ -335,6 +409,41 @@ namespace xxr { namespace xcs_impl
             setPopulation(population, !useAsInitialPopulation);
         }
 
+        // Load the population from a binary snapshot (see PopulationSnapshot)
+        //   useAsInitialPopulation = false restores the classifiers and the system time stamp as is.
+        virtual void loadPopulationBinary(const std::string & filename, bool useAsInitialPopulation = true) override
+        {
+            const PopulationSnapshot::View<ClassifierType> view(filename);
+            for (auto && action : view.actions())
+            {
+                if (!m_actionRegistry.contains(action))
+                {
+                    throw std::runtime_error("Experiment::loadPopulationBinary: The action '" + std::to_string(action) + "' in '" + filename + "' is not available in this experiment.");
+                }
+            }
+
+            auto population = view.classifiers();
+            if (useAsInitialPopulation)
+            {
+                for (auto && cl : population)
+                {
+                    cl.prediction = this->constants.initialPrediction;
+                    cl.epsilon = this->constants.initialEpsilon;
+                    cl.fitness = this->constants.initialFitness;
+                    cl.experience = 0;
+                    cl.timeStamp = 0;
+                    cl.actionSetSize = 1;
+                }
+            }
+            setPopulation(population, false);
+
+            flushGA();
+            auto lock = lockPopulation();
+            m_timeStamp = useAsInitialPopulation ? 0 : view.timeStamp();
+        }
+
+        // (In the asynchronous GA mode, the background worker may modify the population
+        //  after this returns. Call flushGA() before reading the population.)
         virtual PopulationType & population()
         {
             return m_population;
@@ -345,8 +454,32 @@ namespace xxr { namespace xcs_impl
             return m_population;
         }
 
+        // Wait until all the queued GA requests are applied to the population
+        // (does nothing in the synchronous GA mode)
+        void flushGA() const
+        {
+            if (m_gaWorker)
+            {
+                m_gaWorker->flush();
+            }
+        }
+
+        // Replace the population with the classifiers
+        //   Throws std::runtime_error if the action of a classifier is not one of the available
+        //   actions (the dense action indices are not checked in the hot path).
         virtual void setPopulation(const std::vector<ClassifierType> & classifiers, bool initTimeStamp = true)
         {
+            for (auto && cl : classifiers)
+            {
+                if (!m_actionRegistry.contains(cl.action))
+                {
+                    throw std::runtime_error("Experiment::setPopulation: The action '" + std::to_string(cl.action) + "' of a classifier is not available in this experiment.");
+                }
+            }
+
+            flushGA();
+            auto lock = lockPopulation();
+
             // Replace population
             m_population.clear();
             for (auto && cl : classifiers)
@@ -374,31 +507,292 @@ namespace xxr { namespace xcs_impl
             }
         }
 
-        virtual void dumpPopulation(std::ostream & os) const override
+        // Returns copies of the classifiers with the highest fitness
+        // (used for the classifier migration in the island model)
+        virtual std::vector<ClassifierType> fittestClassifiers(std::size_t count) const
+        {
+            flushGA();
+            auto lock = lockPopulation();
+
+            std::vector<const ClassifierPtr *> targets;
+            targets.reserve(m_population.size());
+            for (auto && cl : m_population)
+            {
+                targets.push_back(&cl);
+            }
+
+            count = std::min(count, targets.size());
+            std::partial_sort(targets.begin(), targets.begin() + count, targets.end(), [](const ClassifierPtr *lhs, const ClassifierPtr *rhs) {
+                return (*lhs)->fitness > (*rhs)->fitness;
+            });
+
+            std::vector<ClassifierType> classifiers;
+            classifiers.reserve(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                classifiers.emplace_back(**targets[i]);
+            }
+            return classifiers;
+        }
+
+        // Insert copies of the classifiers into [P] and delete extra classifiers
+        // (used for the island model)
+        //   merge = false: insert with INSERT IN POPULATION (identical classifiers are counted up)
+        //   merge = true: insert with MERGE INTO POPULATION (subsumers also absorb the numerosity)
+        //   The time stamps are clamped to the current one since they come from another experiment.
+        virtual void insertClassifiers(const std::vector<ClassifierType> & classifiers, bool merge = false)
+        {
+            flushGA();
+            auto lock = lockPopulation();
+
+            for (auto && cl : classifiers)
+            {
+                auto storedClassifier = std::make_shared<StoredClassifierType>(cl, &this->constants);
+                storedClassifier->timeStamp = std::min(storedClassifier->timeStamp, m_timeStamp);
+                if (merge)
+                {
+                    m_population.merge(storedClassifier);
+                }
+                else
+                {
+                    m_population.insertOrIncrementNumerosity(storedClassifier);
+                }
+            }
+
+            while (m_population.deleteExtraClassifiers()) {}
+        }
+
+        // Call func with this experiment
+        // (for the same interface as the XCSR experiment class, which passes the experiment of the chosen representation)
+        template <class Func>
+        void visit(Func && func)
+        {
+            func(*this);
+        }
+
+        virtual void dumpPopulation(std::ostream & os, const PopulationCSV::Format & format = PopulationCSV::Format()) const override
         {
+            flushGA();
+            auto lock = lockPopulation();
+
             os << "Condition,Action,prediction,epsilon,F,exp,ts,as,n,acc\n";
+            PopulationCSV::writeRows(os, m_population, format.threadCount, [&format](std::string & str, const StoredClassifierType & cl) {
+                PopulationCSV::appendClassifier(str, cl, format.precision);
+            });
+        }
+
+        virtual void dumpPopulationBinary(std::ostream & os) const override
+        {
+            flushGA();
+            auto lock = lockPopulation();
+
+            PopulationSnapshot::write(os, m_population, constants, m_actionRegistry, m_timeStamp);
+        }
+
+        virtual void startJournal(std::ostream & os) override
+        {
+            flushGA();
+            auto lock = lockPopulation();
+
+            m_journalWriter = std::make_unique<PopulationJournal::Writer>(os, SymbolType::binaryKind(), SymbolType::binarySize());
+            m_journalWriter->writeBase(m_population, m_timeStamp);
+            m_population.setJournalWriter(m_journalWriter.get());
+        }
+
+        virtual void stopJournal() override
+        {
+            flushGA();
+            auto lock = lockPopulation();
+
+            if (m_journalWriter)
+            {
+                m_population.setJournalWriter(nullptr);
+                m_journalWriter->flush();
+                m_journalWriter.reset();
+            }
+        }
+
+        virtual void flushJournal() override
+        {
+            auto lock = lockPopulation();
+
+            if (m_journalWriter)
+            {
+                m_journalWriter->flush();
+            }
+        }
+
+        // Save the complete state of the experiment
+        //   (The random engine is not included since it is shared in the thread. In the
+        //    asynchronous GA mode, the state of the background worker is not included.)
+        virtual void saveCheckpoint(Checkpoint::Writer & writer) const override
+        {
+            flushGA();
+            auto lock = lockPopulation();
+
+            writer.writeTag(Checkpoint::kExperimentTag);
+            writer.write<uint32_t>(SymbolType::binaryKind());
+            writer.write<uint64_t>(m_actionRegistry.size());
+            for (std::size_t i = 0; i < m_actionRegistry.size(); ++i)
+            {
+                writer.write<Action>(m_actionRegistry.actionAt(i));
+            }
+
+            // The constants changed at run time (by switchToCondensationMode())
+            writer.write<double>(constants.chi);
+            writer.write<double>(constants.mu);
+
+            writer.write<uint64_t>(m_timeStamp);
+            writer.write<bool>(m_expectsReward);
+            writer.write<double>(m_prevReward);
+            writer.write<bool>(m_isPrevModeExplore);
+            writer.writeVector(m_prevSituation);
+            writer.write<double>(m_prediction);
+            writer.writeVector(m_predictions);
+            writer.write<bool>(m_isCoveringPerformed);
+            writer.write<ExperimentStats>(m_population.stats());
+
+            // [P]
+            writer.write<uint64_t>(m_population.size());
             for (auto && cl : m_population)
             {
-                os  << cl->condition << ","
-                    << cl->action << ","
-                    << cl->prediction << ","
-                    << cl->epsilon << ","
-                    << cl->fitness << ","
-                    << cl->experience << ","
-                    << cl->timeStamp << ","
-                    << cl->actionSetSize << ","
-                    << cl->numerosity << ","
-                    << cl->accuracy() << "\n";
+                Checkpoint::writeClassifier(writer, *cl);
+            }
+            writer.write<uint64_t>(m_population.lastClassifierId());
+
+            // [A] and [A]_-1 (the IDs of the classifiers)
+            for (const ActionSet *pActionSet : { &m_actionSet, &m_prevActionSet })
+            {
+                writer.write<uint64_t>(pActionSet->size());
+                for (auto && cl : *pActionSet)
+                {
+                    writer.write<uint64_t>(cl->id);
+                }
             }
         }
 
-        virtual std::size_t populationSize() const noexcept override
+        // Load the state saved by saveCheckpoint()
+        //   Throws std::runtime_error if the checkpoint does not match this experiment.
+        virtual void loadCheckpoint(Checkpoint::Reader & reader) override
         {
+            flushGA();
+            auto lock = lockPopulation();
+
+            reader.expectTag(Checkpoint::kExperimentTag, "experiment");
+            if (reader.read<uint32_t>() != SymbolType::binaryKind())
+            {
+                throw std::runtime_error("Checkpoint: The condition type does not match this experiment.");
+            }
+            const uint64_t actionCount = reader.read<uint64_t>();
+            if (actionCount != m_actionRegistry.size())
+            {
+                throw std::runtime_error("Checkpoint: The actions do not match this experiment.");
+            }
+            for (std::size_t i = 0; i < actionCount; ++i)
+            {
+                if (reader.read<Action>() != m_actionRegistry.actionAt(i))
+                {
+                    throw std::runtime_error("Checkpoint: The actions do not match this experiment.");
+                }
+            }
+
+            constants.chi = reader.read<double>();
+            constants.mu = reader.read<double>();
+
+            reader.read(m_timeStamp);
+            reader.read(m_expectsReward);
+            reader.read(m_prevReward);
+            reader.read(m_isPrevModeExplore);
+            reader.readVector(m_prevSituation);
+            reader.read(m_prediction);
+            reader.readVector(m_predictions);
+            reader.read(m_isCoveringPerformed);
+            reader.read(m_population.stats());
+            if (m_predictions.size() != m_actionRegistry.size())
+            {
+                throw std::runtime_error("Checkpoint: The actions do not match this experiment.");
+            }
+
+            // [P]
+            std::unordered_map<uint64_t, ClassifierPtr> classifiers;
+            m_population.clear();
+            const uint64_t populationSize = reader.read<uint64_t>();
+            for (uint64_t i = 0; i < populationSize; ++i)
+            {
+                uint64_t id;
+                auto cl = std::make_shared<StoredClassifierType>(Checkpoint::readClassifier<ClassifierType>(reader, &id), &this->constants);
+                if (!m_actionRegistry.contains(cl->action))
+                {
+                    throw std::runtime_error("Checkpoint: The action '" + std::to_string(cl->action) + "' of a classifier is not available in this experiment.");
+                }
+                cl->id = id;
+                m_population.insert(cl);
+                classifiers.emplace(id, cl);
+            }
+            m_population.setLastClassifierId(reader.read<uint64_t>());
+
+            // [A] and [A]_-1
+            for (ActionSet *pActionSet : { &m_actionSet, &m_prevActionSet })
+            {
+                pActionSet->clear();
+                const uint64_t actionSetSize = reader.read<uint64_t>();
+                for (uint64_t i = 0; i < actionSetSize; ++i)
+                {
+                    const auto it = classifiers.find(reader.read<uint64_t>());
+                    if (it == classifiers.end())
+                    {
+                        throw std::runtime_error("Checkpoint: The action set contains an unknown classifier.");
+                    }
+                    pActionSet->insert(it->second);
+                }
+            }
+        }
+
+        virtual std::size_t populationSize() const override
+        {
+            auto lock = lockPopulation();
             return m_population.size();
         }
 
+        virtual ExperimentStats stats() const override
+        {
+            auto lock = lockPopulation();
+            return m_population.stats();
+        }
+
+        virtual MemoryUsage memoryUsage() const override
+        {
+            flushGA();
+            auto lock = lockPopulation();
+
+            MemoryUsage usage;
+            const std::size_t classifierBytes = MemoryUsage::allocationBytes(MemoryUsage::kSharedControlBlockBytes + sizeof(StoredClassifierType));
+            const std::size_t setNodeBytes = MemoryUsage::allocationBytes(MemoryUsage::kSetNodeHeaderBytes + sizeof(ClassifierPtr));
+            for (auto && cl : m_population)
+            {
+                ++usage.classifierCount;
+                usage.numerositySum += cl->numerosity;
+                usage.classifierBytes += classifierBytes;
+                usage.conditionBytes += MemoryUsage::allocationBytes(cl->condition.size() * sizeof(SymbolType));
+            }
+            usage.populationSetBytes = m_population.size() * setNodeBytes;
+            usage.actionSetBytes = (m_actionSet.size() + m_prevActionSet.size()) * setNodeBytes;
+            usage.matchSetBytes = m_matchSet.size() * setNodeBytes + m_matchSet.bufferBytes();
+            usage.freeNodeBytes = (m_population.freeNodeCount() + m_matchSet.freeNodeCount() + m_actionSet.freeNodeCount() + m_prevActionSet.freeNodeCount()) * setNodeBytes;
+            usage.otherBytes = MemoryUsage::allocationBytes(sizeof(*this))
+                + MemoryUsage::allocationBytes(m_actionRegistry.size() * sizeof(Action))
+                + m_population.bufferBytes()
+                + m_actionSet.bufferBytes()
+                + m_prevActionSet.bufferBytes()
+                + MemoryUsage::allocationBytes(m_prevSituation.capacity() * sizeof(T))
+                + MemoryUsage::allocationBytes(m_predictions.capacity() * sizeof(double));
+            usage.peakStepAllocationBytes = m_peakStepAllocationBytes;
+            return usage;
+        }
+
         virtual std::size_t numerositySum() const override
         {
+            auto lock = lockPopulation();
             uint64_t sum = 0;
             for (auto && cl : m_population)
             {
@@ -407,8 +801,9 @@ namespace xxr { namespace xcs_impl
             return sum;
         }
 
-        virtual void switchToCondensationMode() noexcept override
+        virtual void switchToCondensationMode() override
         {
+            auto lock = lockPopulation();
             constants.chi = 0.0;
             constants.mu = 0.0;
         }
@@ -2,10 +2,13 @@
 
 #include <memory>
 #include <vector>
-#include <unordered_set>
+#include <utility>
 #include <cassert>
 #include <cstddef>
 
+#include "../profiler.hpp"
+#include "../memory_usage.hpp"
+
 namespace xxr { namespace xcs_impl
 {
 
@@ -27,12 +30,21 @@ namespace xxr { namespace xcs_impl
 
     protected:
         const ConstantsType * const m_pConstants;
-        const std::unordered_set<ActionType> & m_availableActions;
+        const ActionRegistry<ActionType> * const m_pActionRegistry;
+
+        // Scratch buffers of run() (kept to avoid allocation in every GA)
+        mutable std::vector<const ClassifierPtr *> m_selectionTargets;
+        mutable std::vector<std::pair<double, std::size_t>> m_tournamentFitnesses;
+        mutable std::vector<double> m_rouletteFitnesses;
+        mutable std::vector<double> m_rouletteWheel;
+        mutable std::vector<ClassifierPtr> m_subsumerChoices;
+        mutable std::vector<ClassifierType> m_children; // (the conditions are overwritten by the next GA)
 
         // SELECT OFFSPRING
         virtual ClassifierPtr selectOffspring(const ClassifierPtrSetType & actionSet) const
         {
-            std::vector<const ClassifierPtr *> targets;
+            std::vector<const ClassifierPtr *> & targets = m_selectionTargets;
+            targets.clear();
             for (auto && cl : actionSet)
             {
                 targets.push_back(&cl);
@@ -42,8 +54,8 @@ namespace xxr { namespace xcs_impl
             if (m_pConstants->tau > 0.0 && m_pConstants->tau <= 1.0)
             {
                 // Tournament selection
-                std::vector<std::pair<double, std::size_t>> fitnesses;
-                fitnesses.reserve(actionSet.size());
+                std::vector<std::pair<double, std::size_t>> & fitnesses = m_tournamentFitnesses;
+                fitnesses.clear();
                 for (auto && target : targets)
                 {
                     fitnesses.emplace_back((*target)->fitness, (*target)->numerosity);
@@ -53,13 +65,13 @@ namespace xxr { namespace xcs_impl
             else
             {
                 // Roulette-wheel selection
-                std::vector<double> fitnesses;
-                fitnesses.reserve(actionSet.size());
+                std::vector<double> & fitnesses = m_rouletteFitnesses;
+                fitnesses.clear();
                 for (auto && target : targets)
                 {
                     fitnesses.push_back((*target)->fitness);
                 }
-                selectedIdx = Random::rouletteWheelSelection(fitnesses);
+                selectedIdx = Random::rouletteWheelSelection(fitnesses, m_rouletteWheel);
             }
             return *targets[selectedIdx];
         }
@@ -158,11 +170,11 @@ namespace xxr { namespace xcs_impl
                 }
             }
 
-            if (m_pConstants->doActionMutation && (Random::nextDouble() < m_pConstants->mu) && (m_availableActions.size() >= 2))
+            if (m_pConstants->doActionMutation && (Random::nextDouble() < m_pConstants->mu) && (m_pActionRegistry->size() >= 2))
             {
-                std::unordered_set<ActionType> otherPossibleActions(m_availableActions);
-                otherPossibleActions.erase(cl.action);
-                cl.action = Random::chooseFrom(otherPossibleActions);
+                auto otherPossibleActions = m_pActionRegistry->fullMask();
+                otherPossibleActions.reset(m_pActionRegistry->indexOf(cl.action));
+                cl.action = m_pActionRegistry->chooseRandom(otherPossibleActions);
             }
         }
 
@@ -175,8 +187,8 @@ namespace xxr { namespace xcs_impl
             }
             else
             {
-                population.insertOrIncrementNumerosity(std::make_shared<StoredClassifierType>(child1, m_pConstants));
-                population.insertOrIncrementNumerosity(std::make_shared<StoredClassifierType>(child2, m_pConstants));
+                insertChild(child1, population);
+                insertChild(child2, population);
             }
 
             while (population.deleteExtraClassifiers()) {}
@@ -184,13 +196,17 @@ namespace xxr { namespace xcs_impl
 
         void subsumeClassifier(const ClassifierType & child, const ClassifierPtr & parent1, const ClassifierPtr & parent2, PopulationType & population) const
         {
+            XXR_PROFILE_SCOPE(SUBSUMPTION);
+
             if (parent1->subsumes(child))
             {
-                ++parent1->numerosity;
+                population.incrementNumerosity(parent1);
+                ++population.stats().subsumedChildCount;
             }
             else if (parent2->subsumes(child))
             {
-                ++parent2->numerosity;
+                population.incrementNumerosity(parent2);
+                ++population.stats().subsumedChildCount;
             }
             else
             {
@@ -200,7 +216,8 @@ namespace xxr { namespace xcs_impl
 
         void subsumeClassifier(const ClassifierType & child, PopulationType & population) const
         {
-            std::vector<ClassifierPtr> choices;
+            std::vector<ClassifierPtr> & choices = m_subsumerChoices;
+            choices.clear();
 
             for (auto && cl : population)
             {
@@ -213,34 +230,80 @@ namespace xxr { namespace xcs_impl
             if (!choices.empty())
             {
                 std::size_t choice = Random::nextInt<std::size_t>(0, choices.size() - 1);
-                ++choices[choice]->numerosity;
+                population.incrementNumerosity(choices[choice]);
+                ++population.stats().subsumedChildCount;
+                choices.clear();
                 return;
             }
 
-            population.insertOrIncrementNumerosity(std::make_shared<StoredClassifierType>(child, m_pConstants));
+            insertChild(child, population);
+        }
+
+        // Insert the child into [P] (or increment the numerosity of the identical classifier)
+        void insertChild(const ClassifierType & child, PopulationType & population) const
+        {
+            if (population.insertOrIncrementNumerosity(child))
+            {
+                ++population.stats().insertedChildCount;
+            }
+            else
+            {
+                ++population.stats().duplicatedChildCount;
+            }
         }
 
     public:
         // Constructor
-        GA(const ConstantsType *pConstants, const std::unordered_set<ActionType> & availableActions)
+        GA(const ConstantsType *pConstants, const ActionRegistry<ActionType> *pActionRegistry)
             : m_pConstants(pConstants)
-            , m_availableActions(availableActions)
+            , m_pActionRegistry(pActionRegistry)
         {
         }
 
         // Destructor
         virtual ~GA() = default;
 
+        // The heap bytes of the scratch buffers (see MemoryUsage)
+        std::size_t bufferBytes() const noexcept
+        {
+            std::size_t bytes = MemoryUsage::allocationBytes(m_selectionTargets.capacity() * sizeof(const ClassifierPtr *))
+                + MemoryUsage::allocationBytes(m_tournamentFitnesses.capacity() * sizeof(std::pair<double, std::size_t>))
+                + MemoryUsage::allocationBytes(m_rouletteFitnesses.capacity() * sizeof(double))
+                + MemoryUsage::allocationBytes(m_rouletteWheel.capacity() * sizeof(double))
+                + MemoryUsage::allocationBytes(m_subsumerChoices.capacity() * sizeof(ClassifierPtr))
+                + MemoryUsage::allocationBytes(m_children.capacity() * sizeof(ClassifierType));
+            for (auto && child : m_children)
+            {
+                bytes += MemoryUsage::allocationBytes(child.condition.size() * sizeof(SymbolType));
+            }
+            return bytes;
+        }
+
         // RUN GA (refer to ActionSet::runGA() for the former part)
         virtual void run(ClassifierPtrSetType & actionSet, const std::vector<type> & situation, PopulationType & population) const
         {
+            XXR_PROFILE_SCOPE(GA);
+
+            ++population.stats().gaCount;
+
             auto parent1 = selectOffspring(actionSet);
             auto parent2 = selectOffspring(actionSet);
 
             assert(parent1->condition.size() == parent2->condition.size());
 
-            ClassifierType child1(*parent1);
-            ClassifierType child2(*parent2);
+            // (The children are copied into the kept classifiers so that their conditions are not reallocated)
+            if (m_children.empty())
+            {
+                m_children.emplace_back(*parent1);
+                m_children.emplace_back(*parent2);
+            }
+            else
+            {
+                m_children[0] = *parent1;
+                m_children[1] = *parent2;
+            }
+            ClassifierType & child1 = m_children[0];
+            ClassifierType & child2 = m_children[1];
             child1.fitness = parent1->fitness / parent1->numerosity;
             child2.fitness = parent2->fitness / parent2->numerosity;
             child1.numerosity = child2.numerosity = 1;
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+
+#include "../random.hpp"
+
+namespace xxr { namespace xcs_impl
+{
+
+    // Background GA worker (used when useAsyncGA is set in the constants)
+    //
+    //   Instead of running the GA inline in explore()/reward(), a GA request
+    //   (a snapshot of the action set, the situation, and the time stamp) is queued
+    //   and the worker thread applies the offspring and the following deletions to
+    //   the population [P].
+    //
+    //   Commit protocol:
+    //     1. The caller checks the GA threshold and updates the time stamps of the
+    //        action set synchronously (ActionSet::prepareGA()), and then queues the
+    //        request.
+    //     2. The worker locks the population mutex, which the caller also holds while
+    //        it reads or updates [P] in explore(), exploit() and reward().
+    //     3. The classifiers in the snapshot that have been removed from [P] since the
+    //        request (by deletion or subsumption) are dropped from the snapshot. The
+    //        request is discarded if no classifier remains.
+    //     4. GA::run() is applied to the snapshot exactly as in the synchronous mode
+    //        (selection, crossover, mutation, GA subsumption, insertion and deletion).
+    //     5. The population mutex is released.
+    //
+    //   This mode is semantically equivalent to the synchronous one up to the delayed
+    //   application of the offspring. The worker thread has its own random engine, which
+    //   is seeded from the engine of the thread constructing the worker (so the random
+    //   sequence of the GA follows Random::seed()). Note that the runs are still not
+    //   reproducible exactly since the commits interleave with the steps depending on
+    //   the timing of the threads.
+    template <class ActionSet>
+    class GAWorker
+    {
+    public:
+        using type = typename ActionSet::type;
+        using ActionType = typename ActionSet::ActionType;
+        using ConstantsType = typename ActionSet::ConstantsType;
+        using ClassifierPtr = typename ActionSet::ClassifierPtr;
+        using ClassifierPtrSetType = typename ActionSet::ClassifierPtrSetType;
+        using PopulationType = typename ActionSet::PopulationType;
+        using GAType = typename ActionSet::GAType;
+
+    protected:
+        struct Request
+        {
+            std::vector<ClassifierPtr> actionSet;
+            std::vector<type> situation;
+            uint64_t timeStamp;
+        };
+
+        const ConstantsType * const m_pConstants;
+        const ActionRegistry<ActionType> * const m_pActionRegistry;
+        const GAType m_ga;
+
+        PopulationType & m_population;
+        std::mutex & m_populationMutex;
+
+        // The maximum number of requests waiting in the queue
+        // (throttle() blocks the caller if the queue is full)
+        const std::size_t m_maxPendingRequestCount;
+
+        std::deque<Request> m_requests;
+        std::mutex m_requestMutex;
+        std::condition_variable m_requestCondition;
+        bool m_isCommitting;
+        bool m_isStopping;
+
+        // The seed of the random engine of the worker thread (declared before m_thread)
+        const std::mt19937::result_type m_seed;
+
+        std::thread m_thread;
+
+        // COMMIT GA REQUEST (call this while holding the population mutex)
+        virtual void commit(const Request & request)
+        {
+            ClassifierPtrSetType actionSet(m_pConstants, m_pActionRegistry);
+            for (auto && cl : request.actionSet)
+            {
+                if (m_population.count(cl))
+                {
+                    actionSet.insert(cl);
+                }
+            }
+
+            if (!actionSet.empty())
+            {
+                m_ga.run(actionSet, request.situation, m_population);
+            }
+        }
+
+        void run()
+        {
+            Random::seed(m_seed);
+
+            std::unique_lock<std::mutex> lock(m_requestMutex);
+            while (true)
+            {
+                m_requestCondition.wait(lock, [this]{ return m_isStopping || !m_requests.empty(); });
+                if (m_isStopping)
+                {
+                    break;
+                }
+
+                Request request = std::move(m_requests.front());
+                m_requests.pop_front();
+                m_isCommitting = true;
+                lock.unlock();
+
+                {
+                    std::lock_guard<std::mutex> populationLock(m_populationMutex);
+                    commit(request);
+                }
+
+                lock.lock();
+                m_isCommitting = false;
+                m_requestCondition.notify_all();
+            }
+        }
+
+    public:
+        // Constructor
+        GAWorker(const ConstantsType *pConstants, const ActionRegistry<ActionType> *pActionRegistry, PopulationType & population, std::mutex & populationMutex, std::size_t maxPendingRequestCount = 16)
+            : m_pConstants(pConstants)
+            , m_pActionRegistry(pActionRegistry)
+            , m_ga(pConstants, pActionRegistry)
+            , m_population(population)
+            , m_populationMutex(populationMutex)
+            , m_maxPendingRequestCount(maxPendingRequestCount)
+            , m_isCommitting(false)
+            , m_isStopping(false)
+            , m_seed(Random::engine()())
+            , m_thread(&GAWorker::run, this)
+        {
+        }
+
+        GAWorker(const GAWorker &) = delete;
+        GAWorker & operator=(const GAWorker &) = delete;
+
+        // Destructor (pending requests are discarded)
+        virtual ~GAWorker()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_requestMutex);
+                m_isStopping = true;
+            }
+            m_requestCondition.notify_all();
+            m_thread.join();
+        }
+
+        // Queue a GA request for the action set
+        // (Call ActionSet::prepareGA() before this)
+        void request(const ActionSet & actionSet, const std::vector<type> & situation, uint64_t timeStamp)
+        {
+            Request request{ std::vector<ClassifierPtr>(actionSet.begin(), actionSet.end()), situation, timeStamp };
+            {
+                std::lock_guard<std::mutex> lock(m_requestMutex);
+                m_requests.push_back(std::move(request));
+            }
+            m_requestCondition.notify_all();
+        }
+
+        // Block while the request queue is full
+        // (Do not call this while holding the population mutex)
+        void throttle()
+        {
+            std::unique_lock<std::mutex> lock(m_requestMutex);
+            m_requestCondition.wait(lock, [this]{ return m_requests.size() < m_maxPendingRequestCount; });
+        }
+
+        // Wait until all the queued requests are committed
+        // (Do not call this while holding the population mutex)
+        void flush()
+        {
+            std::unique_lock<std::mutex> lock(m_requestMutex);
+            m_requestCondition.wait(lock, [this]{ return m_requests.empty() && !m_isCommitting; });
+        }
+
+        std::size_t pendingRequestCount()
+        {
+            std::lock_guard<std::mutex> lock(m_requestMutex);
+            return m_requests.size() + (m_isCommitting ? 1 : 0);
+        }
+    };
+
+}}
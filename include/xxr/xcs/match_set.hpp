@@ -1,9 +1,14 @@
 ﻿#pragma once
 
 #include <memory>
-#include <unordered_map>
+#include <vector>
+#include <algorithm>
 #include <cstdint>
 
+#include "../profiler.hpp"
+#include "../memory_usage.hpp"
+#include "../experiment_stats.hpp"
+
 namespace xxr { namespace xcs_impl
 {
 
@@ -22,18 +27,43 @@ namespace xxr { namespace xcs_impl
         using ClassifierPtrSetType = typename Population::ClassifierPtrSetType;
         using PopulationType = Population;
         using typename ClassifierPtrSetType::ClassifierPtr;
+        using ActionMask = typename ActionRegistry<ActionType>::ActionMask;
 
     protected:
         using Population::ClassifierPtrSetType::m_pConstants;
-        using Population::ClassifierPtrSetType::m_availableActions;
+        using Population::ClassifierPtrSetType::m_pActionRegistry;
         using Population::ClassifierPtrSetType::m_set;
 
         bool m_isCoveringPerformed;
 
+        // The actions of the classifiers in the match set
+        ActionMask m_selectedActions;
+
+        // The sums of prediction * fitness and fitness for each action index
+        // (accumulated while forming the match set and used for the prediction array)
+        std::vector<double> m_predictionFitnessSums;
+        std::vector<double> m_fitnessSums;
+
+        void clearSums()
+        {
+            m_selectedActions.reset();
+            std::fill(m_predictionFitnessSums.begin(), m_predictionFitnessSums.end(), 0.0);
+            std::fill(m_fitnessSums.begin(), m_fitnessSums.end(), 0.0);
+        }
+
+        void insertAndAccumulate(const ClassifierPtr & cl)
+        {
+            const std::size_t actionIdx = m_pActionRegistry->indexOf(cl->action);
+            m_set.insert(cl);
+            m_selectedActions.set(actionIdx);
+            m_predictionFitnessSums[actionIdx] += cl->prediction * cl->fitness;
+            m_fitnessSums[actionIdx] += cl->fitness;
+        }
+
         // GENERATE COVERING CLASSIFIER
-        virtual ClassifierPtr generateCoveringClassifier(const std::vector<type> & situation, const std::unordered_set<ActionType> & unselectedActions, uint64_t timeStamp) const
+        virtual ClassifierPtr generateCoveringClassifier(const std::vector<type> & situation, const ActionMask & unselectedActions, uint64_t timeStamp) const
         {
-            auto cl = std::make_shared<StoredClassifierType>(situation, Random::chooseFrom(unselectedActions), timeStamp, m_pConstants);
+            auto cl = std::make_shared<StoredClassifierType>(situation, m_pActionRegistry->chooseRandom(unselectedActions), timeStamp, m_pConstants);
             cl->condition.setDontCareAtRandom(m_pConstants->dontCareProbability);
 
             return cl;
@@ -41,11 +71,16 @@ namespace xxr { namespace xcs_impl
 
     public:
         // Constructor
-        using ClassifierPtrSetType::ClassifierPtrSetType;
-
-        MatchSet(Population & population, const std::vector<type> & situation, uint64_t timeStamp, const ConstantsType *pConstants, const std::unordered_set<ActionType> & availableActions)
-            : ClassifierPtrSetType(pConstants, availableActions)
+        MatchSet(const ConstantsType *pConstants, const ActionRegistry<ActionType> *pActionRegistry)
+            : ClassifierPtrSetType(pConstants, pActionRegistry)
             , m_isCoveringPerformed(false)
+            , m_predictionFitnessSums(pActionRegistry->size(), 0.0)
+            , m_fitnessSums(pActionRegistry->size(), 0.0)
+        {
+        }
+
+        MatchSet(Population & population, const std::vector<type> & situation, uint64_t timeStamp, const ConstantsType *pConstants, const ActionRegistry<ActionType> *pActionRegistry)
+            : MatchSet(pConstants, pActionRegistry)
         {
             regenerate(population, situation, timeStamp);
         }
@@ -53,31 +88,44 @@ namespace xxr { namespace xcs_impl
         // Destructor
         virtual ~MatchSet() = default;
 
+        // The heap bytes of the buffers of the sums for the prediction array (see MemoryUsage)
+        std::size_t bufferBytes() const noexcept
+        {
+            return MemoryUsage::allocationBytes(m_predictionFitnessSums.capacity() * sizeof(double))
+                + MemoryUsage::allocationBytes(m_fitnessSums.capacity() * sizeof(double));
+        }
+
         // GENERATE MATCH SET
         virtual void regenerate(Population & population, const std::vector<type> & situation, uint64_t timeStamp)
         {
-            // Set theta_mna (the minimal number of actions) to the number of action choices if theta_mna is 0
-            auto thetaMna = (m_pConstants->thetaMna == 0) ? m_availableActions.size() : m_pConstants->thetaMna;
+            XXR_PROFILE_SCOPE(MATCHING);
 
-            auto unselectedActions = m_availableActions;
+            // Set theta_mna (the minimal number of actions) to the number of action choices if theta_mna is 0
+            auto thetaMna = (m_pConstants->thetaMna == 0) ? m_pActionRegistry->size() : m_pConstants->thetaMna;
 
             m_set.clear();
 
+            ExperimentStats & stats = population.stats();
+            bool isCovered = false;
             while (m_set.empty())
             {
+                clearSums();
                 for (auto && cl : population)
                 {
                     if (cl->condition.matches(situation))
                     {
-                        m_set.insert(cl);
-                        unselectedActions.erase(cl->action);
+                        insertAndAccumulate(cl);
                     }
                 }
+                stats.testedClassifierCount += population.size();
+                stats.matchedClassifierCount += m_set.size();
 
                 // Generate classifiers covering the unselected actions
-                if (m_availableActions.size() - unselectedActions.size() < thetaMna)
+                if (m_selectedActions.count() < thetaMna)
                 {
-                    auto coveringClassifier = generateCoveringClassifier(situation, unselectedActions, timeStamp);
+                    XXR_PROFILE_SCOPE(COVERING);
+
+                    auto coveringClassifier = generateCoveringClassifier(situation, m_pActionRegistry->fullMask() & ~m_selectedActions, timeStamp);
                     if (!coveringClassifier->condition.matches(situation))
                     {
                         std::cerr <<
@@ -91,15 +139,58 @@ namespace xxr { namespace xcs_impl
                         assert(false);
                     }
                     population.insert(coveringClassifier);
+                    ++stats.coveringClassifierCount;
                     population.deleteExtraClassifiers();
                     m_set.clear();
                     m_isCoveringPerformed = true;
+                    isCovered = true;
                 }
                 else
                 {
                     m_isCoveringPerformed = false;
                 }
             }
+
+            if (isCovered)
+            {
+                ++stats.coveringCount;
+            }
+            stats.recordMatchSetSize(m_set.size());
+        }
+
+        // GENERATE MATCH SET WITHOUT COVERING (the match set may be empty)
+        virtual void regenerateWithoutCovering(const Population & population, const std::vector<type> & situation)
+        {
+            XXR_PROFILE_SCOPE(MATCHING);
+
+            m_set.clear();
+            clearSums();
+            for (auto && cl : population)
+            {
+                if (cl->condition.matches(situation))
+                {
+                    insertAndAccumulate(cl);
+                }
+            }
+            m_isCoveringPerformed = false;
+        }
+
+        // The actions of the classifiers in the match set
+        const ActionMask & selectedActions() const noexcept
+        {
+            return m_selectedActions;
+        }
+
+        // The sums of prediction * fitness for each action index
+        const std::vector<double> & predictionFitnessSums() const noexcept
+        {
+            return m_predictionFitnessSums;
+        }
+
+        // The sums of fitness for each action index
+        const std::vector<double> & fitnessSums() const noexcept
+        {
+            return m_fitnessSums;
         }
 
         // Get if covering is performed in the previous match set generation
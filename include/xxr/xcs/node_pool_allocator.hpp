@@ -0,0 +1,171 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <cstddef>
+
+namespace xxr { namespace xcs_impl
+{
+
+    // Free list of the nodes of a node-based container (e.g. std::set)
+    //   The nodes freed by the container are kept and given back to the next insertions, so a
+    //   container cleared and refilled in every step allocates only while it grows beyond the
+    //   largest size so far. The nodes of one size (the first size freed) are kept, and the
+    //   other blocks are passed through to the global operator new/delete.
+    class NodePool
+    {
+    private:
+        struct FreeNode
+        {
+            FreeNode *next;
+        };
+
+        FreeNode *m_freeList;
+        std::size_t m_nodeBytes;
+        std::size_t m_freeNodeCount;
+
+    public:
+        // Constructor
+        NodePool() noexcept
+            : m_freeList(nullptr)
+            , m_nodeBytes(0)
+            , m_freeNodeCount(0)
+        {
+        }
+
+        NodePool(const NodePool &) = delete;
+        NodePool & operator=(const NodePool &) = delete;
+
+        // Destructor
+        ~NodePool()
+        {
+            while (m_freeList != nullptr)
+            {
+                FreeNode *node = m_freeList;
+                m_freeList = node->next;
+                ::operator delete(node);
+            }
+        }
+
+        void *allocate(std::size_t bytes)
+        {
+            if (bytes == m_nodeBytes && m_freeList != nullptr)
+            {
+                FreeNode *node = m_freeList;
+                m_freeList = node->next;
+                --m_freeNodeCount;
+                return node;
+            }
+            return ::operator new(bytes);
+        }
+
+        void deallocate(void *p, std::size_t bytes) noexcept
+        {
+            if (m_nodeBytes == 0 && bytes >= sizeof(FreeNode))
+            {
+                m_nodeBytes = bytes;
+            }
+
+            if (bytes == m_nodeBytes)
+            {
+                m_freeList = new (p) FreeNode{ m_freeList };
+                ++m_freeNodeCount;
+            }
+            else
+            {
+                ::operator delete(p);
+            }
+        }
+
+        // The number of the nodes kept for reuse
+        std::size_t freeNodeCount() const noexcept
+        {
+            return m_freeNodeCount;
+        }
+    };
+
+    // Allocator of a container with its own NodePool
+    //   A copy-constructed container gets a new pool, and the pool moves together with the
+    //   nodes on move assignment and swap, so a pool is used only by one container (under the
+    //   same synchronization as the container itself).
+    template <typename T>
+    class NodePoolAllocator
+    {
+        template <typename U>
+        friend class NodePoolAllocator;
+
+    private:
+        std::shared_ptr<NodePool> m_pool;
+
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        // Constructor
+        NodePoolAllocator()
+            : m_pool(std::make_shared<NodePool>())
+        {
+        }
+
+        // (A moved-from container keeps the pool as well, so the move is a copy)
+        NodePoolAllocator(const NodePoolAllocator & obj) noexcept
+            : m_pool(obj.m_pool)
+        {
+        }
+
+        NodePoolAllocator & operator=(const NodePoolAllocator &) = default;
+
+        template <typename U>
+        NodePoolAllocator(const NodePoolAllocator<U> & obj) noexcept
+            : m_pool(obj.m_pool)
+        {
+        }
+
+        NodePoolAllocator select_on_container_copy_construction() const
+        {
+            return NodePoolAllocator();
+        }
+
+        T *allocate(std::size_t n)
+        {
+            if (n == 1)
+            {
+                return static_cast<T *>(m_pool->allocate(sizeof(T)));
+            }
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T *p, std::size_t n) noexcept
+        {
+            if (n == 1)
+            {
+                m_pool->deallocate(p, sizeof(T));
+            }
+            else
+            {
+                ::operator delete(p);
+            }
+        }
+
+        const NodePool & pool() const noexcept
+        {
+            return *m_pool;
+        }
+
+        template <typename U>
+        friend bool operator== (const NodePoolAllocator & lhs, const NodePoolAllocator<U> & rhs) noexcept
+        {
+            return &lhs.pool() == &rhs.pool();
+        }
+
+        template <typename U>
+        friend bool operator!= (const NodePoolAllocator & lhs, const NodePoolAllocator<U> & rhs) noexcept
+        {
+            return &lhs.pool() != &rhs.pool();
+        }
+    };
+
+}}
@@ -1,6 +1,14 @@
 #pragma once
 
+#include <vector>
+#include <memory>
+#include <cstdint>
+
 #include "../random.hpp"
+#include "../experiment_stats.hpp"
+#include "../profiler.hpp"
+#include "../memory_usage.hpp"
+#include "../helper/population_journal.hpp"
 
 namespace xxr { namespace xcs_impl
 {
@@ -23,7 +31,40 @@ namespace xxr { namespace xcs_impl
     protected:
         using ClassifierPtrSet::m_set;
         using ClassifierPtrSet::m_pConstants;
-        using ClassifierPtrSet::m_availableActions;
+        using ClassifierPtrSet::m_pActionRegistry;
+
+        // The journal of the changes (nullptr if not recorded)
+        PopulationJournal::Writer *m_pJournalWriter = nullptr;
+
+        // The counters of the events (updated by [P], [M], [A] and GA while holding [P])
+        ExperimentStats m_stats;
+
+        // Scratch buffers for subsume() and deleteExtraClassifiers() (kept to avoid allocation in every step)
+        std::vector<uint64_t> m_removedIds;
+        std::vector<const ClassifierPtr *> m_deletionTargets;
+        std::vector<double> m_deletionVotes;
+        std::vector<double> m_rouletteWheel;
+
+        void writeNumerosityToJournal(const ClassifierPtr & cl)
+        {
+            if (m_pJournalWriter != nullptr)
+            {
+                m_pJournalWriter->writeNumerosity(cl->id, cl->numerosity);
+            }
+        }
+
+        // Returns the classifier with the same condition and action in [P] (nullptr if not exists)
+        const ClassifierPtr *findIdentical(const ConditionActionPairType & cl) const
+        {
+            for (auto && c : m_set)
+            {
+                if (c->condition == cl.condition && c->action == cl.action)
+                {
+                    return &c;
+                }
+            }
+            return nullptr;
+        }
 
         // DELETION VOTE
         virtual double deletionVote(const ClassifierType & cl, double averageFitness) const
@@ -46,23 +87,200 @@ namespace xxr { namespace xcs_impl
         // Destructor
         virtual ~Population() = default;
 
+        // The heap bytes of the scratch buffers (see MemoryUsage)
+        std::size_t bufferBytes() const noexcept
+        {
+            return MemoryUsage::allocationBytes(m_removedIds.capacity() * sizeof(uint64_t))
+                + MemoryUsage::allocationBytes(m_deletionTargets.capacity() * sizeof(const ClassifierPtr *))
+                + MemoryUsage::allocationBytes(m_deletionVotes.capacity() * sizeof(double))
+                + MemoryUsage::allocationBytes(m_rouletteWheel.capacity() * sizeof(double));
+        }
+
+        // Record the changes to the journal from now on (nullptr to stop recording)
+        //   The writer must outlive the recording.
+        void setJournalWriter(PopulationJournal::Writer *pJournalWriter) noexcept
+        {
+            m_pJournalWriter = pJournalWriter;
+        }
+
+        PopulationJournal::Writer *journalWriter() const noexcept
+        {
+            return m_pJournalWriter;
+        }
+
+        ExperimentStats & stats() noexcept
+        {
+            return m_stats;
+        }
+
+        const ExperimentStats & stats() const noexcept
+        {
+            return m_stats;
+        }
+
+        // The modifiers below hide the ones of ClassifierPtrSet to record the changes to the journal
+
+        auto insert(const ClassifierPtr & cl)
+        {
+            auto result = ClassifierPtrSet::insert(cl);
+            if (m_pJournalWriter != nullptr && result.second)
+            {
+                m_pJournalWriter->writeInsertion(*cl);
+            }
+            return result;
+        }
+
+        auto emplace(const ClassifierPtr & cl)
+        {
+            return insert(cl);
+        }
+
+        auto erase(const ClassifierPtr & cl)
+        {
+            const uint64_t id = cl->id;
+            auto count = m_set.erase(cl);
+            if (m_pJournalWriter != nullptr && count > 0)
+            {
+                m_pJournalWriter->writeDeletion(id);
+            }
+            return count;
+        }
+
+        void clear()
+        {
+            m_set.clear();
+            if (m_pJournalWriter != nullptr)
+            {
+                m_pJournalWriter->writeClear();
+            }
+        }
+
+        // Increment the numerosity of the classifier in [P] (used by GA subsumption)
+        virtual void incrementNumerosity(const ClassifierPtr & cl)
+        {
+            ++cl->numerosity;
+            writeNumerosityToJournal(cl);
+        }
+
+        // Absorb the numerosity of the classifiers into the subsumer and remove them from [P]
+        // (used by action set subsumption)
+        virtual void subsume(const ClassifierPtr & subsumer, const std::vector<ClassifierPtr> & subsumedClassifiers)
+        {
+            std::vector<uint64_t> & removedIds = m_removedIds;
+            removedIds.clear();
+            for (auto && cl : subsumedClassifiers)
+            {
+                subsumer->numerosity += cl->numerosity;
+                if (m_set.erase(cl) > 0)
+                {
+                    removedIds.push_back(cl->id);
+                }
+            }
+
+            if (!removedIds.empty())
+            {
+                ++m_stats.actionSetSubsumptionCount;
+                m_stats.actionSetSubsumedClassifierCount += removedIds.size();
+            }
+
+            if (m_pJournalWriter != nullptr)
+            {
+                // The action set may contain classifiers already deleted from [P]
+                if (m_set.count(subsumer))
+                {
+                    m_pJournalWriter->writeSubsumption(subsumer->id, subsumer->numerosity, removedIds);
+                }
+                else
+                {
+                    for (uint64_t id : removedIds)
+                    {
+                        m_pJournalWriter->writeDeletion(id);
+                    }
+                }
+            }
+        }
+
+        // Record the parameters of the action set updated by ActionSet::update()
+        void recordParameterUpdate(const ClassifierPtrSet & actionSet)
+        {
+            if (m_pJournalWriter != nullptr)
+            {
+                m_pJournalWriter->writeUpdate(actionSet, *this);
+            }
+        }
+
+        // Record the time stamps of the action set updated by ActionSet::prepareGA()
+        void recordTimeStampUpdate(const ClassifierPtrSet & actionSet, uint64_t timeStamp)
+        {
+            if (m_pJournalWriter != nullptr)
+            {
+                m_pJournalWriter->writeTimeStamp(actionSet, *this, timeStamp);
+            }
+        }
+
         // INSERT IN POPULATION
-        virtual void insertOrIncrementNumerosity(const ClassifierPtr & cl)
+        //   Returns true if the classifier is inserted as a new macroclassifier.
+        virtual bool insertOrIncrementNumerosity(const ClassifierPtr & cl)
         {
+            if (const ClassifierPtr *identical = findIdentical(*cl))
+            {
+                ++(*identical)->numerosity;
+                writeNumerosityToJournal(*identical);
+                return false;
+            }
+            this->insert(cl);
+            return true;
+        }
+
+        // INSERT IN POPULATION (the stored classifier is created only if inserted)
+        virtual bool insertOrIncrementNumerosity(const ClassifierType & cl)
+        {
+            if (const ClassifierPtr *identical = findIdentical(cl))
+            {
+                ++(*identical)->numerosity;
+                writeNumerosityToJournal(*identical);
+                return false;
+            }
+            this->insert(std::make_shared<StoredClassifierType>(cl, m_pConstants));
+            return true;
+        }
+
+        // MERGE INTO POPULATION (used to merge the populations of the island model)
+        //   The classifier is absorbed by a subsuming classifier or an identical
+        //   classifier if exists, and otherwise inserted as is.
+        virtual void merge(const ClassifierPtr & cl)
+        {
+            std::vector<const ClassifierPtr *> subsumers;
             for (auto && c : m_set)
             {
-                if (c->condition == cl->condition && c->action == cl->action)
+                if (c->subsumes(*cl))
                 {
-                    ++c->numerosity;
-                    return;
+                    subsumers.push_back(&c);
                 }
             }
-            m_set.insert(cl);
+
+            if (!subsumers.empty())
+            {
+                auto & subsumer = *Random::chooseFrom(subsumers);
+                subsumer->numerosity += cl->numerosity;
+                writeNumerosityToJournal(subsumer);
+                return;
+            }
+
+            if (const ClassifierPtr *identical = findIdentical(*cl))
+            {
+                (*identical)->numerosity += cl->numerosity;
+                writeNumerosityToJournal(*identical);
+                return;
+            }
+            this->insert(cl);
         }
 
         // DELETE FROM POPULATION
         virtual bool deleteExtraClassifiers()
         {
+            XXR_PROFILE_SCOPE(DELETION);
+
             uint64_t numerositySum = 0;
             double fitnessSum = 0.0;
             for (auto && c : m_set)
@@ -80,29 +298,33 @@ namespace xxr { namespace xcs_impl
             // The average fitness in the population
             double averageFitness = fitnessSum / numerositySum;
 
-            std::vector<const ClassifierPtr *> targets;
+            std::vector<const ClassifierPtr *> & targets = m_deletionTargets;
+            targets.clear();
             for (auto && cl : m_set)
             {
                 targets.push_back(&cl);
             }
 
             // Roulette-wheel selection
-            std::vector<double> votes;
-            votes.reserve(targets.size());
+            std::vector<double> & votes = m_deletionVotes;
+            votes.clear();
             for (auto && target : targets)
             {
                 votes.push_back(deletionVote(**target, averageFitness));
             }
-            std::size_t selectedIdx = Random::rouletteWheelSelection(votes);
+            std::size_t selectedIdx = Random::rouletteWheelSelection(votes, m_rouletteWheel);
 
             // Distrust the selected classifier
             if ((*targets[selectedIdx])->numerosity > 1)
             {
                 (*targets[selectedIdx])->numerosity--;
+                writeNumerosityToJournal(*targets[selectedIdx]);
+                ++m_stats.numerosityDecrementCount;
             }
             else
             {
-                m_set.erase(*targets[selectedIdx]);
+                this->erase(*targets[selectedIdx]);
+                ++m_stats.deletedClassifierCount;
             }
 
             return (numerositySum - 1) > m_pConstants->n;
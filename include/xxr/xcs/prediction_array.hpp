@@ -2,11 +2,15 @@
 
 #include <memory>
 #include <vector>
-#include <unordered_map>
+#include <array>
 #include <random>
 #include <limits>
 #include <cfloat>
 #include <cmath>
+#include <cstddef>
+
+#include "action_registry.hpp"
+#include "../profiler.hpp"
 
 namespace xxr { namespace xcs_impl
 {
@@ -28,57 +32,63 @@ namespace xxr { namespace xcs_impl
         using PopulationType = typename MatchSet::PopulationType;
         using MatchSetType = MatchSet;
 
+        using ActionMask = typename ActionRegistry<ActionType>::ActionMask;
+
     protected:
         const ConstantsType * const m_pConstants;
 
-        // PA (Prediction Array)
-        std::unordered_map<ActionType, double> m_pa;
+        const ActionRegistry<ActionType> * const m_pActionRegistry;
+
+        // PA (Prediction Array) over the action indices (fixed size to avoid allocation)
+        std::array<double, ActionRegistry<ActionType>::kMaxActionCount> m_pa;
 
-        // Array of PA keys (for random action selection)
-        std::vector<ActionType> m_paActions;
+        // The actions in PA (for random action selection)
+        ActionMask m_paActions;
 
         // The maximum value of PA
         double m_maxPA;
 
         // The best actions of PA
-        std::vector<ActionType> m_maxPAActions;
+        ActionMask m_maxPAActions;
 
     public:
         // GENERATE PREDICTION ARRAY
+        //   The sums of prediction * fitness and fitness are accumulated while forming the match set.
         AbstractPredictionArray(const MatchSet & matchSet, const ConstantsType *pConstants)
             : m_pConstants(pConstants)
+            , m_pActionRegistry(matchSet.actionRegistry())
+            , m_paActions(matchSet.selectedActions())
+            , m_maxPA(-100000.0)
         {
+            XXR_PROFILE_SCOPE(PREDICTION_ARRAY);
+
             // FSA (Fitness Sum Array)
-            std::unordered_map<ActionType, double> fsa;
+            const std::vector<double> & fsa = matchSet.fitnessSums();
 
-            for (auto && cl : matchSet)
+            const std::vector<double> & predictionFitnessSums = matchSet.predictionFitnessSums();
+            const std::size_t actionCount = predictionFitnessSums.size();
+            for (std::size_t i = 0; i < actionCount; ++i)
             {
-                if (m_pa.count(cl->action) == 0) {
-                    m_paActions.push_back(cl->action);
-                }
-                m_pa[cl->action] += cl->prediction * cl->fitness;
-                fsa[cl->action] += cl->fitness;
+                m_pa[i] = (std::abs(fsa[i]) > 0.0) ? predictionFitnessSums[i] / fsa[i] : predictionFitnessSums[i];
             }
 
-            m_maxPA = -100000.0;
-
-            for (auto && pair : m_pa)
+            for (std::size_t i = 0; i < actionCount; ++i)
             {
-                if (std::abs(fsa[pair.first]) > 0.0)
+                if (!m_paActions.test(i))
                 {
-                    pair.second /= fsa[pair.first];
+                    continue;
                 }
 
                 // Update the best actions
-                if (std::abs(m_maxPA - pair.second) < DBL_EPSILON) // m_maxPA == pair.second
+                if (std::abs(m_maxPA - m_pa[i]) < DBL_EPSILON) // m_maxPA == m_pa[i]
                 {
-                    m_maxPAActions.push_back(pair.first);
+                    m_maxPAActions.set(i);
                 }
-                else if (m_maxPA < pair.second)
+                else if (m_maxPA < m_pa[i])
                 {
-                    m_maxPAActions.clear();
-                    m_maxPAActions.push_back(pair.first);
-                    m_maxPA = pair.second;
+                    m_maxPAActions.reset();
+                    m_maxPAActions.set(i);
+                    m_maxPA = m_pa[i];
                 }
             }
         }
@@ -94,7 +104,13 @@ namespace xxr { namespace xcs_impl
 
         virtual double predictionFor(ActionType action) const
         {
-            return m_pa.count(action) ? m_pa.at(action) : m_pConstants->initialPrediction;
+            return predictionAt(m_pActionRegistry->indexOf(action));
+        }
+
+        // Get the prediction value of the action index of the action registry
+        virtual double predictionAt(std::size_t actionIdx) const
+        {
+            return m_paActions.test(actionIdx) ? m_pa[actionIdx] : m_pConstants->initialPrediction;
         }
 
         // SELECT ACTION
@@ -117,6 +133,7 @@ namespace xxr { namespace xcs_impl
         using typename AbstractPredictionArray<MatchSet>::PopulationType;
 
     private:
+        using AbstractPredictionArray<MatchSet>::m_pActionRegistry;
         using AbstractPredictionArray<MatchSet>::m_maxPAActions;
 
     public:
@@ -126,8 +143,8 @@ namespace xxr { namespace xcs_impl
         ActionType selectAction() const override
         {
             // Choose best action
-            assert(!m_maxPAActions.empty());
-            return Random::chooseFrom(m_maxPAActions);
+            assert(m_maxPAActions.any());
+            return m_pActionRegistry->chooseRandom(m_maxPAActions);
         }
     };
 
@@ -147,6 +164,7 @@ namespace xxr { namespace xcs_impl
 
     private:
         const double m_epsilon;
+        using AbstractPredictionArray<MatchSet>::m_pActionRegistry;
         using AbstractPredictionArray<MatchSet>::m_paActions;
         using AbstractPredictionArray<MatchSet>::m_maxPAActions;
 
@@ -159,13 +177,13 @@ namespace xxr { namespace xcs_impl
         {
             if (Random::nextDouble() < m_epsilon)
             {
-                assert(!m_paActions.empty());
-                return Random::chooseFrom(m_paActions); // Choose random action
+                assert(m_paActions.any());
+                return m_pActionRegistry->chooseRandom(m_paActions); // Choose random action
             }
             else
             {
-                assert(!m_maxPAActions.empty());
-                return Random::chooseFrom(m_maxPAActions); // Choose best action
+                assert(m_maxPAActions.any());
+                return m_pActionRegistry->chooseRandom(m_maxPAActions); // Choose best action
             }
         }
     };
@@ -3,10 +3,16 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <limits>
+#include <type_traits>
+#include <cstring>
 #include <cstdlib>
 #include <cstdint>
+#include <cstddef>
 #include <cassert>
 
+#include "../helper/text_format.hpp"
+
 namespace xxr { namespace xcs_impl
 {
 
@@ -72,6 +78,23 @@ namespace xxr { namespace xcs_impl
                 return std::to_string(value());
         }
 
+        // Append toString() to the string (used for the population CSV, the precision is not used)
+        void appendTo(std::string & str, int precision = 0) const
+        {
+            if (m_isDontCare)
+            {
+                str.push_back('#');
+            }
+            else if (std::is_integral<T>::value)
+            {
+                TextFormat::appendValue(str, static_cast<long long>(m_value));
+            }
+            else
+            {
+                str += std::to_string(m_value);
+            }
+        }
+
         friend bool operator== (const Symbol<T> & lhs, const Symbol<T> & rhs)
         {
             return lhs.isDontCare() == rhs.isDontCare() && (lhs.isDontCare() || lhs.value() == rhs.value());
@@ -99,6 +122,31 @@ namespace xxr { namespace xcs_impl
         {
             m_isDontCare = true;
         }
+
+        // Binary representation for the population snapshot
+        //   int32 value (INT32_MIN for "don't care")
+        static constexpr uint32_t binaryKind() noexcept
+        {
+            return 1;
+        }
+
+        static constexpr std::size_t binarySize() noexcept
+        {
+            return sizeof(int32_t);
+        }
+
+        void writeBinary(unsigned char *data) const
+        {
+            const int32_t value = m_isDontCare ? std::numeric_limits<int32_t>::min() : static_cast<int32_t>(m_value);
+            std::memcpy(data, &value, sizeof(value));
+        }
+
+        static Symbol<T> readBinary(const unsigned char *data)
+        {
+            int32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return (value == std::numeric_limits<int32_t>::min()) ? Symbol<T>() : Symbol<T>(static_cast<T>(value));
+        }
     };
 
 }}
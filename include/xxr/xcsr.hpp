@@ -7,7 +7,11 @@
 #include "environment/rotated_checkerboard_environment.hpp"
 #include "environment/function_environment.hpp"
 #include "environment/dataset_environment.hpp"
+#include "environment/streaming_dataset_environment.hpp"
+#include "environment/binary_dataset_environment.hpp"
 #include "environment/csv_environment.hpp"
+#include "environment/recording_environment.hpp"
+#include "environment/replay_environment.hpp"
 
 namespace xxr
 {
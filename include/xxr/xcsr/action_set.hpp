@@ -25,11 +25,14 @@ namespace xxr { namespace xcsr_impl
     protected:
         using xcs_impl::ActionSet<GA>::m_set;
         using xcs_impl::ActionSet<GA>::m_pConstants;
-        using xcs_impl::ActionSet<GA>::m_availableActions;
+        using xcs_impl::ActionSet<GA>::m_pActionRegistry;
+        using xcs_impl::ActionSet<GA>::m_subsumedClassifiers;
 
         // DO ACTION SET SUBSUMPTION
         virtual void doSubsumption(PopulationType & population) override
         {
+            XXR_PROFILE_SCOPE(SUBSUMPTION);
+
             ClassifierPtr cl;
 
             for (auto && c : m_set)
@@ -45,34 +48,35 @@ namespace xxr { namespace xcsr_impl
 
             if (cl.get() != nullptr)
             {
-                std::vector<ClassifierPtr> removedClassifiers;
+                std::vector<ClassifierPtr> & removedClassifiers = m_subsumedClassifiers;
+                removedClassifiers.clear();
                 for (auto && c : m_set)
                 {
                     if (cl->isMoreGeneral(*c, m_pConstants->subsumptionTolerance))
                     {
-                        cl->numerosity += c->numerosity;
                         removedClassifiers.push_back(c);
                     }
                 }
 
+                population.subsume(cl, removedClassifiers);
                 for (auto && removedClassifier : removedClassifiers)
                 {
-                    population.erase(removedClassifier);
                     m_set.erase(removedClassifier);
                 }
+                removedClassifiers.clear();
             }
         }
 
     public:
         // Constructor
-        ActionSet(const ConstantsType *pConstants, const std::unordered_set<ActionType> & availableActions) :
-            xcs_impl::ActionSet<GA>(pConstants, availableActions)
+        ActionSet(const ConstantsType *pConstants, const xcs_impl::ActionRegistry<ActionType> *pActionRegistry) :
+            xcs_impl::ActionSet<GA>(pConstants, pActionRegistry)
         {
         }
 
         template <class MatchSet>
-        ActionSet(const MatchSet & matchSet, ActionType action, const ConstantsType *pConstants, const std::unordered_set<ActionType> & availableActions) :
-            ActionSet(pConstants, availableActions)
+        ActionSet(const MatchSet & matchSet, ActionType action, const ConstantsType *pConstants, const xcs_impl::ActionRegistry<ActionType> *pActionRegistry) :
+            ActionSet(pConstants, pActionRegistry)
         {
             this->regenerate(matchSet, action);
         }
@@ -141,6 +141,11 @@ namespace xxr { namespace xcsr_impl
         //   prediction and the prediction error of classifiers
         bool useMAM = true;
 
+        // useAsyncGA
+        //   Whether to run the GA (and the following deletion) in a background thread
+        //   (the offspring are applied to the population a few steps later; see GAWorker)
+        bool useAsyncGA = false;
+
         double minValue = 0.0;
 
         double maxValue = 1.0;
@@ -25,7 +25,7 @@ namespace xxr { namespace xcsr_impl { namespace csr
 
     protected:
         using xcsr_impl::GA<Population>::m_pConstants;
-        using xcsr_impl::GA<Population>::m_availableActions;
+        using xcsr_impl::GA<Population>::m_pActionRegistry;
 
         // APPLY CROSSOVER (uniform crossover)
         virtual bool uniformCrossover(ClassifierType & cl1, ClassifierType & cl2) const override
@@ -145,11 +145,11 @@ namespace xxr { namespace xcsr_impl { namespace csr
                 }
             }
 
-            if (m_pConstants->doActionMutation && (Random::nextDouble() < m_pConstants->mu) && (m_availableActions.size() >= 2))
+            if (m_pConstants->doActionMutation && (Random::nextDouble() < m_pConstants->mu) && (m_pActionRegistry->size() >= 2))
             {
-                std::unordered_set<ActionType> otherPossibleActions(m_availableActions);
-                otherPossibleActions.erase(cl.action);
-                cl.action = Random::chooseFrom(otherPossibleActions);
+                auto otherPossibleActions = m_pActionRegistry->fullMask();
+                otherPossibleActions.reset(m_pActionRegistry->indexOf(cl.action));
+                cl.action = m_pActionRegistry->chooseRandom(otherPossibleActions);
             }
         }
 
@@ -4,6 +4,9 @@
 #include <sstream>
 #include <iomanip>
 #include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
 
 namespace xxr { namespace xcsr_impl { namespace csr
 {
@@ -29,6 +32,11 @@ namespace xxr { namespace xcsr_impl { namespace csr
             return stream.str();
         }
 
+        void appendTo(std::string & str, int precision = 0) const
+        {
+            this->appendPair(str, center, spread, precision);
+        }
+
         friend bool operator== (const Symbol & lhs, const Symbol & rhs)
         {
             return lhs.center == rhs.center && lhs.spread == rhs.spread;
@@ -55,6 +63,33 @@ namespace xxr { namespace xcsr_impl { namespace csr
         {
             return center + spread;
         }
+
+        // Binary representation for the population snapshot
+        //   (center, spread)
+        static constexpr uint32_t binaryKind() noexcept
+        {
+            return 2;
+        }
+
+        static constexpr std::size_t binarySize() noexcept
+        {
+            return sizeof(T) * 2;
+        }
+
+        void writeBinary(unsigned char *data) const
+        {
+            std::memcpy(data, &center, sizeof(T));
+            std::memcpy(data + sizeof(T), &spread, sizeof(T));
+        }
+
+        static Symbol readBinary(const unsigned char *data)
+        {
+            T center;
+            T spread;
+            std::memcpy(&center, data, sizeof(T));
+            std::memcpy(&spread, data + sizeof(T), sizeof(T));
+            return Symbol(center, spread);
+        }
     };
 
 }}}
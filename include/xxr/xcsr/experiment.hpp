@@ -103,12 +103,70 @@ namespace xxr { namespace xcsr_impl
             m_experiment->setPopulation(classifiers, initTimeStamp);
         }
 
-        virtual void dumpPopulation(std::ostream & os) const override
+        virtual void dumpPopulation(std::ostream & os, const PopulationCSV::Format & format = PopulationCSV::Format()) const override
         {
-            m_experiment->dumpPopulation(os);
+            m_experiment->dumpPopulation(os, format);
         }
 
-        virtual std::size_t populationSize() const noexcept override
+        virtual void loadPopulationBinary(const std::string & filename, bool useAsInitialPopulation = true) override
+        {
+            m_experiment->loadPopulationBinary(filename, useAsInitialPopulation);
+        }
+
+        virtual void dumpPopulationBinary(std::ostream & os) const override
+        {
+            m_experiment->dumpPopulationBinary(os);
+        }
+
+        virtual void saveCheckpoint(Checkpoint::Writer & writer) const override
+        {
+            m_experiment->saveCheckpoint(writer);
+        }
+
+        virtual void loadCheckpoint(Checkpoint::Reader & reader) override
+        {
+            m_experiment->loadCheckpoint(reader);
+        }
+
+        virtual void startJournal(std::ostream & os) override
+        {
+            m_experiment->startJournal(os);
+        }
+
+        virtual void stopJournal() override
+        {
+            m_experiment->stopJournal();
+        }
+
+        virtual void flushJournal() override
+        {
+            m_experiment->flushJournal();
+        }
+
+        // Call func with the experiment of the chosen representation
+        template <class Func>
+        void visit(Func && func)
+        {
+            switch (m_repr)
+            {
+            case Repr::CSR:
+                func(static_cast<csr::Experiment<T, Action> &>(*m_experiment));
+                break;
+
+            case Repr::OBR:
+                func(static_cast<obr::Experiment<T, Action> &>(*m_experiment));
+                break;
+
+            case Repr::UBR:
+                func(static_cast<ubr::Experiment<T, Action> &>(*m_experiment));
+                break;
+
+            default:
+                assert(false);
+            }
+        }
+
+        virtual std::size_t populationSize() const override
         {
             return m_experiment->populationSize();
         }
@@ -118,7 +176,19 @@ namespace xxr { namespace xcsr_impl
             return m_experiment->numerositySum();
         }
 
-        virtual void switchToCondensationMode() noexcept override
+        virtual ExperimentStats stats() const override
+        {
+            return m_experiment->stats();
+        }
+
+        virtual MemoryUsage memoryUsage() const override
+        {
+            MemoryUsage usage = m_experiment->memoryUsage();
+            usage.otherBytes += MemoryUsage::allocationBytes(sizeof(*this));
+            return usage;
+        }
+
+        virtual void switchToCondensationMode() override
         {
             m_experiment->switchToCondensationMode();
         }
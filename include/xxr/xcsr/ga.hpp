@@ -23,7 +23,7 @@ namespace xxr { namespace xcsr_impl
 
     protected:
         using xcs_impl::GA<Population>::m_pConstants;
-        using xcs_impl::GA<Population>::m_availableActions;
+        using xcs_impl::GA<Population>::m_pActionRegistry;
         using xcs_impl::GA<Population>::uniformCrossover;
         using xcs_impl::GA<Population>::onePointCrossover;
         using xcs_impl::GA<Population>::twoPointCrossover;
@@ -94,54 +94,23 @@ namespace xxr { namespace xcsr_impl { namespace obr
 
         using xcs_impl::Experiment<T, Action, PredictionArray, ActionSet>::setPopulation;
 
-        virtual void dumpPopulation(std::ostream & os) const override
+        virtual void dumpPopulation(std::ostream & os, const PopulationCSV::Format & format = PopulationCSV::Format()) const override
         {
+            this->flushGA();
+            auto lock = this->lockPopulation();
+
             os  << "Condition[" << constants.minValue << "-" << constants.maxValue << "],"
                 << "Condition[l;u],Action,prediction,epsilon,F,exp,ts,as,n,acc" << std::endl;
 
-            for (auto && cl : this->m_population)
-            {
-                for (auto && symbol : cl->condition)
-                {
-                    os << "|";
-
-                    auto normalizedLowerLimit = (symbol.lower() - constants.minValue) / (constants.maxValue - constants.minValue);
-                    auto normalizedUpperLimit = (symbol.upper() - constants.minValue) / (constants.maxValue - constants.minValue);
-
-                    for (int i = 0; i < 10; ++i)
-                    {
-                        if (normalizedLowerLimit < i / 10.0 && (i + 1) / 10.0 < normalizedUpperLimit)
-                        {
-                            os << "O";
-                        }
-                        else if ((i / 10.0 <= normalizedLowerLimit && normalizedLowerLimit <= (i + 1) / 10.0)
-                            || (i / 10.0 <= normalizedUpperLimit && normalizedUpperLimit <= (i + 1) / 10.0))
-                        {
-                            os << "o";
-                        }
-                        else
-                        {
-                            os << ".";
-                        }
-                    }
-                }
-                os << "|" << ",";
-
-                os  << cl->condition << ","
-                    << cl->action << ","
-                    << cl->prediction << ","
-                    << cl->epsilon << ","
-                    << cl->fitness << ","
-                    << cl->experience << ","
-                    << cl->timeStamp << ","
-                    << cl->actionSetSize << ","
-                    << cl->numerosity << ","
-                    << cl->accuracy() << std::endl;
-            }
+            PopulationCSV::writeRows(os, this->m_population, format.threadCount, [this, &format](std::string & str, const StoredClassifierType & cl) {
+                PopulationCSV::appendIntervalGraph(str, cl.condition, constants.minValue, constants.maxValue);
+                PopulationCSV::appendClassifier(str, cl, format.precision);
+            });
         }
 
-        virtual void switchToCondensationMode() noexcept override
+        virtual void switchToCondensationMode() override
         {
+            auto lock = this->lockPopulation();
             constants.chi = 0.0;
             constants.mu = 0.0;
             constants.subsumptionTolerance = 0.0;
@@ -20,14 +20,15 @@ namespace xxr { namespace xcsr_impl { namespace obr
         using typename xcs_impl::MatchSet<Population>::ClassifierPtr;
         using typename xcs_impl::MatchSet<Population>::ClassifierPtrSetType;
         using typename xcs_impl::MatchSet<Population>::PopulationType;
+        using typename xcs_impl::MatchSet<Population>::ActionMask;
 
     protected:
         using xcs_impl::MatchSet<Population>::m_set;
         using xcs_impl::MatchSet<Population>::m_pConstants;
-        using xcs_impl::MatchSet<Population>::m_availableActions;
+        using xcs_impl::MatchSet<Population>::m_pActionRegistry;
 
         // GENERATE COVERING CLASSIFIER
-        virtual ClassifierPtr generateCoveringClassifier(const std::vector<type> & situation, const std::unordered_set<ActionType> & unselectedActions, uint64_t timeStamp) const override
+        virtual ClassifierPtr generateCoveringClassifier(const std::vector<type> & situation, const ActionMask & unselectedActions, uint64_t timeStamp) const override
         {
             std::vector<SymbolType> symbols;
             for (auto && symbol : situation)
@@ -51,18 +52,18 @@ namespace xxr { namespace xcsr_impl { namespace obr
                 symbols.emplace_back(lower, upper);
             }
 
-            return std::make_shared<StoredClassifierType>(symbols, Random::chooseFrom(unselectedActions), timeStamp, m_pConstants);
+            return std::make_shared<StoredClassifierType>(symbols, m_pActionRegistry->chooseRandom(unselectedActions), timeStamp, m_pConstants);
         }
 
     public:
         // Constructor
-        MatchSet(const ConstantsType *pConstants, const std::unordered_set<ActionType> & availableActions)
-            : xcs_impl::MatchSet<Population>(pConstants, availableActions)
+        MatchSet(const ConstantsType *pConstants, const xcs_impl::ActionRegistry<ActionType> *pActionRegistry)
+            : xcs_impl::MatchSet<Population>(pConstants, pActionRegistry)
         {
         }
 
-        MatchSet(Population & population, const std::vector<type> & situation, uint64_t timeStamp, const ConstantsType *pConstants, const std::unordered_set<ActionType> & availableActions)
-            : MatchSet(pConstants, availableActions)
+        MatchSet(Population & population, const std::vector<type> & situation, uint64_t timeStamp, const ConstantsType *pConstants, const xcs_impl::ActionRegistry<ActionType> *pActionRegistry)
+            : MatchSet(pConstants, pActionRegistry)
         {
             this->regenerate(population, situation, timeStamp);
         }
@@ -4,6 +4,9 @@
 #include <sstream>
 #include <iomanip>
 #include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
 #include <limits>
 
 namespace xxr { namespace xcsr_impl { namespace obr
@@ -31,6 +34,11 @@ namespace xxr { namespace xcsr_impl { namespace obr
             return stream.str();
         }
 
+        void appendTo(std::string & str, int precision = 0) const
+        {
+            this->appendPair(str, l, u, precision);
+        }
+
         friend bool operator== (const Symbol & lhs, const Symbol & rhs)
         {
             return lhs.l == rhs.l && lhs.u == rhs.u;
@@ -57,6 +65,33 @@ namespace xxr { namespace xcsr_impl { namespace obr
         {
             return u;
         }
+
+        // Binary representation for the population snapshot
+        //   (l, u)
+        static constexpr uint32_t binaryKind() noexcept
+        {
+            return 3;
+        }
+
+        static constexpr std::size_t binarySize() noexcept
+        {
+            return sizeof(T) * 2;
+        }
+
+        void writeBinary(unsigned char *data) const
+        {
+            std::memcpy(data, &l, sizeof(T));
+            std::memcpy(data + sizeof(T), &u, sizeof(T));
+        }
+
+        static Symbol readBinary(const unsigned char *data)
+        {
+            T l;
+            T u;
+            std::memcpy(&l, data, sizeof(T));
+            std::memcpy(&u, data + sizeof(T), sizeof(T));
+            return Symbol(l, u);
+        }
     };
 
 }}}
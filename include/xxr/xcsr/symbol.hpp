@@ -1,6 +1,9 @@
 #pragma once
 
+#include <string>
+
 #include "../xcs/symbol.hpp"
+#include "../helper/text_format.hpp"
 
 namespace xxr { namespace xcsr_impl
 {
@@ -9,6 +12,21 @@ namespace xxr { namespace xcsr_impl
     template <typename T>
     class AbstractSymbol : public xcs_impl::AbstractSymbol<T>
     {
+    protected:
+        // Append "first;second " as toString() of the symbols does (used for the population CSV)
+        //   precision: the significant digits (0: 3 digits as toString())
+        static void appendPair(std::string & str, T first, T second, int precision)
+        {
+            if (precision == 0)
+            {
+                precision = 3;
+            }
+            TextFormat::appendValue(str, first, precision);
+            str.push_back(';');
+            TextFormat::appendValue(str, second, precision);
+            str.push_back(' ');
+        }
+
     public:
         // Destructor
         virtual ~AbstractSymbol() = default;
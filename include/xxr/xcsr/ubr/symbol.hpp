@@ -4,6 +4,9 @@
 #include <sstream>
 #include <iomanip>
 #include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
 #include <limits>
 
 namespace xxr { namespace xcsr_impl { namespace ubr
@@ -31,6 +34,11 @@ namespace xxr { namespace xcsr_impl { namespace ubr
             return stream.str();
         }
 
+        void appendTo(std::string & str, int precision = 0) const
+        {
+            this->appendPair(str, p, q, precision);
+        }
+
         friend bool operator== (const Symbol & lhs, const Symbol & rhs)
         {
             return lhs.p == rhs.p && lhs.q == rhs.q;
@@ -64,6 +72,33 @@ namespace xxr { namespace xcsr_impl { namespace ubr
         {
             return std::max(p, q);
         }
+
+        // Binary representation for the population snapshot
+        //   (p, q)
+        static constexpr uint32_t binaryKind() noexcept
+        {
+            return 4;
+        }
+
+        static constexpr std::size_t binarySize() noexcept
+        {
+            return sizeof(T) * 2;
+        }
+
+        void writeBinary(unsigned char *data) const
+        {
+            std::memcpy(data, &p, sizeof(T));
+            std::memcpy(data + sizeof(T), &q, sizeof(T));
+        }
+
+        static Symbol readBinary(const unsigned char *data)
+        {
+            T p;
+            T q;
+            std::memcpy(&p, data, sizeof(T));
+            std::memcpy(&q, data + sizeof(T), sizeof(T));
+            return Symbol(p, q);
+        }
     };
 
 }}}
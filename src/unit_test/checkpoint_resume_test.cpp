@@ -0,0 +1,141 @@
+// Resumption from the checkpoints
+//   An experiment is interrupted after its checkpoint (the logs already have the rows of a few
+//   more iterations), resumed from the checkpoint with the same log files, and the logs and the
+//   populations are compared with the ones of the uninterrupted run. The moving averages of the
+//   logs span the checkpoint, and the summary log has the event counters of the experiments.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstddef>
+#include <xxr/xcs.hpp>
+#include <xxr/helper/experiment_helper.hpp>
+#include <xxr/helper/island_experiment_helper.hpp>
+
+#include "unit_test.hpp"
+
+using namespace xxr;
+
+namespace
+{
+
+    constexpr std::size_t kSeedCount = 3;
+    constexpr std::size_t kIterationCount = 4000;
+    constexpr std::size_t kCheckpointIteration = 2000;
+    constexpr std::size_t kInterruptedIterationCount = 2500;
+    constexpr std::size_t kSmaWidth = 300;
+
+    const std::vector<std::string> kLogFilenames = { "summary.csv", "reward.csv", "error.csv", "step.csv", "popsize.csv" };
+
+    std::string readFile(const std::string & filename)
+    {
+        std::ifstream ifs(filename, std::ios::binary);
+        std::ostringstream oss;
+        oss << ifs.rdbuf();
+        return oss.str();
+    }
+
+    // Run the helper until the given iteration (resumed from the checkpoint if inputCheckpointFilename is given)
+    //   and return the populations of the experiments
+    template <class Helper>
+    std::string run(const std::string & prefix, std::size_t iterationCount, const std::string & inputCheckpointFilename)
+    {
+        ExperimentSettings settings;
+        settings.seedCount = kSeedCount;
+        settings.summaryInterval = 500;
+        settings.outputFilenamePrefix = prefix;
+        settings.outputSummaryFilename = kLogFilenames[0];
+        settings.outputStatsInSummary = true;
+        settings.outputRewardFilename = kLogFilenames[1];
+        settings.outputSystemErrorFilename = kLogFilenames[2];
+        settings.outputStepCountFilename = kLogFilenames[3];
+        settings.outputPopulationSizeFilename = kLogFilenames[4];
+        settings.smaWidth = kSmaWidth;
+        settings.migrationInterval = 300;
+        settings.inputCheckpointFilename = inputCheckpointFilename;
+        settings.outputCheckpointFilename = inputCheckpointFilename.empty() ? "checkpoint.bin" : "";
+        settings.checkpointInterval = inputCheckpointFilename.empty() ? kCheckpointIteration : 0;
+
+        XCSConstants constants;
+        constants.n = 400;
+
+        std::vector<std::unique_ptr<MultiplexerEnvironment>> explorationEnvironments;
+        std::vector<std::unique_ptr<MultiplexerEnvironment>> exploitationEnvironments;
+        for (std::size_t i = 0; i < kSeedCount; ++i)
+        {
+            explorationEnvironments.push_back(std::make_unique<MultiplexerEnvironment>(11));
+            exploitationEnvironments.push_back(std::make_unique<MultiplexerEnvironment>(11));
+        }
+
+        Helper helper(settings, constants, std::move(explorationEnvironments), std::move(exploitationEnvironments));
+        helper.runIteration(iterationCount - helper.iterationCount());
+        helper.waitForCheckpoint();
+        helper.flushLogs();
+
+        std::ostringstream oss;
+        for (std::size_t i = 0; i < kSeedCount; ++i)
+        {
+            helper.dumpPopulation(i, oss);
+        }
+        return oss.str();
+    }
+
+    template <class Helper>
+    void testResume(const std::string & name)
+    {
+        const std::string fullPrefix = "xxr-checkpoint-test-full-";
+        const std::string resumedPrefix = "xxr-checkpoint-test-resumed-";
+
+        Random::seed(1);
+        const std::string fullPopulations = run<Helper>(fullPrefix, kIterationCount, "");
+
+        // Interrupt after the checkpoint and resume with another seed (the random engines are restored from the checkpoint)
+        Random::seed(1);
+        run<Helper>(resumedPrefix, kInterruptedIterationCount, "");
+        std::size_t interruptedLineCount = 0;
+        {
+            std::ifstream ifs(resumedPrefix + kLogFilenames[1]);
+            std::string line;
+            while (std::getline(ifs, line))
+            {
+                ++interruptedLineCount;
+            }
+        }
+        Random::seed(2);
+        const std::string resumedPopulations = run<Helper>(resumedPrefix, kIterationCount, resumedPrefix + "checkpoint.bin");
+
+        expect(name + ": the interrupted run has the rows after the checkpoint", interruptedLineCount == kInterruptedIterationCount - kSmaWidth + 1);
+        expect(name + ": the resumed populations are identical to the uninterrupted run", !fullPopulations.empty() && resumedPopulations == fullPopulations);
+        for (auto && filename : kLogFilenames)
+        {
+            const std::string fullLog = readFile(fullPrefix + filename);
+            const std::string resumedLog = readFile(resumedPrefix + filename);
+            expect(name + ": the resumed " + filename + " is identical to the uninterrupted run", !fullLog.empty() && resumedLog == fullLog);
+        }
+
+        for (auto && filename : kLogFilenames)
+        {
+            std::remove((fullPrefix + filename).c_str());
+            std::remove((resumedPrefix + filename).c_str());
+        }
+        std::remove((fullPrefix + "checkpoint.bin").c_str());
+        std::remove((resumedPrefix + "checkpoint.bin").c_str());
+    }
+
+}
+
+int main()
+{
+    std::cout << "XCS (11-bit multiplexer):" << std::endl;
+    testResume<ExperimentHelper<XCS<bool, bool>, MultiplexerEnvironment>>("XCS");
+
+    hr();
+
+    std::cout << "XCS (11-bit multiplexer, island model):" << std::endl;
+    testResume<IslandExperimentHelper<XCS<bool, bool>, MultiplexerEnvironment>>("XCS islands");
+
+    return testStatus ? 0 : 1;
+}
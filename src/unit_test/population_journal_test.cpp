@@ -0,0 +1,222 @@
+// Round trip of the population journal
+//   A journal is recorded while the learners run (GA, subsumption, deletion and a replaced
+//   population), replayed onto the classifiers of [P] when it was started, and the result is
+//   compared field by field with the final [P]. The journal is also replayed in two parts
+//   split inside a record, as a reader following a growing file does.
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <xxr/xcs.hpp>
+#include <xxr/xcsr.hpp>
+
+#include "unit_test.hpp"
+
+using namespace xxr;
+
+namespace
+{
+
+    constexpr uint64_t kWarmUpStepCount = 2000;
+    constexpr uint64_t kJournalStepCount = 5000;
+
+    // The answer of the multiplexer problem (the address bits come first)
+    template <typename T>
+    int multiplexerAnswer(const std::vector<T> & situation, std::size_t addressBitLength)
+    {
+        std::size_t address = 0;
+        for (std::size_t i = 0; i < addressBitLength; ++i)
+        {
+            address = (address << 1) + (situation[i] > 0.5 ? 1 : 0);
+        }
+        return situation[addressBitLength + address] > 0.5 ? 1 : 0;
+    }
+
+    // The offsets and the kinds of the records in the journal
+    std::vector<std::pair<std::size_t, uint32_t>> scanRecords(const std::string & journal)
+    {
+        std::vector<std::pair<std::size_t, uint32_t>> records;
+        std::size_t offset = sizeof(PopulationJournal::Header);
+        while (offset + sizeof(PopulationJournal::RecordHeader) <= journal.size())
+        {
+            PopulationJournal::RecordHeader recordHeader;
+            std::memcpy(&recordHeader, journal.data() + offset, sizeof(recordHeader));
+            records.emplace_back(offset, recordHeader.kind);
+            offset += sizeof(recordHeader) + recordHeader.size;
+        }
+        return records;
+    }
+
+    template <class Classifier, class Population>
+    bool isSamePopulation(const std::vector<Classifier> & classifiers, const Population & population)
+    {
+        if (classifiers.size() != population.size())
+        {
+            return false;
+        }
+
+        auto it = classifiers.begin();
+        for (auto && cl : population)
+        {
+            if (!(it->condition == cl->condition)
+                || it->action != cl->action
+                || it->prediction != cl->prediction
+                || it->epsilon != cl->epsilon
+                || it->fitness != cl->fitness
+                || it->actionSetSize != cl->actionSetSize
+                || it->experience != cl->experience
+                || it->timeStamp != cl->timeStamp
+                || it->numerosity != cl->numerosity)
+            {
+                return false;
+            }
+            ++it;
+        }
+        return true;
+    }
+
+    template <class Experiment, typename T>
+    void testRoundTrip(const std::string & name, Experiment & experiment, const std::vector<std::vector<T>> & situations, std::size_t addressBitLength)
+    {
+        using ClassifierType = typename Experiment::ClassifierType;
+
+        const auto step = [&]() {
+            const auto & situation = situations[Random::nextInt<std::size_t>(0, situations.size() - 1)];
+            const int action = experiment.explore(situation);
+            experiment.reward((action == multiplexerAnswer(situation, addressBitLength)) ? 1000.0 : 0.0);
+            experiment.exploit(situation);
+        };
+
+        for (uint64_t i = 0; i < kWarmUpStepCount; ++i)
+        {
+            step();
+        }
+
+        // The base classifiers (in the order of [P])
+        std::vector<ClassifierType> baseClassifiers;
+        for (auto && cl : experiment.population())
+        {
+            baseClassifiers.emplace_back(*cl);
+        }
+
+        std::stringstream journalStream;
+        experiment.startJournal(journalStream);
+        for (uint64_t i = 0; i < kJournalStepCount; ++i)
+        {
+            step();
+
+            // Replace the population once (CLEAR and the insertions of the new classifiers)
+            if (i == kJournalStepCount / 2)
+            {
+                std::vector<ClassifierType> classifiers;
+                for (auto && cl : experiment.population())
+                {
+                    classifiers.emplace_back(*cl);
+                }
+                experiment.setPopulation(classifiers, false);
+            }
+        }
+        experiment.stopJournal();
+        const std::string journal = journalStream.str();
+
+        const auto records = scanRecords(journal);
+        std::map<uint32_t, std::size_t> kindCounts;
+        for (auto && record : records)
+        {
+            ++kindCounts[record.second];
+        }
+        bool hasAllKinds = true;
+        for (auto kind : { PopulationJournal::RecordKind::BASE, PopulationJournal::RecordKind::INSERTION, PopulationJournal::RecordKind::NUMEROSITY,
+                           PopulationJournal::RecordKind::DELETION, PopulationJournal::RecordKind::SUBSUMPTION, PopulationJournal::RecordKind::UPDATE,
+                           PopulationJournal::RecordKind::TIME_STAMP, PopulationJournal::RecordKind::CLEAR })
+        {
+            if (kindCounts[static_cast<uint32_t>(kind)] == 0)
+            {
+                std::cout << "  (no record of kind " << static_cast<uint32_t>(kind) << ")" << std::endl;
+                hasAllKinds = false;
+            }
+        }
+        expect(name + ": the journal has all the record kinds", hasAllKinds);
+
+        {
+            PopulationJournal::Replayer<ClassifierType> replayer(baseClassifiers);
+            std::istringstream iss(journal);
+            const std::size_t appliedCount = replayer.replay(iss);
+            expect(name + ": all the records are replayed", appliedCount == records.size() && replayer.recordCount() == records.size());
+            expect(name + ": the replayed population is identical to [P]", isSamePopulation(replayer.classifiers(), experiment.population()));
+        }
+
+        // Split inside the record header and inside the payload of the last record
+        const std::size_t lastRecordOffset = records.back().first;
+        for (std::size_t splitOffset : { lastRecordOffset + sizeof(PopulationJournal::RecordHeader) / 2, lastRecordOffset + sizeof(PopulationJournal::RecordHeader) + 1 })
+        {
+            const std::string splitName = name + " (split at " + std::to_string(splitOffset - lastRecordOffset) + " bytes into the last record)";
+
+            PopulationJournal::Replayer<ClassifierType> replayer(baseClassifiers);
+            std::stringstream ss;
+            ss.write(journal.data(), splitOffset);
+            const std::size_t firstAppliedCount = replayer.replay(ss);
+            expect(splitName + ": the truncated record is not applied", firstAppliedCount == records.size() - 1);
+            expect(splitName + ": the stream is rewound to the truncated record", static_cast<std::size_t>(ss.tellg()) == lastRecordOffset);
+
+            ss.write(journal.data() + splitOffset, journal.size() - splitOffset);
+            const std::size_t secondAppliedCount = replayer.replay(ss);
+            expect(splitName + ": the rest is applied after the file grows", secondAppliedCount == 1 && replayer.recordCount() == records.size());
+            expect(splitName + ": the replayed population is identical to [P]", isSamePopulation(replayer.classifiers(), experiment.population()));
+        }
+    }
+
+}
+
+int main()
+{
+    Random::seed(1);
+
+    std::cout << "XCS (6-bit multiplexer):" << std::endl;
+    {
+        std::vector<std::vector<int>> situations;
+        for (int i = 0; i < 64; ++i)
+        {
+            std::vector<int> situation;
+            for (int j = 5; j >= 0; --j)
+            {
+                situation.push_back((i >> j) & 1);
+            }
+            situations.push_back(situation);
+        }
+
+        XCSConstants constants;
+        constants.n = 400;
+        XCS<int, int> experiment({ 0, 1 }, constants);
+        testRoundTrip("XCS", experiment, situations, 2);
+    }
+
+    hr();
+
+    std::cout << "XCSR (6-bit real multiplexer, CSR):" << std::endl;
+    {
+        std::vector<std::vector<double>> situations;
+        for (int i = 0; i < 256; ++i)
+        {
+            std::vector<double> situation;
+            for (int j = 0; j < 6; ++j)
+            {
+                situation.push_back(Random::nextDouble());
+            }
+            situations.push_back(situation);
+        }
+
+        XCSRConstants constants;
+        constants.n = 800;
+        XCSR<double, int> experiment({ 0, 1 }, constants, CSR);
+        experiment.visit([&](auto & experimentImpl) {
+            testRoundTrip("XCSR", experimentImpl, situations, 2);
+        });
+    }
+
+    return testStatus ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+// Allocation-free steady state of the learners
+//   The global operator new is replaced by the counting hook of MemoryAccounting, and the
+//   allocations in explore(), reward() and exploit() of warmed-up learners are counted.
+//   The steps that created classifiers (covering or new offspring) may allocate them and are
+//   excluded. The steps are measured in the normal mode (GA with crossover and mutation, and
+//   the offspring subsumed or merged into the existing classifiers) and then in the
+//   condensation mode.
+//   The estimated footprint of memoryUsage() is also compared with the bytes allocated by the
+//   learners (including the nodes kept in the free lists of the classifier sets).
+#ifndef XXR_ENABLE_MEMORY_ACCOUNTING
+#define XXR_ENABLE_MEMORY_ACCOUNTING
+#endif
+#define XXR_MEMORY_ACCOUNTING_IMPLEMENTATION
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <xxr/xcs.hpp>
+#include <xxr/xcsr.hpp>
+
+#include "unit_test.hpp"
+
+using namespace xxr;
+
+namespace
+{
+
+    constexpr uint64_t kWarmUpStepCount = 50000;
+    constexpr uint64_t kCondensationStepCount = 10000;
+    constexpr uint64_t kStepCount = 100000;
+
+    // The minimum number of the measured steps (the steps without new classifiers) in each mode
+    constexpr uint64_t kMinMeasuredStepCount = kStepCount / 2;
+
+    // The answer of the multiplexer problem (the address bits come first)
+    template <typename T>
+    int multiplexerAnswer(const std::vector<T> & situation, std::size_t addressBitLength)
+    {
+        std::size_t address = 0;
+        for (std::size_t i = 0; i < addressBitLength; ++i)
+        {
+            address = (address << 1) + (situation[i] > 0.5 ? 1 : 0);
+        }
+        return situation[addressBitLength + address] > 0.5 ? 1 : 0;
+    }
+
+    template <typename T>
+    void testSteadyState(const std::string & name, AbstractExperiment<T, int> & experiment, int64_t experimentLiveBytes, const std::vector<std::vector<T>> & situations, std::size_t addressBitLength)
+    {
+        std::vector<int> answers;
+        for (auto && situation : situations)
+        {
+            answers.push_back(multiplexerAnswer(situation, addressBitLength));
+        }
+
+        const auto step = [&]() {
+            const std::size_t idx = Random::nextInt<std::size_t>(0, situations.size() - 1);
+            const int action = experiment.explore(situations[idx]);
+            experiment.reward((action == answers[idx]) ? 1000.0 : 0.0);
+            experiment.exploit(situations[idx]);
+        };
+
+        // Count the allocations in the steps without new classifiers
+        const auto measureSteps = [&](const std::string & modeName) {
+            uint64_t allocationCount = 0;
+            uint64_t measuredStepCount = 0;
+            for (uint64_t i = 0; i < kStepCount; ++i)
+            {
+                const ExperimentStats stats = experiment.stats();
+                const uint64_t baseAllocationCount = MemoryAccounting::threadCounter().allocationCount;
+
+                step();
+
+                const uint64_t stepAllocationCount = MemoryAccounting::threadCounter().allocationCount - baseAllocationCount;
+                const ExperimentStats newStats = experiment.stats();
+                if (newStats.coveringClassifierCount == stats.coveringClassifierCount && newStats.insertedChildCount == stats.insertedChildCount)
+                {
+                    ++measuredStepCount;
+                    allocationCount += stepAllocationCount;
+                }
+            }
+
+            std::cout << "  (" << modeName << ": " << measuredStepCount << " steps without new classifiers, population size: " << experiment.populationSize() << ")" << std::endl;
+            expect(name + " (" + modeName + "): no allocation in the steps without new classifiers", allocationCount == 0);
+            expect(name + " (" + modeName + "): the steps without new classifiers are measured", measuredStepCount >= kMinMeasuredStepCount);
+        };
+
+        for (uint64_t i = 0; i < kWarmUpStepCount; ++i)
+        {
+            step();
+        }
+        measureSteps("normal mode");
+
+        experiment.switchToCondensationMode();
+        for (uint64_t i = 0; i < kCondensationStepCount; ++i)
+        {
+            step();
+        }
+        measureSteps("condensation mode");
+
+        // (the answers are allocated after the experiment)
+        const MemoryUsage usage = experiment.memoryUsage();
+        const int64_t liveBytes = MemoryAccounting::threadCounter().liveBytes - experimentLiveBytes - static_cast<int64_t>(answers.capacity() * sizeof(int));
+        std::cout << "  (estimated footprint: " << usage.totalBytes() << " bytes, allocated: " << liveBytes << " bytes, free nodes: " << usage.freeNodeBytes << " bytes, [M]: " << usage.matchSetBytes << " bytes)" << std::endl;
+        expect(name + ": the free nodes of the classifier sets are counted", usage.freeNodeBytes > 0);
+        expect(name + ": the match set is counted", usage.matchSetBytes > 0);
+        expect(name + ": the estimated footprint covers the allocated bytes", static_cast<int64_t>(usage.totalBytes()) >= liveBytes);
+    }
+
+}
+
+int main()
+{
+    Random::seed(1);
+
+    std::cout << "XCS (6-bit multiplexer):" << std::endl;
+    {
+        std::vector<std::vector<int>> situations;
+        for (int i = 0; i < 64; ++i)
+        {
+            std::vector<int> situation;
+            for (int j = 5; j >= 0; --j)
+            {
+                situation.push_back((i >> j) & 1);
+            }
+            situations.push_back(situation);
+        }
+
+        XCSConstants constants;
+        constants.n = 400;
+        const int64_t baseLiveBytes = MemoryAccounting::threadCounter().liveBytes;
+        XCS<int, int> experiment({ 0, 1 }, constants);
+        testSteadyState<int>("XCS", experiment, baseLiveBytes, situations, 2);
+    }
+
+    hr();
+
+    std::cout << "XCSR (6-bit real multiplexer, CSR):" << std::endl;
+    {
+        std::vector<std::vector<double>> situations;
+        for (int i = 0; i < 256; ++i)
+        {
+            std::vector<double> situation;
+            for (int j = 0; j < 6; ++j)
+            {
+                situation.push_back(Random::nextDouble());
+            }
+            situations.push_back(situation);
+        }
+
+        XCSRConstants constants;
+        constants.n = 800;
+        const int64_t baseLiveBytes = MemoryAccounting::threadCounter().liveBytes;
+        XCSR<double, int> experiment({ 0, 1 }, constants, CSR);
+        testSteadyState<double>("XCSR", experiment, baseLiveBytes, situations, 2);
+    }
+
+    return testStatus ? 0 : 1;
+}
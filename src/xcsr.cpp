@@ -1,4 +1,5 @@
 #define __USE_MINGW_ANSI_STDIO 0
+#define XXR_MEMORY_ACCOUNTING_IMPLEMENTATION // replaces operator new/delete if built with XXR_ENABLE_MEMORY_ACCOUNTING
 #include <iostream>
 #include <sstream>
 #include <memory>
@@ -8,11 +9,35 @@
 
 #include <xxr/xcsr.hpp>
 #include <xxr/helper/experiment_helper.hpp>
+#include <xxr/helper/island_experiment_helper.hpp>
+#include <xxr/helper/batch_estimator.hpp>
 #include <cxxopts.hpp>
 
 using namespace xxr;
 using namespace xxr::xcsr_impl;
 
+// (Exits if the input population or checkpoint cannot be loaded)
+template <class Experiment, class Environment, class... Args>
+std::unique_ptr<AbstractExperimentHelper> makeExperimentHelper(bool useIslandModel, Args && ... args)
+{
+    try
+    {
+        if (useIslandModel)
+        {
+            return std::make_unique<IslandExperimentHelper<Experiment, Environment>>(std::forward<Args>(args)...);
+        }
+        else
+        {
+            return std::make_unique<ExperimentHelper<Experiment, Environment>>(std::forward<Args>(args)...);
+        }
+    }
+    catch (std::exception & e)
+    {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
 int main(int argc, char *argv[])
 {
     xcsr_impl::Constants constants;
@@ -26,25 +51,51 @@ int main(int argc, char *argv[])
         ("summary-interval", "The iteration interval of summary log output", cxxopts::value<uint64_t>()->default_value("5000"), "COUNT")
         ("p,prefix", "The filename prefix for log file output", cxxopts::value<std::string>()->default_value(""), "PREFIX")
         ("S,soutput", "The filename of summary log csv output", cxxopts::value<std::string>()->default_value("summary.csv"), "FILENAME")
+        ("summary-stats", "Whether to append the event counters (e.g. the classifiers tested in matching, GA invocations, subsumptions and deletions) to the summary log csv output", cxxopts::value<bool>()->default_value("false"), "true/false")
         ("o,coutput", "The filename of classifier csv output", cxxopts::value<std::string>()->default_value("classifier.csv"), "FILENAME")
+        ("coutput-precision", "The number of significant digits of the values in the classifier csv output (\"0\": the default, \"-1\": the digits that restore the same values)", cxxopts::value<int>()->default_value("0"), "DIGITS")
+        ("coutput-threads", "The number of threads formatting the classifier csv output (\"0\": the number of hardware threads)", cxxopts::value<uint64_t>()->default_value("1"), "COUNT")
+        ("coutput-bin", "The filename of classifier binary snapshot output", cxxopts::value<std::string>()->default_value(""), "FILENAME")
+        ("profile", "The filename of the phase profile output of the hot path (\".json\": JSON, otherwise CSV; available only if built with XXR_ENABLE_PROFILER, e.g. \"make PROFILE=1\")", cxxopts::value<std::string>()->default_value(""), "FILENAME")
+        ("perf", "Whether to read the hardware performance counters (cycles, instructions, L1/LLC misses and branch misses) of the phases into the phase profile output (Linux only; requires --profile and XXR_ENABLE_PROFILER)", cxxopts::value<bool>()->default_value("false"), "true/false")
+        ("trace", "The filename of the timeline trace output of the hot path (Chrome trace JSON for chrome://tracing or Perfetto; available only if built with XXR_ENABLE_PROFILER, e.g. \"make PROFILE=1\")", cxxopts::value<std::string>()->default_value(""), "FILENAME")
+        ("trace-from", "The first iteration recorded in the timeline trace (counted from 0)", cxxopts::value<uint64_t>()->default_value("0"), "ITERATION")
+        ("trace-to", "The iteration where the timeline trace ends (not included)", cxxopts::value<uint64_t>()->default_value("1000"), "ITERATION")
+        ("memory-report", "The filename of the memory report csv output (the estimated footprint of each experiment at exit; the peak transient allocation of the steps is measured only if built with XXR_ENABLE_MEMORY_ACCOUNTING, e.g. \"make MEMORY=1\")", cxxopts::value<std::string>()->default_value(""), "FILENAME")
+        ("journal", "The filename of population journal output (the changes of the population recorded from the beginning, which can be replayed onto the initial population)", cxxopts::value<std::string>()->default_value(""), "FILENAME")
         ("r,routput", "The filename of reward log csv output", cxxopts::value<std::string>()->default_value(""), "FILENAME")
         ("E,seoutput", "The filename of system error log csv output", cxxopts::value<std::string>()->default_value(""), "FILENAME")
         ("n,noutput", "The filename of macro-classifier count log csv output", cxxopts::value<std::string>()->default_value(""), "FILENAME")
         //("nsoutput", "The filename of number-of-step log csv output in the multi-step problem", cxxopts::value<std::string>()->default_value(""), "FILENAME")
         ("cinput", "The classifier csv filename for initial population", cxxopts::value<std::string>()->default_value(""), "FILENAME")
-        ("resume", "Whether to use initial classifiers (--cinput) to resume previous experiment (\"false\": initialize p/epsilon/F/exp/ts/as to defaults, \"true\": do not initialize values and set system time stamp to the same as that of the latest classifier)", cxxopts::value<bool>()->default_value("false"), "true/false")
+        ("cinput-bin", "The classifier binary snapshot filename for initial population", cxxopts::value<std::string>()->default_value(""), "FILENAME")
+        ("resume", "Whether to use initial classifiers (--cinput/--cinput-bin) to resume previous experiment (\"false\": initialize p/epsilon/F/exp/ts/as to defaults, \"true\": do not initialize values and set system time stamp to the same as that of the latest classifier)", cxxopts::value<bool>()->default_value("false"), "true/false")
+        ("checkpoint", "The filename of checkpoint output (the complete experiment state written at the end and every --checkpoint-interval iterations)", cxxopts::value<std::string>()->default_value(""), "FILENAME")
+        ("checkpoint-interval", "The iteration interval of checkpoint output (\"0\": only at the end)", cxxopts::value<uint64_t>()->default_value("0"), "COUNT")
+        ("checkpoint-input", "The checkpoint file to resume the experiment from (use the same options as the experiment that wrote it)", cxxopts::value<std::string>()->default_value(""), "FILENAME")
         ("m,mux", "Use the real multiplexer problem", cxxopts::value<int>(), "LENGTH")
         ("chk", "Use the n-dimentional checkerboard problem", cxxopts::value<int>(), "N")
         ("rchk", "Use the n-dimentional 45-degree-rotated checkerboard problem", cxxopts::value<int>(), "N")
         ("chk-div", "The division in the checkerboard problem", cxxopts::value<int>(), "DIVISION")
         ("func", "Use the function problem", cxxopts::value<int>(), "FUNCNO")
         ("func-output-pred", "Output the reward prediction for pixels in the function problem", cxxopts::value<std::string>()->default_value(""), "FILENAME")
-        ("c,csv", "Use the csv file", cxxopts::value<std::string>(), "FILENAME")
+        ("c,csv", "Use the csv file (or the binary dataset converted by xxr-dataset)", cxxopts::value<std::string>(), "FILENAME")
         ("e,csv-eval", "Use the csv file for evaluation", cxxopts::value<std::string>(), "FILENAME")
         ("csv-random", "Whether to choose lines in random order from the csv file", cxxopts::value<bool>()->default_value("true"), "true/false")
+        ("csv-partition", "Whether to partition the lines of the csv file among the islands (used only in exploration)", cxxopts::value<bool>()->default_value("false"), "true/false")
+        ("csv-stream", "Whether to stream the csv files instead of loading them into memory (for large datasets)", cxxopts::value<bool>()->default_value("false"), "true/false")
+        ("csv-stream-buffer", "The number of lines in the buffer of --csv-stream (lines are chosen from the buffer when --csv-random is true)", cxxopts::value<uint64_t>()->default_value("65536"), "COUNT")
+        ("csv-estimate", "The csv file to estimate the outputs", cxxopts::value<std::string>(), "FILENAME")
+        ("csv-output-best", "Output the result of the desired action for the situations in the csv file specified by --csv-estimate", cxxopts::value<std::string>(), "FILENAME")
+        ("csv-output-predictions", "Whether to append the predictions of the actions (in ascending order of the actions) to the lines of --csv-output-best", cxxopts::value<bool>()->default_value("false"), "true/false")
+        ("csv-output-matched", "Whether to append the matched classifiers (the space-separated 0-based indices of the classifier rows in --coutput) to the lines of --csv-output-best", cxxopts::value<bool>()->default_value("false"), "true/false")
+        ("csv-estimate-threads", "The number of threads for --csv-estimate (\"0\": the number of hardware threads)", cxxopts::value<uint64_t>()->default_value("0"), "COUNT")
         ("i,iter", "The number of iterations", cxxopts::value<uint64_t>()->default_value("20000"), "COUNT")
         ("condense-iter", "The number of iterations for the Wilson's rule condensation method (chi=0, mu=0) after normal iterations", cxxopts::value<uint64_t>()->default_value("0"), "COUNT")
         ("avg-seeds", "The number of different random seeds for averaging the reward and the macro-classifier count", cxxopts::value<uint64_t>()->default_value("1"), "COUNT")
+        ("islands", "The number of islands (= experiments with their own populations) trained in parallel threads with the classifier migration", cxxopts::value<uint64_t>()->default_value("1"), "COUNT")
+        ("migrate-interval", "The iteration interval of the classifier migration between islands", cxxopts::value<uint64_t>()->default_value("1000"), "COUNT")
+        ("migrate-count", "The number of the fittest classifiers migrated to the next island at once", cxxopts::value<uint64_t>()->default_value("10"), "COUNT")
         ("explore", "The number of exploration performed in each iteration", cxxopts::value<uint64_t>()->default_value("1"), "COUNT")
         ("exploit", "The number of exploitation (= test mode) performed in each iteration (set \"0\" if you don't need evaluation)", cxxopts::value<uint64_t>()->default_value("1"), "COUNT")
         ("exploit-upd", "Whether to update classifier parameters in test mode (\"auto\": false for single-step & true for multi-step)", cxxopts::value<std::string>()->default_value("auto"), "auto/true/false")
@@ -82,6 +133,7 @@ int main(int argc, char *argv[])
         ("do-range-restriction", "Whether to restrict the range of the condition to the interval [min-value, max-value) in the covering and mutation operator (ignored when --repr=csr)", cxxopts::value<bool>()->default_value(constants.doRangeRestriction ? "true" : "false"), "true/false")
         ("do-covering-random-range-truncation", "Whether to truncate the covering random range before generating random intervals if the interval [x-s_0, x+s_0) is not contained in [min-value, max-value).  \"false\" is common for this option, but the covering operator can generate too many maximum-range intervals if s_0 is larger than (max-value - min-value) / 2.  Choose \"true\" to avoid the random bias in this situation.  (ignored when --repr=csr)", cxxopts::value<bool>()->default_value(constants.doCoveringRandomRangeTruncation ? "true" : "false"), "true/false")
         ("mam", "Whether to use the moyenne adaptive modifee (MAM) for updating the prediction and the prediction error of classifiers", cxxopts::value<bool>()->default_value(constants.useMAM ? "true" : "false"), "true/false")
+        ("async-ga", "Whether to run the GA in a background thread (the offspring are applied to the population a few steps later)", cxxopts::value<bool>()->default_value(constants.useAsyncGA ? "true" : "false"), "true/false")
         ("h,help", "Show this help");
 
     auto result = options.parse(argc, argv);
@@ -145,6 +197,8 @@ int main(int argc, char *argv[])
         constants.doCoveringRandomRangeTruncation = result["do-covering-random-range-truncation"].as<bool>();
     if (result.count("mam"))
         constants.useMAM = result["mam"].as<bool>();
+    if (result.count("async-ga"))
+        constants.useAsyncGA = result["async-ga"].as<bool>();
     if (result.count("blx-alpha"))
         constants.blxAlpha = result["blx-alpha"].as<double>();
 
@@ -257,6 +311,8 @@ int main(int argc, char *argv[])
             ss << "doCoveringRangeTruncation = true" << std::endl;
         if (!constants.useMAM)
             ss << "            useMAM = false" << std::endl;
+        if (constants.useAsyncGA)
+            ss << "        useAsyncGA = true" << std::endl;
         std::string str = ss.str();
         if (!str.empty())
         {
@@ -274,13 +330,97 @@ int main(int argc, char *argv[])
     settings.outputFilenamePrefix = result["prefix"].as<std::string>();
     settings.outputSummaryToStdout = true;
     settings.outputSummaryFilename = result["soutput"].as<std::string>();
+    settings.outputStatsInSummary = result["summary-stats"].as<bool>();
     settings.outputRewardFilename = result["routput"].as<std::string>();
     settings.outputSystemErrorFilename = result["seoutput"].as<std::string>();
     settings.outputPopulationSizeFilename = result["noutput"].as<std::string>();
     //settings.outputStepCountFilename = result["nsoutput"].as<std::string>();
     settings.inputClassifierFilename = result["cinput"].as<std::string>();
+    settings.inputClassifierBinaryFilename = result["cinput-bin"].as<std::string>();
     settings.useInputClassifierToResume = result["resume"].as<bool>();
+    settings.inputCheckpointFilename = result["checkpoint-input"].as<std::string>();
+    settings.outputCheckpointFilename = result["checkpoint"].as<std::string>();
+    settings.checkpointInterval = result["checkpoint-interval"].as<uint64_t>();
+    settings.outputJournalFilename = result["journal"].as<std::string>();
+    settings.outputProfileFilename = result["profile"].as<std::string>();
+    settings.outputTraceFilename = result["trace"].as<std::string>();
+    settings.traceFromIteration = result["trace-from"].as<uint64_t>();
+    settings.traceToIteration = result["trace-to"].as<uint64_t>();
+    settings.outputMemoryReportFilename = result["memory-report"].as<std::string>();
     settings.smaWidth = result["sma"].as<uint64_t>();
+    settings.migrationInterval = result["migrate-interval"].as<uint64_t>();
+    settings.migrationCount = result["migrate-count"].as<uint64_t>();
+
+    if (!settings.inputClassifierFilename.empty() && !settings.inputClassifierBinaryFilename.empty())
+    {
+        std::cerr << "Error: --cinput and --cinput-bin cannot be used at the same time." << std::endl;
+        exit(1);
+    }
+
+    if (!settings.inputCheckpointFilename.empty() && (!settings.inputClassifierFilename.empty() || !settings.inputClassifierBinaryFilename.empty()))
+    {
+        std::cerr << "Error: --checkpoint-input cannot be used with --cinput or --cinput-bin." << std::endl;
+        exit(1);
+    }
+
+    if ((!settings.inputCheckpointFilename.empty() || !settings.outputCheckpointFilename.empty()) && result["csv-stream"].as<bool>())
+    {
+        std::cerr << "Error: --checkpoint and --checkpoint-input cannot be used with --csv-stream (the streamed csv files cannot be saved in checkpoints)." << std::endl;
+        exit(1);
+    }
+
+    if ((!settings.inputCheckpointFilename.empty() || !settings.outputCheckpointFilename.empty()) && constants.useAsyncGA)
+    {
+        std::cerr << "Error: --checkpoint and --checkpoint-input cannot be used with --async-ga (the offspring of the background GA depend on the timing of the threads)." << std::endl;
+        exit(1);
+    }
+
+    if (!settings.outputProfileFilename.empty() && !Profiler::kEnabled)
+    {
+        std::cerr << "Warning: The phase profile (--profile) is empty since xxr is built without XXR_ENABLE_PROFILER (e.g. \"make PROFILE=1\")." << std::endl;
+    }
+
+    if (result["perf"].as<bool>())
+    {
+        PerfCounters::enable();
+        std::string unavailableCounters;
+        for (std::size_t i = 0; i < PerfCounters::kCounterCount; ++i)
+        {
+            if (!PerfCounters::isAvailable(static_cast<PerfCounters::Counter>(i)))
+            {
+                unavailableCounters += std::string(unavailableCounters.empty() ? "" : ", ") + PerfCounters::counterName(static_cast<PerfCounters::Counter>(i));
+            }
+        }
+        if (!unavailableCounters.empty())
+        {
+            std::cerr << "Warning: The hardware performance counters are not available (" << unavailableCounters << "; see perf_event_paranoid)." << std::endl;
+        }
+    }
+
+    if (!settings.outputTraceFilename.empty())
+    {
+        if (settings.traceFromIteration >= settings.traceToIteration)
+        {
+            std::cerr << "Error: --trace-from must be less than --trace-to." << std::endl;
+            exit(1);
+        }
+        if (!Tracer::kEnabled)
+        {
+            std::cerr << "Warning: The timeline trace (--trace) is empty since xxr is built without XXR_ENABLE_PROFILER (e.g. \"make PROFILE=1\")." << std::endl;
+        }
+    }
+
+    // Use island model
+    const bool useIslandModel = (result["islands"].as<uint64_t>() > 1);
+    if (useIslandModel)
+    {
+        if (settings.seedCount > 1)
+        {
+            std::cerr << "Error: The island model (--islands) cannot be used with --avg-seeds." << std::endl;
+            exit(1);
+        }
+        settings.seedCount = result["islands"].as<uint64_t>();
+    }
 
     xxr::XCSRRepr repr;
     {
@@ -317,7 +457,8 @@ int main(int argc, char *argv[])
             exploitationEnvironments.push_back(std::make_unique<RealMultiplexerEnvironment>(result["mux"].as<int>(), true));
         }
 
-        experimentHelper = std::make_unique<ExperimentHelper<XCSR<double, bool>, RealMultiplexerEnvironment>>(
+        experimentHelper = makeExperimentHelper<XCSR<double, bool>, RealMultiplexerEnvironment>(
+            useIslandModel,
             settings,
             constants,
             std::move(explorationEnvironments),
@@ -345,7 +486,8 @@ int main(int argc, char *argv[])
             exploitationEnvironments.push_back(std::make_unique<CheckerboardEnvironment>(result["chk"].as<int>(), result["chk-div"].as<int>()));
         }
 
-        experimentHelper = std::make_unique<ExperimentHelper<XCSR<double, bool>, CheckerboardEnvironment>>(
+        experimentHelper = makeExperimentHelper<XCSR<double, bool>, CheckerboardEnvironment>(
+            useIslandModel,
             settings,
             constants,
             std::move(explorationEnvironments),
@@ -373,7 +515,8 @@ int main(int argc, char *argv[])
             exploitationEnvironments.push_back(std::make_unique<RotatedCheckerboardEnvironment>(result["rchk"].as<int>(), result["chk-div"].as<int>()));
         }
 
-        experimentHelper = std::make_unique<ExperimentHelper<XCSR<double, bool>, RotatedCheckerboardEnvironment>>(
+        experimentHelper = makeExperimentHelper<XCSR<double, bool>, RotatedCheckerboardEnvironment>(
+            useIslandModel,
             settings,
             constants,
             std::move(explorationEnvironments),
@@ -423,7 +566,8 @@ int main(int argc, char *argv[])
             exploitationEnvironments.push_back(std::make_unique<FunctionEnvironment>(func, 2));
         }
 
-        experimentHelper = std::make_unique<ExperimentHelper<XCSR<double, int>, FunctionEnvironment>>(
+        experimentHelper = makeExperimentHelper<XCSR<double, int>, FunctionEnvironment>(
+            useIslandModel,
             settings,
             constants,
             std::move(explorationEnvironments),
@@ -459,6 +603,11 @@ int main(int argc, char *argv[])
                 exit(1);
             }
         }
+        if (availableActions.size() > xcs_impl::ActionRegistry<int>::kMaxActionCount)
+        {
+            std::cerr << "Error: The number of available actions must not exceed " << xcs_impl::ActionRegistry<int>::kMaxActionCount << "." << std::endl;
+            exit(1);
+        }
 
         std::string filename = result["csv"].as<std::string>();
         std::string evaluationCsvFilename = filename;
@@ -467,34 +616,128 @@ int main(int argc, char *argv[])
             evaluationCsvFilename = result["csv-eval"].as<std::string>();
         }
 
-        std::vector<std::unique_ptr<DatasetEnvironment<double, int>>> explorationEnvironments;
-        std::vector<std::unique_ptr<DatasetEnvironment<double, int>>> exploitationEnvironments;
-        for (std::size_t i = 0; i < settings.seedCount; ++i)
+        std::vector<std::unique_ptr<AbstractEnvironment<double, int>>> explorationEnvironments;
+        std::vector<std::unique_ptr<AbstractEnvironment<double, int>>> exploitationEnvironments;
+        if (result["csv-stream"].as<bool>())
         {
-            explorationEnvironments.push_back(std::make_unique<DatasetEnvironment<double, int>>(CSV::readDataset<double, int>(filename), availableActions, result["csv-random"].as<bool>()));
-            exploitationEnvironments.push_back(std::make_unique<DatasetEnvironment<double, int>>(CSV::readDataset<double, int>(evaluationCsvFilename), availableActions, result["csv-random"].as<bool>()));
+            if (result["csv-partition"].as<bool>())
+            {
+                std::cerr << "Error: --csv-partition cannot be used with --csv-stream." << std::endl;
+                exit(1);
+            }
+
+            const std::size_t bufferSize = result["csv-stream-buffer"].as<uint64_t>();
+            for (std::size_t i = 0; i < settings.seedCount; ++i)
+            {
+                explorationEnvironments.push_back(std::make_unique<StreamingDatasetEnvironment<double, int>>(filename, availableActions, result["csv-random"].as<bool>(), bufferSize));
+                exploitationEnvironments.push_back(std::make_unique<StreamingDatasetEnvironment<double, int>>(evaluationCsvFilename, availableActions, result["csv-random"].as<bool>(), bufferSize));
+            }
         }
+        else
+        {
+            // Load the files only once and share the datasets among the environments
+            //   Binary datasets converted by xxr-dataset are memory-mapped instead of being parsed.
+            using BinaryDatasetView = BinaryDataset::View<double, int>;
+            std::shared_ptr<const Dataset<double, int>> explorationDataset;
+            std::shared_ptr<const BinaryDatasetView> explorationBinaryDataset;
+            if (BinaryDataset::isBinaryDataset(filename))
+            {
+                explorationBinaryDataset = std::make_shared<const BinaryDatasetView>(filename);
+                if (result["csv-partition"].as<bool>())
+                {
+                    explorationDataset = std::make_shared<const Dataset<double, int>>(explorationBinaryDataset->toDataset());
+                }
+            }
+            else
+            {
+                explorationDataset = std::make_shared<const Dataset<double, int>>(CSV::readDataset<double, int>(filename));
+            }
 
-        experimentHelper = std::make_unique<ExperimentHelper<XCSR<double, int>, DatasetEnvironment<double, int>>>(
+            std::shared_ptr<const Dataset<double, int>> exploitationDataset;
+            std::shared_ptr<const BinaryDatasetView> exploitationBinaryDataset;
+            if (evaluationCsvFilename == filename)
+            {
+                exploitationDataset = explorationDataset;
+                exploitationBinaryDataset = explorationBinaryDataset;
+            }
+            else if (BinaryDataset::isBinaryDataset(evaluationCsvFilename))
+            {
+                exploitationBinaryDataset = std::make_shared<const BinaryDatasetView>(evaluationCsvFilename);
+            }
+            else
+            {
+                exploitationDataset = std::make_shared<const Dataset<double, int>>(CSV::readDataset<double, int>(evaluationCsvFilename));
+            }
+
+            for (std::size_t i = 0; i < settings.seedCount; ++i)
+            {
+                if (result["csv-partition"].as<bool>())
+                {
+                    explorationEnvironments.push_back(std::make_unique<DatasetEnvironment<double, int>>(partition(*explorationDataset, settings.seedCount, i), availableActions, result["csv-random"].as<bool>()));
+                }
+                else if (explorationBinaryDataset)
+                {
+                    explorationEnvironments.push_back(std::make_unique<BinaryDatasetEnvironment<double, int>>(explorationBinaryDataset, availableActions, result["csv-random"].as<bool>()));
+                }
+                else
+                {
+                    explorationEnvironments.push_back(std::make_unique<DatasetEnvironment<double, int>>(explorationDataset, availableActions, result["csv-random"].as<bool>()));
+                }
+
+                if (exploitationBinaryDataset)
+                {
+                    exploitationEnvironments.push_back(std::make_unique<BinaryDatasetEnvironment<double, int>>(exploitationBinaryDataset, availableActions, result["csv-random"].as<bool>()));
+                }
+                else
+                {
+                    exploitationEnvironments.push_back(std::make_unique<DatasetEnvironment<double, int>>(exploitationDataset, availableActions, result["csv-random"].as<bool>()));
+                }
+            }
+        }
+
+        experimentHelper = makeExperimentHelper<XCSR<double, int>, AbstractEnvironment<double, int>>(
+            useIslandModel,
             settings,
             constants,
             std::move(explorationEnvironments),
             std::move(exploitationEnvironments),
-            [](DatasetEnvironment<double, int> &){},
-            [](DatasetEnvironment<double, int> &){},
+            [](AbstractEnvironment<double, int> &){},
+            [](AbstractEnvironment<double, int> &){},
             repr
         );
     }
 
     // Run experiment
+    //   If the experiment stops with an error (e.g. a checkpoint cannot be written), the outputs below
+    //   are still written with the population at that point (and the exit status is 1).
+    bool hasRunError = false;
     if (experimentHelper)
     {
         uint64_t iterationCount = result["iter"].as<uint64_t>();
         uint64_t condensationIterationCount = result["condense-iter"].as<uint64_t>();
 
-        experimentHelper->runIteration(iterationCount);
-        experimentHelper->switchToCondensationMode();
-        experimentHelper->runIteration(condensationIterationCount);
+        try
+        {
+            // (The iterations restored from --checkpoint-input are skipped)
+            if (experimentHelper->iterationCount() < iterationCount)
+            {
+                experimentHelper->runIteration(iterationCount - experimentHelper->iterationCount());
+            }
+            experimentHelper->switchToCondensationMode();
+            if (experimentHelper->iterationCount() < iterationCount + condensationIterationCount)
+            {
+                experimentHelper->runIteration(iterationCount + condensationIterationCount - experimentHelper->iterationCount());
+            }
+
+            // Save checkpoint
+            experimentHelper->writeCheckpoint();
+            experimentHelper->waitForCheckpoint();
+        }
+        catch (std::exception & e)
+        {
+            std::cerr << e.what() << " (stopped at iteration " << experimentHelper->iterationCount() << ")" << std::endl;
+            hasRunError = true;
+        }
     }
     else
     {
@@ -503,6 +746,25 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    // Merge the populations of the islands
+    experimentHelper->mergeIslands();
+
+    // Write the remaining logs to the files
+    experimentHelper->flushLogs();
+
+    // Save phase profile, timeline trace and memory report
+    try
+    {
+        experimentHelper->writeProfile();
+        experimentHelper->writeTrace();
+        experimentHelper->writeMemoryReport();
+    }
+    catch (std::exception & e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
     // Save population
     {
         std::string filename = settings.outputFilenamePrefix + result["coutput"].as<std::string>();
@@ -515,7 +777,20 @@ int main(int argc, char *argv[])
         }
         if (os)
         {
-            experimentHelper->dumpPopulation(0, os);
+            PopulationCSV::Format format;
+            format.precision = result["coutput-precision"].as<int>();
+            format.threadCount = result["coutput-threads"].as<uint64_t>();
+            experimentHelper->dumpPopulation(0, os, format);
+        }
+    }
+
+    // Save population binary snapshot
+    if (!result["coutput-bin"].as<std::string>().empty())
+    {
+        std::ofstream ofs(settings.outputFilenamePrefix + result["coutput-bin"].as<std::string>(), std::ios::binary);
+        if (ofs)
+        {
+            experimentHelper->dumpPopulationBinary(0, ofs);
         }
     }
 
@@ -539,5 +814,38 @@ int main(int argc, char *argv[])
         }
     }
 
-    return 0;
+    // Save estimated results for unknown data
+    if (result.count("csv-estimate"))
+    {
+        if (result.count("csv-output-best"))
+        {
+            auto & experimentHelperRef = dynamic_cast<ExperimentHelper<XCSR<double, int>, AbstractEnvironment<double, int>> &>(*experimentHelper);
+
+            // Load CSV file
+            const auto tables = CSV::readTableChunks(result["csv-estimate"].as<std::string>());
+
+            // Choose the best action for each situation (in parallel over a copy of the population) and save CSV file
+            std::string filename = settings.outputFilenamePrefix + result["csv-output-best"].as<std::string>();
+            std::ofstream ofs(filename);
+            try
+            {
+                experimentHelperRef.experimentAt(0).visit([&](auto & experiment) {
+                    experiment.flushGA();
+                    const BatchEstimator<double, int> estimator(experiment.population(), experiment.constants.initialPrediction);
+                    estimator.writeEstimates(ofs, tables, result["csv-output-predictions"].as<bool>(), result["csv-output-matched"].as<bool>(), result["csv-estimate-threads"].as<uint64_t>());
+                });
+            }
+            catch (std::exception & e)
+            {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+        }
+        else
+        {
+            std::cerr << "Error: Output filename for estimated results (--csv-output-best) is not specified although --csv-estimate is specified.\n";
+        }
+    }
+
+    return hasRunError ? 1 : 0;
 }
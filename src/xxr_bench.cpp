@@ -0,0 +1,514 @@
+#define __USE_MINGW_ANSI_STDIO 0
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_set>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include <xxr/xcs.hpp>
+#include <xxr/xcsr.hpp>
+#include <xxr/helper/csv.hpp>
+#include <cxxopts.hpp>
+
+using namespace xxr;
+
+namespace
+{
+
+    using Clock = std::chrono::steady_clock;
+
+    struct PhaseResult
+    {
+        uint64_t stepCount = 0;
+        double seconds = 0.0;
+        PerfCounters::Values counters; // the counters of the benchmark thread (if --perf)
+        Profiler::Profile profile;     // the counters of the phases of all threads (if --perf and built with XXR_ENABLE_PROFILER)
+        std::vector<double> stepSeconds; // the latency of each step
+    };
+
+    struct BenchmarkResult
+    {
+        std::string name;
+        uint64_t n = 0;
+        uint64_t stepCount = 0;
+        PhaseResult explore; // explore() + executeAction() + reward()
+        PhaseResult exploit; // exploit() + executeAction() (without update)
+        std::size_t populationSize = 0;
+        std::size_t numerositySum = 0;
+        uint64_t peakRssKiB = 0;
+    };
+
+    // The workload trace files of a run (see --record-workload and --replay-workload)
+    struct WorkloadFiles
+    {
+        std::string recordExplorationFilename;
+        std::string recordExploitationFilename;
+        std::string replayExplorationFilename;
+        std::string replayExploitationFilename;
+    };
+
+    struct BenchmarkCase
+    {
+        std::string name;
+        std::function<BenchmarkResult(uint64_t n, uint64_t stepCount, uint64_t exploitStepCount, const WorkloadFiles & workloadFiles)> run;
+    };
+
+    // Reset the peak resident set size of the process (Linux only, returns false if not supported)
+    bool resetPeakRss()
+    {
+#if defined(__linux__)
+        std::ofstream ofs("/proc/self/clear_refs");
+        return static_cast<bool>(ofs << "5");
+#else
+        return false;
+#endif
+    }
+
+    // The peak resident set size of the process in KiB (since resetPeakRss() on Linux, 0 if unknown)
+    uint64_t peakRssKiB()
+    {
+#if defined(__linux__)
+        std::ifstream ifs("/proc/self/status");
+        std::string line;
+        while (std::getline(ifs, line))
+        {
+            if (line.compare(0, 6, "VmHWM:") == 0)
+            {
+                return std::stoull(line.substr(6));
+            }
+        }
+#endif
+#if defined(_WIN32)
+        return 0;
+#else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+        {
+            return 0;
+        }
+#if defined(__APPLE__)
+        return static_cast<uint64_t>(usage.ru_maxrss) / 1024; // bytes
+#else
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#endif
+    }
+
+    // The p-th percentile (0 <= p <= 100) of the values (nearest rank, 0 if empty)
+    double percentile(std::vector<double> values, double p)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+        const std::size_t rank = static_cast<std::size_t>(p / 100.0 * (values.size() - 1) + 0.5);
+        std::nth_element(values.begin(), values.begin() + rank, values.end());
+        return values[rank];
+    }
+
+    template <class Experiment, class Environment>
+    BenchmarkResult runBenchmark(Experiment & experiment, Environment & explorationEnvironment, Environment & exploitationEnvironment, uint64_t stepCount, uint64_t exploitStepCount)
+    {
+        BenchmarkResult result;
+
+        // The problems are not interrupted, so a few more steps may be run in multi-step problems
+        result.explore.stepSeconds.reserve(stepCount);
+        result.exploit.stepSeconds.reserve(exploitStepCount);
+        PerfCounters::Values beginCounters = PerfCounters::read();
+        Profiler::Profile beginProfile = Profiler::snapshot();
+        auto begin = Clock::now();
+        while (result.explore.stepCount < stepCount)
+        {
+            do
+            {
+                const auto stepBegin = Clock::now();
+                auto action = experiment.explore(explorationEnvironment.situation());
+                double reward = explorationEnvironment.executeAction(action);
+                experiment.reward(reward, explorationEnvironment.isEndOfProblem());
+                result.explore.stepSeconds.push_back(std::chrono::duration<double>(Clock::now() - stepBegin).count());
+                ++result.explore.stepCount;
+            } while (!explorationEnvironment.isEndOfProblem());
+        }
+        result.explore.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        result.explore.counters = PerfCounters::read() - beginCounters;
+        result.explore.profile = Profiler::snapshot() - beginProfile;
+
+        beginCounters = PerfCounters::read();
+        beginProfile = Profiler::snapshot();
+        begin = Clock::now();
+        while (result.exploit.stepCount < exploitStepCount)
+        {
+            do
+            {
+                const auto stepBegin = Clock::now();
+                auto action = experiment.exploit(exploitationEnvironment.situation());
+                exploitationEnvironment.executeAction(action);
+                result.exploit.stepSeconds.push_back(std::chrono::duration<double>(Clock::now() - stepBegin).count());
+                ++result.exploit.stepCount;
+            } while (!exploitationEnvironment.isEndOfProblem());
+        }
+        result.exploit.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        result.exploit.counters = PerfCounters::read() - beginCounters;
+        result.exploit.profile = Profiler::snapshot() - beginProfile;
+
+        result.populationSize = experiment.populationSize();
+        result.numerositySum = experiment.numerositySum();
+        return result;
+    }
+
+    // Make the environment of a run (replays or records the workload trace if the filename is specified)
+    //   The pointer is only for the deduction of T and Action of the environment class.
+    template <typename T, typename Action, class MakeEnvironment>
+    std::unique_ptr<AbstractEnvironment<T, Action>> makeWorkloadEnvironment(const AbstractEnvironment<T, Action> *, MakeEnvironment makeEnvironment, const std::string & recordFilename, const std::string & replayFilename)
+    {
+        if (!replayFilename.empty())
+        {
+            return std::make_unique<ReplayEnvironment<T, Action>>(replayFilename);
+        }
+
+        std::unique_ptr<AbstractEnvironment<T, Action>> environment = makeEnvironment();
+        if (!recordFilename.empty())
+        {
+            return std::make_unique<RecordingEnvironment<T, Action>>(std::move(environment), recordFilename);
+        }
+        return environment;
+    }
+
+    template <class Experiment, class Environment, class Constants, class MakeEnvironment, class... Args>
+    BenchmarkCase makeCase(const std::string & name, const Constants & baseConstants, MakeEnvironment makeEnvironment, Args... args)
+    {
+        return BenchmarkCase{ name, [=](uint64_t n, uint64_t stepCount, uint64_t exploitStepCount, const WorkloadFiles & workloadFiles) {
+            const Environment *environmentType = nullptr;
+            auto explorationEnvironment = makeWorkloadEnvironment(environmentType, makeEnvironment, workloadFiles.recordExplorationFilename, workloadFiles.replayExplorationFilename);
+            auto exploitationEnvironment = makeWorkloadEnvironment(environmentType, makeEnvironment, workloadFiles.recordExploitationFilename, workloadFiles.replayExploitationFilename);
+            Constants constants = baseConstants;
+            constants.n = n;
+            Experiment experiment(explorationEnvironment->availableActions, constants, args...);
+            return runBenchmark(experiment, *explorationEnvironment, *exploitationEnvironment, stepCount, exploitStepCount);
+        } };
+    }
+
+    // A dataset of the 6-bit real multiplexer problem (used if --csv is not specified)
+    std::shared_ptr<const Dataset<double, int>> makeRealMultiplexerDataset(std::size_t rowCount)
+    {
+        RealMultiplexerEnvironment environment(6, true);
+        Dataset<double, int> dataset;
+        for (std::size_t i = 0; i < rowCount; ++i)
+        {
+            dataset.situations.push_back(environment.situation());
+            dataset.actions.push_back(environment.getAnswer() ? 1 : 0);
+            environment.executeAction(false);
+        }
+        return std::make_shared<const Dataset<double, int>>(std::move(dataset));
+    }
+
+    std::vector<BenchmarkCase> makeCases(const std::string & mazeDirectory, const std::string & csvFilename, uint64_t maxStep)
+    {
+        std::vector<BenchmarkCase> cases;
+
+        // XCS (single-step)
+        const XCSConstants xcsConstants;
+        for (int length : { 6, 11, 20, 37, 70, 135 })
+        {
+            cases.push_back(makeCase<XCS<bool, bool>, MultiplexerEnvironment>("mux" + std::to_string(length), xcsConstants, [length]{ return std::make_unique<MultiplexerEnvironment>(length); }));
+        }
+
+        // XCS with the background GA worker (compare the step latency percentiles with "mux20")
+        XCSConstants xcsAsyncGAConstants;
+        xcsAsyncGAConstants.useAsyncGA = true;
+        cases.push_back(makeCase<XCS<bool, bool>, MultiplexerEnvironment>("mux20-async", xcsAsyncGAConstants, []{ return std::make_unique<MultiplexerEnvironment>(20); }));
+
+        cases.push_back(makeCase<XCS<bool, bool>, EvenParityEnvironment>("parity6", xcsConstants, []{ return std::make_unique<EvenParityEnvironment>(6); }));
+        cases.push_back(makeCase<XCS<bool, bool>, MajorityOnEnvironment>("majority7", xcsConstants, []{ return std::make_unique<MajorityOnEnvironment>(7); }));
+
+        // XCS (multi-step)
+        for (const char *mapName : { "maze4", "maze5", "maze6", "woods1", "woods2" })
+        {
+            const std::string mapFilename = mazeDirectory + "/" + mapName + ".txt";
+            if (!std::ifstream(mapFilename))
+            {
+                std::cerr << "Warning: Skipped the benchmark '" << mapName << "' (cannot open file '" << mapFilename << "')" << std::endl;
+                continue;
+            }
+            cases.push_back(makeCase<XCS<bool, int>, BlockWorldEnvironment>(mapName, xcsConstants, [mapFilename, maxStep]{ return std::make_unique<BlockWorldEnvironment>(mapFilename, maxStep, false, true); }));
+        }
+
+        // XCSR
+        const XCSRConstants xcsrConstants;
+        std::shared_ptr<const Dataset<double, int>> dataset = csvFilename.empty()
+            ? makeRealMultiplexerDataset(10000)
+            : std::make_shared<const Dataset<double, int>>(CSV::readDataset<double, int>(csvFilename));
+        std::unordered_set<int> datasetActions(dataset->actions.begin(), dataset->actions.end());
+        for (auto repr : { std::make_pair(CSR, "csr"), std::make_pair(OBR, "obr"), std::make_pair(UBR, "ubr") })
+        {
+            const std::string reprName = repr.second;
+            cases.push_back(makeCase<XCSR<double, bool>, RealMultiplexerEnvironment>("rmux6-" + reprName, xcsrConstants, []{ return std::make_unique<RealMultiplexerEnvironment>(6, true); }, repr.first));
+            cases.push_back(makeCase<XCSR<double, bool>, CheckerboardEnvironment>("chk3x3-" + reprName, xcsrConstants, []{ return std::make_unique<CheckerboardEnvironment>(3, 3); }, repr.first));
+            cases.push_back(makeCase<XCSR<double, int>, DatasetEnvironment<double, int>>("csv-" + reprName, xcsrConstants, [dataset, datasetActions]{ return std::make_unique<DatasetEnvironment<double, int>>(dataset, datasetActions); }, repr.first));
+        }
+
+        return cases;
+    }
+
+    std::vector<uint64_t> parseList(const std::string & str)
+    {
+        std::vector<uint64_t> values;
+        std::istringstream iss(str);
+        std::string value;
+        while (std::getline(iss, value, ','))
+        {
+            values.push_back(std::stoull(value));
+        }
+        return values;
+    }
+
+    // Write the counters per step ("null" for the unavailable counters)
+    void writeCountersPerStep(std::ostream & os, const PerfCounters::Values & counters, uint64_t stepCount)
+    {
+        os << "{ ";
+        for (std::size_t i = 0; i < PerfCounters::kCounterCount; ++i)
+        {
+            const auto counter = static_cast<PerfCounters::Counter>(i);
+            os << ((i > 0) ? ", " : "") << '"' << PerfCounters::counterName(counter) << "\": ";
+            if (PerfCounters::isAvailable(counter))
+            {
+                os << ((stepCount > 0) ? static_cast<double>(counters[counter]) / stepCount : 0.0);
+            }
+            else
+            {
+                os << "null";
+            }
+        }
+        os << " }";
+    }
+
+    void writePhase(std::ostream & os, const PhaseResult & phase)
+    {
+        const double stepsPerSecond = (phase.seconds > 0.0) ? phase.stepCount / phase.seconds : 0.0;
+        const double nsPerStep = (phase.stepCount > 0) ? phase.seconds * 1e9 / phase.stepCount : 0.0;
+        os  << "{ \"steps\": " << phase.stepCount
+            << ", \"seconds\": " << phase.seconds
+            << ", \"stepsPerSecond\": " << stepsPerSecond
+            << ", \"nsPerStep\": " << nsPerStep
+            << ",\n        \"latencyUs\": { \"p50\": " << percentile(phase.stepSeconds, 50.0) * 1e6
+            << ", \"p90\": " << percentile(phase.stepSeconds, 90.0) * 1e6
+            << ", \"p99\": " << percentile(phase.stepSeconds, 99.0) * 1e6
+            << ", \"p99.9\": " << percentile(phase.stepSeconds, 99.9) * 1e6 << " }";
+        if (PerfCounters::isEnabled())
+        {
+            os << ",\n        \"countersPerStep\": ";
+            writeCountersPerStep(os, phase.counters, phase.stepCount);
+            if (Profiler::kEnabled)
+            {
+                os << ",\n        \"phaseCountersPerStep\": {";
+                for (std::size_t i = 0; i < Profiler::kPhaseCount; ++i)
+                {
+                    os << ((i > 0) ? "," : "") << "\n          \"" << Profiler::phaseName(static_cast<Profiler::Phase>(i)) << "\": ";
+                    writeCountersPerStep(os, phase.profile.counters[i], phase.stepCount);
+                }
+                os << "\n        }";
+            }
+        }
+        os << " }";
+    }
+
+    void writeResult(std::ostream & os, const BenchmarkResult & result)
+    {
+        os  << "    {\n"
+            << "      \"name\": \"" << result.name << "\",\n"
+            << "      \"n\": " << result.n << ",\n"
+            << "      \"stepCount\": " << result.stepCount << ",\n"
+            << "      \"explore\": ";
+        writePhase(os, result.explore);
+        os  << ",\n"
+            << "      \"exploit\": ";
+        writePhase(os, result.exploit);
+        os  << ",\n"
+            << "      \"populationSize\": " << result.populationSize << ",\n"
+            << "      \"numerositySum\": " << result.numerositySum << ",\n"
+            << "      \"peakRssKiB\": " << result.peakRssKiB << "\n"
+            << "    }";
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    // Parse command line arguments
+    cxxopts::Options options(argv[0], "Benchmark of the built-in environments (results in JSON)");
+
+    options
+        .allow_unrecognised_options()
+        .add_options()
+        ("o,output", "The filename of JSON output (\"\": standard output)", cxxopts::value<std::string>()->default_value(""), "FILENAME")
+        ("filter", "Run only the benchmarks whose name contains the string", cxxopts::value<std::string>()->default_value(""), "STRING")
+        ("list", "Show the names of the benchmarks")
+        ("N,n", "The comma-separated maximum sizes of the population to sweep", cxxopts::value<std::string>()->default_value("400,2000"), "N1,N2,...")
+        ("steps", "The comma-separated numbers of the exploration steps to sweep", cxxopts::value<std::string>()->default_value("10000,50000"), "COUNT1,COUNT2,...")
+        ("exploit-steps", "The number of the exploitation steps measured after the exploration", cxxopts::value<uint64_t>()->default_value("10000"), "COUNT")
+        ("seed", "The random seed of each run", cxxopts::value<uint64_t>()->default_value("1"), "SEED")
+        ("maze-dir", "The directory of the block world maps", cxxopts::value<std::string>()->default_value("maze_map"), "DIRECTORY")
+        ("max-step", "The maximum number of steps in the block world problems", cxxopts::value<uint64_t>()->default_value("50"), "COUNT")
+        ("perf", "Read the hardware performance counters (cycles, instructions, L1/LLC misses and branch misses) per step (Linux only; also per phase if built with XXR_ENABLE_PROFILER)")
+        ("record-workload", "Record the workloads of the runs to the workload traces in the directory", cxxopts::value<std::string>()->default_value(""), "DIRECTORY")
+        ("replay-workload", "Replay the workloads of the runs from the workload traces in the directory (recorded by --record-workload)", cxxopts::value<std::string>()->default_value(""), "DIRECTORY")
+        ("csv", "The csv dataset for the csv benchmarks (the last column is the action, default: 10000 rows of the 6-bit real multiplexer problem)", cxxopts::value<std::string>()->default_value(""), "FILENAME")
+        ("h,help", "Show this help");
+
+    auto result = options.parse(argc, argv);
+
+    // Show help
+    if (result.count("help"))
+    {
+        std::cout << options.help({"", "Group"}) << std::endl;
+        return 0;
+    }
+
+    const uint64_t seed = result["seed"].as<uint64_t>();
+    Random::seed(seed);
+    const auto cases = makeCases(result["maze-dir"].as<std::string>(), result["csv"].as<std::string>(), result["max-step"].as<uint64_t>());
+
+    // Show benchmark names
+    if (result.count("list"))
+    {
+        for (auto && benchmarkCase : cases)
+        {
+            std::cout << benchmarkCase.name << std::endl;
+        }
+        return 0;
+    }
+
+    std::vector<uint64_t> ns, stepCounts;
+    try
+    {
+        ns = parseList(result["n"].as<std::string>());
+        stepCounts = parseList(result["steps"].as<std::string>());
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << "Error: Invalid number list in --n or --steps" << std::endl;
+        return 1;
+    }
+
+    std::ofstream ofs;
+    const std::string filename = result["output"].as<std::string>();
+    std::ostream & os = filename.empty() ? std::cout : ofs;
+    if (!filename.empty())
+    {
+        ofs.open(filename);
+        if (!ofs)
+        {
+            std::cerr << "Error: Cannot open file '" << filename << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    const std::string recordDirectory = result["record-workload"].as<std::string>();
+    const std::string replayDirectory = result["replay-workload"].as<std::string>();
+    if (!recordDirectory.empty() && !replayDirectory.empty())
+    {
+        std::cerr << "Error: Cannot specify both --record-workload and --replay-workload" << std::endl;
+        return 1;
+    }
+
+    if (result.count("perf"))
+    {
+        PerfCounters::enable();
+        std::string unavailableCounters;
+        for (std::size_t i = 0; i < PerfCounters::kCounterCount; ++i)
+        {
+            const auto counter = static_cast<PerfCounters::Counter>(i);
+            if (!PerfCounters::isAvailable(counter))
+            {
+                unavailableCounters += std::string(unavailableCounters.empty() ? "" : ", ") + PerfCounters::counterName(counter);
+            }
+        }
+        if (!unavailableCounters.empty())
+        {
+            std::cerr << "Warning: The hardware performance counters are not available (" << unavailableCounters << "; see perf_event_paranoid)." << std::endl;
+        }
+    }
+
+    const bool isPeakRssPerRun = resetPeakRss();
+    os  << "{\n"
+        << "  \"seed\": " << seed << ",\n"
+        << "  \"exploitSteps\": " << result["exploit-steps"].as<uint64_t>() << ",\n"
+        << "  \"peakRssPerRun\": " << (isPeakRssPerRun ? "true" : "false") << ",\n"
+        << "  \"perf\": " << (PerfCounters::isEnabled() ? "true" : "false") << ",\n"
+        << "  \"workload\": \"" << (!recordDirectory.empty() ? "record" : (!replayDirectory.empty() ? "replay" : "generate")) << "\",\n"
+        << "  \"results\": [\n";
+
+    const std::string filter = result["filter"].as<std::string>();
+    bool isFirst = true;
+    for (auto && benchmarkCase : cases)
+    {
+        if (benchmarkCase.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        for (uint64_t n : ns)
+        {
+            for (uint64_t stepCount : stepCounts)
+            {
+                std::cerr << benchmarkCase.name << " (N=" << n << ", steps=" << stepCount << ")" << std::endl;
+
+                // The traces of a run are "<name>-n<N>-steps<COUNT>.explore.xxrw" and ".exploit.xxrw"
+                WorkloadFiles workloadFiles;
+                const std::string traceName = benchmarkCase.name + "-n" + std::to_string(n) + "-steps" + std::to_string(stepCount);
+                if (!recordDirectory.empty())
+                {
+                    workloadFiles.recordExplorationFilename = recordDirectory + "/" + traceName + ".explore.xxrw";
+                    workloadFiles.recordExploitationFilename = recordDirectory + "/" + traceName + ".exploit.xxrw";
+                }
+                if (!replayDirectory.empty())
+                {
+                    workloadFiles.replayExplorationFilename = replayDirectory + "/" + traceName + ".explore.xxrw";
+                    workloadFiles.replayExploitationFilename = replayDirectory + "/" + traceName + ".exploit.xxrw";
+                }
+
+                Random::seed(seed);
+                resetPeakRss();
+                BenchmarkResult benchmarkResult;
+                try
+                {
+                    benchmarkResult = benchmarkCase.run(n, stepCount, result["exploit-steps"].as<uint64_t>(), workloadFiles);
+                }
+                catch (const std::runtime_error & e)
+                {
+                    std::cerr << "Error: " << e.what() << std::endl;
+                    return 1;
+                }
+                benchmarkResult.name = benchmarkCase.name;
+                benchmarkResult.n = n;
+                benchmarkResult.stepCount = stepCount;
+                benchmarkResult.peakRssKiB = peakRssKiB();
+
+                if (!isFirst)
+                {
+                    os << ",\n";
+                }
+                writeResult(os, benchmarkResult);
+                os.flush();
+                isFirst = false;
+            }
+        }
+    }
+
+    os << "\n  ]\n}" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+#define __USE_MINGW_ANSI_STDIO 0
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstddef>
+
+#include <xxr/helper/csv.hpp>
+#include <xxr/helper/binary_dataset.hpp>
+#include <cxxopts.hpp>
+
+using namespace xxr;
+
+int main(int argc, char *argv[])
+{
+    // Parse command line arguments
+    cxxopts::Options options(argv[0], "Dataset converter (csv to binary dataset for --csv of xcs/xcsr)");
+
+    options
+        .allow_unrecognised_options()
+        .add_options()
+        ("i,input", "The csv file to convert (the last column is the action)", cxxopts::value<std::string>(), "FILENAME")
+        ("o,output", "The filename of binary dataset output", cxxopts::value<std::string>(), "FILENAME")
+        ("column-major", "Whether to store the situations in column-major order", cxxopts::value<bool>()->default_value("false"), "true/false")
+        ("info", "Show the header of the binary dataset", cxxopts::value<std::string>(), "FILENAME")
+        ("h,help", "Show this help");
+
+    auto result = options.parse(argc, argv);
+
+    // Show help
+    if (result.count("help") || (!result.count("info") && (!result.count("input") || !result.count("output"))))
+    {
+        std::cout << options.help({"", "Group"}) << std::endl;
+        return result.count("help") ? 0 : 1;
+    }
+
+    // Show header
+    if (result.count("info"))
+    {
+        const BinaryDataset::View<double, int> view(result["info"].as<std::string>());
+        const auto & header = view.header();
+        std::cout
+            << "Rows              : " << header.rowCount << "\n"
+            << "Situation length  : " << header.columnCount << "\n"
+            << "Situation encoding: " << static_cast<uint32_t>(header.situationEncoding) << "\n"
+            << "Layout            : " << ((header.layout == BinaryDataset::Layout::ROW_MAJOR) ? "row-major" : "column-major") << "\n"
+            << "Action encoding   : " << static_cast<uint32_t>(header.actionEncoding) << "\n"
+            << "Min/Max           : " << header.minValue << " / " << header.maxValue << std::endl;
+        return 0;
+    }
+
+    // Convert csv (the values are kept exactly as CSV::readDataset() reads them)
+    const auto dataset = CSV::readDataset<double, int>(result["input"].as<std::string>());
+
+    std::ofstream ofs(result["output"].as<std::string>(), std::ios::binary);
+    if (!ofs)
+    {
+        std::cerr << "Error: Cannot open file '" << result["output"].as<std::string>() << "'" << std::endl;
+        return 1;
+    }
+    BinaryDataset::write(ofs, dataset, result["column-major"].as<bool>() ? BinaryDataset::Layout::COLUMN_MAJOR : BinaryDataset::Layout::ROW_MAJOR);
+
+    return 0;
+}
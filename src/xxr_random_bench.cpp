@@ -0,0 +1,490 @@
+#define __USE_MINGW_ANSI_STDIO 0
+#define XXR_MEMORY_ACCOUNTING_IMPLEMENTATION // replaces operator new/delete if built with XXR_ENABLE_MEMORY_ACCOUNTING
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <unordered_set>
+#include <memory>
+#include <functional>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+#include <xxr/random.hpp>
+#include <xxr/memory_usage.hpp>
+#include <cxxopts.hpp>
+
+using namespace xxr;
+
+namespace
+{
+
+    using Clock = std::chrono::steady_clock;
+
+    // A routine prepared for a container
+    struct RoutineInstance
+    {
+        // The probabilities of the indices to be selected
+        std::vector<double> expectedProbabilities;
+
+        // Select once and return the index of the selected item
+        std::function<std::size_t()> select;
+
+        // Select count times (the loop for timing, returns the sum of the indices)
+        std::function<uint64_t(uint64_t count)> run;
+    };
+
+    struct BenchmarkCase
+    {
+        std::string name; // "<routine>/<distribution>"
+        std::function<RoutineInstance(std::size_t size, std::mt19937 & dataEngine)> prepare;
+    };
+
+    struct BenchmarkResult
+    {
+        std::string name;
+        std::size_t size = 0;
+        uint64_t callCount = 0;
+        double seconds = 0.0;
+        double allocationsPerCall = 0.0;
+        uint64_t drawCount = 0;
+        double chiSquare = 0.0;
+        std::size_t degreesOfFreedom = 0;
+        double pValue = 1.0;
+    };
+
+    // The distributions of the values of the containers (all positive)
+    std::vector<std::pair<std::string, std::function<double(std::mt19937 &)>>> valueDistributions()
+    {
+        return {
+            { "uniform", [](std::mt19937 & engine) { return 1.0 - std::uniform_real_distribution<double>(0.0, 1.0)(engine); } },
+            { "skewed", [](std::mt19937 & engine) { return std::pow(1.0 - std::uniform_real_distribution<double>(0.0, 1.0)(engine), 8.0); } },
+            { "ties", [](std::mt19937 & engine) { return static_cast<double>(std::uniform_int_distribution<int>(1, 4)(engine)); } },
+        };
+    }
+
+    // The distributions of the numerosity of the classifiers
+    std::vector<std::pair<std::string, std::function<std::size_t(std::mt19937 &)>>> numerosityDistributions()
+    {
+        return {
+            { "num1", [](std::mt19937 &) { return std::size_t{ 1 }; } },
+            { "num1-20", [](std::mt19937 & engine) { return std::uniform_int_distribution<std::size_t>(1, 20)(engine); } },
+            { "numgeo", [](std::mt19937 & engine) { return std::geometric_distribution<std::size_t>(0.3)(engine) + 1; } },
+        };
+    }
+
+    template <class Select>
+    RoutineInstance makeInstance(std::vector<double> && expectedProbabilities, Select select)
+    {
+        RoutineInstance instance;
+        instance.expectedProbabilities = std::move(expectedProbabilities);
+        instance.select = select;
+        instance.run = [select](uint64_t count) {
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                sum += select();
+            }
+            return sum;
+        };
+        return instance;
+    }
+
+    // The probabilities of the greedy selection (uniform among the maximum values)
+    std::vector<double> greedyProbabilities(const std::vector<double> & values)
+    {
+        const double maxValue = *std::max_element(values.begin(), values.end());
+        const std::size_t maxCount = std::count(values.begin(), values.end(), maxValue);
+        std::vector<double> probabilities;
+        for (double value : values)
+        {
+            probabilities.push_back((value == maxValue) ? 1.0 / maxCount : 0.0);
+        }
+        return probabilities;
+    }
+
+    // The probabilities of the tournament selection
+    //   Each item joins the tournament with probability joinProbabilities[i], and the first
+    //   one of the maximum values among them wins (a uniformly random item if nobody joins).
+    std::vector<double> tournamentProbabilities(const std::vector<double> & values, const std::vector<double> & joinProbabilities)
+    {
+        const std::size_t size = values.size();
+
+        // Sort the items in the order of the priority (the larger value, then the smaller index)
+        std::vector<std::size_t> order(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&values](std::size_t lhs, std::size_t rhs) { return values[lhs] > values[rhs]; });
+
+        std::vector<double> probabilities(size);
+        double nobodyJoinsProbability = 1.0; // the probability that none of the prior items joins
+        for (std::size_t i : order)
+        {
+            probabilities[i] = joinProbabilities[i] * nobodyJoinsProbability;
+            nobodyJoinsProbability *= 1.0 - joinProbabilities[i];
+        }
+        for (auto && probability : probabilities)
+        {
+            probability += nobodyJoinsProbability / size;
+        }
+        return probabilities;
+    }
+
+    std::vector<BenchmarkCase> makeCases(double epsilon, double tau)
+    {
+        std::vector<BenchmarkCase> cases;
+
+        cases.push_back({ "chooseFrom/vector", [](std::size_t size, std::mt19937 &) {
+            auto container = std::make_shared<std::vector<std::size_t>>();
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                container->push_back(i);
+            }
+            return makeInstance(std::vector<double>(size, 1.0 / size), [container] { return Random::chooseFrom(*container); });
+        } });
+
+        cases.push_back({ "chooseFrom/set", [](std::size_t size, std::mt19937 &) {
+            auto container = std::make_shared<std::set<std::size_t>>();
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                container->insert(i);
+            }
+            return makeInstance(std::vector<double>(size, 1.0 / size), [container] { return Random::chooseFrom(*container); });
+        } });
+
+        cases.push_back({ "chooseFrom/unordered_set", [](std::size_t size, std::mt19937 &) {
+            auto container = std::make_shared<std::unordered_set<std::size_t>>();
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                container->insert(i);
+            }
+            return makeInstance(std::vector<double>(size, 1.0 / size), [container] { return Random::chooseFrom(*container); });
+        } });
+
+        for (auto && distribution : valueDistributions())
+        {
+            const auto generate = distribution.second;
+            auto makeValues = [generate](std::size_t size, std::mt19937 & dataEngine) {
+                auto values = std::make_shared<std::vector<double>>();
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    values->push_back(generate(dataEngine));
+                }
+                return values;
+            };
+
+            cases.push_back({ "rouletteWheelSelection/" + distribution.first, [makeValues](std::size_t size, std::mt19937 & dataEngine) {
+                auto values = makeValues(size, dataEngine);
+                double sum = 0.0;
+                for (double value : *values)
+                {
+                    sum += value;
+                }
+                std::vector<double> probabilities;
+                for (double value : *values)
+                {
+                    probabilities.push_back(value / sum);
+                }
+                return makeInstance(std::move(probabilities), [values] { return Random::rouletteWheelSelection(*values); });
+            } });
+
+            cases.push_back({ "greedySelection/" + distribution.first, [makeValues](std::size_t size, std::mt19937 & dataEngine) {
+                auto values = makeValues(size, dataEngine);
+                return makeInstance(greedyProbabilities(*values), [values] { return Random::greedySelection(*values); });
+            } });
+
+            cases.push_back({ "epsilonGreedySelection/" + distribution.first, [makeValues, epsilon](std::size_t size, std::mt19937 & dataEngine) {
+                auto values = makeValues(size, dataEngine);
+                std::vector<double> probabilities = greedyProbabilities(*values);
+                for (auto && probability : probabilities)
+                {
+                    probability = epsilon / size + (1.0 - epsilon) * probability;
+                }
+                return makeInstance(std::move(probabilities), [values, epsilon] { return Random::epsilonGreedySelection(*values, epsilon); });
+            } });
+
+            cases.push_back({ "tournamentSelection/" + distribution.first, [makeValues, tau](std::size_t size, std::mt19937 & dataEngine) {
+                auto values = makeValues(size, dataEngine);
+                return makeInstance(tournamentProbabilities(*values, std::vector<double>(size, tau)), [values, tau] { return Random::tournamentSelection(*values, tau); });
+            } });
+        }
+
+        for (auto && distribution : numerosityDistributions())
+        {
+            const auto generate = distribution.second;
+            cases.push_back({ "tournamentSelectionMicroClassifier/" + distribution.first, [generate, tau](std::size_t size, std::mt19937 & dataEngine) {
+                // (fitness, numerosity) of the macroclassifiers
+                auto container = std::make_shared<std::vector<std::pair<double, std::size_t>>>();
+                std::vector<double> values;
+                std::vector<double> joinProbabilities;
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    const std::size_t numerosity = generate(dataEngine);
+                    const double fitness = (1.0 - std::uniform_real_distribution<double>(0.0, 1.0)(dataEngine)) * numerosity;
+                    container->emplace_back(fitness, numerosity);
+                    values.push_back(fitness / numerosity);
+                    joinProbabilities.push_back(1.0 - std::pow(1.0 - tau, static_cast<double>(numerosity)));
+                }
+                return makeInstance(tournamentProbabilities(values, joinProbabilities), [container, tau] { return Random::tournamentSelectionMicroClassifier(*container, tau); });
+            } });
+        }
+
+        return cases;
+    }
+
+    // Measure the time of the calls (at least minSeconds)
+    void measure(const RoutineInstance & instance, double minSeconds, BenchmarkResult & result)
+    {
+        constexpr uint64_t kBatchCallCount = 1024;
+
+        volatile uint64_t sink = instance.run(kBatchCallCount); // warm up
+        const uint64_t firstAllocationCount = MemoryAccounting::threadCounter().allocationCount;
+        const auto begin = Clock::now();
+        do
+        {
+            sink = sink + instance.run(kBatchCallCount);
+            result.callCount += kBatchCallCount;
+            result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        } while (result.seconds < minSeconds);
+        result.allocationsPerCall = static_cast<double>(MemoryAccounting::threadCounter().allocationCount - firstAllocationCount) / result.callCount;
+    }
+
+    // The upper tail probability of the chi-square distribution (Wilson-Hilferty approximation)
+    double chiSquarePValue(double chiSquare, std::size_t degreesOfFreedom)
+    {
+        if (degreesOfFreedom == 0)
+        {
+            return 1.0;
+        }
+        const double k = static_cast<double>(degreesOfFreedom);
+        const double z = (std::cbrt(chiSquare / k) - (1.0 - 2.0 / (9.0 * k))) / std::sqrt(2.0 / (9.0 * k));
+        return 0.5 * std::erfc(z / std::sqrt(2.0));
+    }
+
+    // Check the distribution of the selected indices with Pearson's chi-square test
+    //   The indices expected less than 5 times are pooled into one bin, and the indices of
+    //   probability 0 must never be selected.
+    void checkDistribution(const RoutineInstance & instance, uint64_t drawCount, BenchmarkResult & result)
+    {
+        const std::size_t size = instance.expectedProbabilities.size();
+        std::vector<uint64_t> counts(size, 0);
+        bool isImpossibleSelected = false;
+        for (uint64_t i = 0; i < drawCount; ++i)
+        {
+            const std::size_t idx = instance.select();
+            if (idx >= size || instance.expectedProbabilities[idx] == 0.0)
+            {
+                isImpossibleSelected = true;
+                continue;
+            }
+            ++counts[idx];
+        }
+
+        double chiSquare = 0.0;
+        std::size_t binCount = 0;
+        double pooledExpected = 0.0;
+        uint64_t pooledCount = 0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            const double expected = instance.expectedProbabilities[i] * drawCount;
+            if (expected == 0.0)
+            {
+                continue;
+            }
+            if (expected < 5.0)
+            {
+                pooledExpected += expected;
+                pooledCount += counts[i];
+                continue;
+            }
+            chiSquare += (counts[i] - expected) * (counts[i] - expected) / expected;
+            ++binCount;
+        }
+        if (pooledExpected > 0.0)
+        {
+            chiSquare += (pooledCount - pooledExpected) * (pooledCount - pooledExpected) / pooledExpected;
+            ++binCount;
+        }
+
+        result.drawCount = drawCount;
+        result.chiSquare = chiSquare;
+        result.degreesOfFreedom = (binCount > 0) ? binCount - 1 : 0;
+        result.pValue = isImpossibleSelected ? 0.0 : chiSquarePValue(chiSquare, result.degreesOfFreedom);
+    }
+
+    std::vector<uint64_t> parseList(const std::string & str)
+    {
+        std::vector<uint64_t> values;
+        std::istringstream iss(str);
+        std::string value;
+        while (std::getline(iss, value, ','))
+        {
+            values.push_back(std::stoull(value));
+        }
+        return values;
+    }
+
+    void writeResult(std::ostream & os, const BenchmarkResult & result, double alpha)
+    {
+        os  << "    {\n"
+            << "      \"name\": \"" << result.name << "\",\n"
+            << "      \"size\": " << result.size << ",\n"
+            << "      \"calls\": " << result.callCount << ",\n"
+            << "      \"seconds\": " << result.seconds << ",\n"
+            << "      \"nsPerCall\": " << ((result.callCount > 0) ? result.seconds * 1e9 / result.callCount : 0.0) << ",\n"
+            << "      \"allocationsPerCall\": ";
+        if (MemoryAccounting::kEnabled)
+        {
+            os << result.allocationsPerCall;
+        }
+        else
+        {
+            os << "null";
+        }
+        os  << ",\n"
+            << "      \"draws\": " << result.drawCount << ",\n"
+            << "      \"chiSquare\": " << result.chiSquare << ",\n"
+            << "      \"degreesOfFreedom\": " << result.degreesOfFreedom << ",\n"
+            << "      \"pValue\": " << result.pValue << ",\n"
+            << "      \"passed\": " << ((result.pValue >= alpha) ? "true" : "false") << "\n"
+            << "    }";
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    // Parse command line arguments
+    cxxopts::Options options(argv[0], "Microbenchmark of the selection routines of Random with the check of the distributions (results in JSON)");
+
+    options
+        .allow_unrecognised_options()
+        .add_options()
+        ("o,output", "The filename of JSON output (\"\": standard output)", cxxopts::value<std::string>()->default_value(""), "FILENAME")
+        ("filter", "Run only the benchmarks whose name contains the string", cxxopts::value<std::string>()->default_value(""), "STRING")
+        ("list", "Show the names of the benchmarks")
+        ("sizes", "The comma-separated sizes of the containers to sweep", cxxopts::value<std::string>()->default_value("8,64,512,4096"), "SIZE1,SIZE2,...")
+        ("min-time", "The minimum time of the measurement of each benchmark in seconds", cxxopts::value<double>()->default_value("0.1"), "SECONDS")
+        ("draws", "The number of the selections for the check of the distribution (\"0\": no check)", cxxopts::value<uint64_t>()->default_value("200000"), "COUNT")
+        ("alpha", "The significance level of the chi-square test (the program exits with 1 if any check fails)", cxxopts::value<double>()->default_value("0.0001"), "ALPHA")
+        ("epsilon", "The exploration probability of epsilonGreedySelection", cxxopts::value<double>()->default_value("0.1"), "EPSILON")
+        ("tau", "The tournament size (ratio) of tournamentSelection and tournamentSelectionMicroClassifier", cxxopts::value<double>()->default_value("0.4"), "TAU")
+        ("seed", "The random seed of the containers and the selections", cxxopts::value<uint64_t>()->default_value("1"), "SEED")
+        ("h,help", "Show this help");
+
+    auto result = options.parse(argc, argv);
+
+    // Show help
+    if (result.count("help"))
+    {
+        std::cout << options.help({"", "Group"}) << std::endl;
+        return 0;
+    }
+
+    const auto cases = makeCases(result["epsilon"].as<double>(), result["tau"].as<double>());
+
+    // Show benchmark names
+    if (result.count("list"))
+    {
+        for (auto && benchmarkCase : cases)
+        {
+            std::cout << benchmarkCase.name << std::endl;
+        }
+        return 0;
+    }
+
+    std::vector<uint64_t> sizes;
+    try
+    {
+        sizes = parseList(result["sizes"].as<std::string>());
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << "Error: Invalid number list in --sizes" << std::endl;
+        return 1;
+    }
+    if (std::find(sizes.begin(), sizes.end(), 0) != sizes.end())
+    {
+        std::cerr << "Error: The sizes of the containers must be positive" << std::endl;
+        return 1;
+    }
+
+    std::ofstream ofs;
+    const std::string filename = result["output"].as<std::string>();
+    std::ostream & os = filename.empty() ? std::cout : ofs;
+    if (!filename.empty())
+    {
+        ofs.open(filename);
+        if (!ofs)
+        {
+            std::cerr << "Error: Cannot open file '" << filename << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    const uint64_t seed = result["seed"].as<uint64_t>();
+    const double minSeconds = result["min-time"].as<double>();
+    const uint64_t drawCount = result["draws"].as<uint64_t>();
+    const double alpha = result["alpha"].as<double>();
+    os  << "{\n"
+        << "  \"seed\": " << seed << ",\n"
+        << "  \"epsilon\": " << result["epsilon"].as<double>() << ",\n"
+        << "  \"tau\": " << result["tau"].as<double>() << ",\n"
+        << "  \"alpha\": " << alpha << ",\n"
+        << "  \"results\": [\n";
+
+    const std::string filter = result["filter"].as<std::string>();
+    bool isFirst = true;
+    std::size_t failedCount = 0;
+    for (auto && benchmarkCase : cases)
+    {
+        if (benchmarkCase.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        for (uint64_t size : sizes)
+        {
+            std::cerr << benchmarkCase.name << " (size=" << size << ")" << std::endl;
+
+            std::mt19937 dataEngine(static_cast<std::mt19937::result_type>(seed));
+            const RoutineInstance instance = benchmarkCase.prepare(static_cast<std::size_t>(size), dataEngine);
+
+            BenchmarkResult benchmarkResult;
+            benchmarkResult.name = benchmarkCase.name;
+            benchmarkResult.size = static_cast<std::size_t>(size);
+            Random::seed(static_cast<std::mt19937::result_type>(seed));
+            measure(instance, minSeconds, benchmarkResult);
+            if (drawCount > 0)
+            {
+                checkDistribution(instance, drawCount, benchmarkResult);
+            }
+            if (benchmarkResult.pValue < alpha)
+            {
+                std::cerr << "Error: The distribution of " << benchmarkCase.name << " (size=" << size << ") differs from the expected one (p=" << benchmarkResult.pValue << ")" << std::endl;
+                ++failedCount;
+            }
+
+            if (!isFirst)
+            {
+                os << ",\n";
+            }
+            writeResult(os, benchmarkResult, alpha);
+            os.flush();
+            isFirst = false;
+        }
+    }
+
+    os << "\n  ]\n}" << std::endl;
+
+    return (failedCount > 0) ? 1 : 0;
+}
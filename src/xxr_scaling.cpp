@@ -0,0 +1,274 @@
+#define __USE_MINGW_ANSI_STDIO 0
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+#include <xxr/xcs.hpp>
+#include <xxr/helper/experiment_helper.hpp>
+#include <xxr/helper/simple_moving_average.hpp>
+#include <cxxopts.hpp>
+
+using namespace xxr;
+
+namespace
+{
+
+    using Clock = std::chrono::steady_clock;
+
+    using Helper = ExperimentHelper<XCS<bool, bool>, MultiplexerEnvironment>;
+
+    // The maximum reward of the multiplexer problems (the reward of the correct answers)
+    constexpr double kCorrectReward = 1000.0;
+
+    struct ScalingConfig
+    {
+        std::size_t length = 0;
+        uint64_t n = 0;
+        std::size_t seedCount = 1;
+        uint64_t seed = 1;
+        double budgetSeconds = 0.0;    // the wall-clock budget of the configuration (0: unlimited)
+        uint64_t maxIterationCount = 0; // (0: unlimited)
+        std::size_t windowWidth = 1000; // the iterations of the moving average of the accuracy
+        double targetAccuracy = 1.0;
+        bool stopsAtTarget = true;
+    };
+
+    struct ScalingResult
+    {
+        uint64_t iterationCount = 0;
+        double seconds = 0.0;
+        bool isTargetReached = false;
+        uint64_t iterationCountToTarget = 0;
+        double secondsToTarget = 0.0;
+        double accuracy = 0.0; // the moving average at the end
+        double populationSize = 0.0; // the macroclassifiers (the average of the seeds)
+        std::string status;
+    };
+
+    std::vector<uint64_t> parseList(const std::string & str)
+    {
+        std::vector<uint64_t> values;
+        std::istringstream iss(str);
+        std::string value;
+        while (std::getline(iss, value, ','))
+        {
+            values.push_back(std::stoull(value));
+        }
+        return values;
+    }
+
+    // Whether the length is k + 2^k (k > 0)
+    bool isMultiplexerLength(std::size_t length)
+    {
+        for (std::size_t k = 1; k < 32 && k + (static_cast<std::size_t>(1) << k) <= length; ++k)
+        {
+            if (k + (static_cast<std::size_t>(1) << k) == length)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Run the experiment until the moving average of the accuracy reaches the target or the budget is exhausted
+    //   An iteration is one exploitation and one exploration for each seed (see ExperimentHelper).
+    ScalingResult runConfig(const ScalingConfig & config, const XCSConstants & baseConstants)
+    {
+        Random::seed(config.seed);
+
+        ExperimentSettings settings;
+        settings.seedCount = config.seedCount;
+        settings.summaryInterval = 0;
+        settings.outputSummaryFilename = "";
+
+        XCSConstants constants = baseConstants;
+        constants.n = config.n;
+
+        std::vector<std::unique_ptr<MultiplexerEnvironment>> explorationEnvironments;
+        std::vector<std::unique_ptr<MultiplexerEnvironment>> exploitationEnvironments;
+        for (std::size_t i = 0; i < config.seedCount; ++i)
+        {
+            explorationEnvironments.push_back(std::make_unique<MultiplexerEnvironment>(config.length));
+            exploitationEnvironments.push_back(std::make_unique<MultiplexerEnvironment>(config.length));
+        }
+        Helper helper(settings, constants, std::move(explorationEnvironments), std::move(exploitationEnvironments));
+
+        SimpleMovingAverage<double> accuracyAverage(config.windowWidth);
+        ScalingResult result;
+        const Clock::time_point begin = Clock::now();
+        while (true)
+        {
+            helper.runIteration();
+            ++result.iterationCount;
+            result.accuracy = accuracyAverage(helper.exploitationReward() / kCorrectReward);
+            result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+            if (!result.isTargetReached && result.iterationCount >= config.windowWidth && result.accuracy >= config.targetAccuracy)
+            {
+                result.isTargetReached = true;
+                result.iterationCountToTarget = result.iterationCount;
+                result.secondsToTarget = result.seconds;
+                if (config.stopsAtTarget)
+                {
+                    result.status = "reached";
+                    break;
+                }
+            }
+
+            if (config.maxIterationCount > 0 && result.iterationCount >= config.maxIterationCount)
+            {
+                result.status = "max-iterations";
+                break;
+            }
+            if (config.budgetSeconds > 0.0 && result.seconds >= config.budgetSeconds)
+            {
+                result.status = "budget";
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < helper.seedCount(); ++i)
+        {
+            result.populationSize += static_cast<double>(helper.experimentAt(i).populationSize()) / helper.seedCount();
+        }
+        return result;
+    }
+
+    void writeHeader(std::ostream & os)
+    {
+        os << "Length,N,Seeds,Iterations,Seconds,StepsPerSecond,IterationsToTarget,SecondsToTarget,Accuracy,MacroClassifiers,Status" << std::endl;
+    }
+
+    // Write the result as a row (IterationsToTarget and SecondsToTarget are empty if not reached)
+    void writeRow(std::ostream & os, const ScalingConfig & config, const ScalingResult & result)
+    {
+        // One exploration and one exploitation step per seed in each iteration
+        const double stepCount = 2.0 * result.iterationCount * config.seedCount;
+
+        os  << config.length << ','
+            << config.n << ','
+            << config.seedCount << ','
+            << result.iterationCount << ','
+            << result.seconds << ','
+            << ((result.seconds > 0.0) ? stepCount / result.seconds : 0.0) << ',';
+        if (result.isTargetReached)
+        {
+            os << result.iterationCountToTarget << ',' << result.secondsToTarget << ',';
+        }
+        else
+        {
+            os << ",,";
+        }
+        os  << result.accuracy << ','
+            << result.populationSize << ','
+            << result.status << std::endl;
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    // Parse command line arguments
+    cxxopts::Options options(argv[0], "Scaling study of XCS on the large multiplexer problems (results in CSV)");
+
+    options
+        .add_options()
+        ("o,output", "The filename of CSV output (\"\": standard output)", cxxopts::value<std::string>()->default_value(""), "FILENAME")
+        ("lengths", "The comma-separated lengths of the multiplexer problems (k + 2^k)", cxxopts::value<std::string>()->default_value("20,37,70,135"), "L1,L2,...")
+        ("N,n", "The comma-separated maximum sizes of the population", cxxopts::value<std::string>()->default_value("2000,5000,10000,20000,50000,100000"), "N1,N2,...")
+        ("budget", "The wall-clock budget of each configuration in seconds (0: unlimited)", cxxopts::value<double>()->default_value("600"), "SECONDS")
+        ("max-iter", "The maximum number of the iterations of each configuration (0: unlimited)", cxxopts::value<uint64_t>()->default_value("0"), "COUNT")
+        ("window", "The number of the iterations of the moving average of the accuracy", cxxopts::value<uint64_t>()->default_value("1000"), "COUNT")
+        ("target", "The target accuracy of the moving average", cxxopts::value<double>()->default_value("1.0"), "ACCURACY")
+        ("run-to-budget", "Keep running after the target is reached (until --budget or --max-iter)")
+        ("avg-seeds", "The number of different random seeds run in each configuration (the accuracy is the average)", cxxopts::value<uint64_t>()->default_value("1"), "COUNT")
+        ("seed", "The random seed of each configuration", cxxopts::value<uint64_t>()->default_value("1"), "SEED")
+        ("p-sharp", "The probability of using a don't care symbol in an allele when covering", cxxopts::value<double>()->default_value("0.65"), "P_SHARP")
+        ("tau", "The tournament size for selection (set \"0\" to use the roulette-wheel selection)", cxxopts::value<double>()->default_value("0.4"), "TAU")
+        ("h,help", "Show this help");
+
+    auto result = options.parse(argc, argv);
+
+    // Show help
+    if (result.count("help"))
+    {
+        std::cout << options.help({"", "Group"}) << std::endl;
+        return 0;
+    }
+
+    std::vector<uint64_t> lengths, ns;
+    try
+    {
+        lengths = parseList(result["lengths"].as<std::string>());
+        ns = parseList(result["n"].as<std::string>());
+    }
+    catch (const std::exception &)
+    {
+        std::cerr << "Error: Invalid number list in --lengths or --n" << std::endl;
+        return 1;
+    }
+    for (auto && length : lengths)
+    {
+        if (!isMultiplexerLength(length))
+        {
+            std::cerr << "Error: The length of the multiplexer problem must be k + 2^k (" << length << ")" << std::endl;
+            return 1;
+        }
+    }
+    if (result["window"].as<uint64_t>() == 0 || result["avg-seeds"].as<uint64_t>() == 0)
+    {
+        std::cerr << "Error: --window and --avg-seeds must be greater than 0" << std::endl;
+        return 1;
+    }
+
+    std::ofstream ofs;
+    const std::string filename = result["output"].as<std::string>();
+    std::ostream & os = filename.empty() ? std::cout : ofs;
+    if (!filename.empty())
+    {
+        ofs.open(filename);
+        if (!ofs)
+        {
+            std::cerr << "Error: Cannot open file '" << filename << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    XCSConstants constants;
+    constants.dontCareProbability = result["p-sharp"].as<double>();
+    constants.tau = result["tau"].as<double>();
+
+    // The rows are written as soon as each configuration finishes (so that an interrupted run keeps them)
+    writeHeader(os);
+    for (auto && length : lengths)
+    {
+        for (auto && n : ns)
+        {
+            ScalingConfig config;
+            config.length = length;
+            config.n = n;
+            config.seedCount = result["avg-seeds"].as<uint64_t>();
+            config.seed = result["seed"].as<uint64_t>();
+            config.budgetSeconds = result["budget"].as<double>();
+            config.maxIterationCount = result["max-iter"].as<uint64_t>();
+            config.windowWidth = result["window"].as<uint64_t>();
+            config.targetAccuracy = result["target"].as<double>();
+            config.stopsAtTarget = !result.count("run-to-budget");
+
+            std::cerr << "mux" << length << " (N=" << n << ")" << std::flush;
+            const ScalingResult scalingResult = runConfig(config, constants);
+            std::cerr << ": " << scalingResult.status << " after " << scalingResult.iterationCount << " iterations (" << scalingResult.seconds << " s)" << std::endl;
+
+            writeRow(os, config, scalingResult);
+        }
+    }
+
+    return 0;
+}